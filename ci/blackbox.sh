@@ -196,10 +196,13 @@ then
         status=$?
     fi
     
-    if [ -f "$APP_PATH/trace.vcd" ]
-    then 
-        mv -f $APP_PATH/trace.vcd .
-    fi
+    for trace in $APP_PATH/trace*.vcd $APP_PATH/trace*.fst
+    do
+        if [ -f "$trace" ]
+        then 
+            mv -f $trace .
+        fi
+    done
 else
     # driver initialization
     if [ $SCOPE -eq 1 ]
@@ -268,6 +268,10 @@ CONFIGS="-DNUM_ALU_BLOCK=2 -DNUM_ALU_LANES=2" ./ci/blackbox.sh --driver=rtlsim -
 CONFIGS="-DNUM_ALU_BLOCK=1 -DNUM_ALU_LANES=1" ./ci/blackbox.sh --driver=simx --app=diverge
 CONFIGS="-DNUM_ALU_BLOCK=2 -DNUM_ALU_LANES=2" ./ci/blackbox.sh --driver=simx --app=diverge
 
+# LSU coalescing with multiple LSU blocks
+CONFIGS="-DNUM_LSU_LANES=4 -DLSU_COALESCE=1" ./ci/blackbox.sh --driver=simx --threads=8 --app=mstress
+CONFIGS="-DNUM_LSU_LANES=4 -DLSU_COALESCE=1" ./ci/blackbox.sh --driver=simx --threads=8 --app=sgemmx
+
 # FPU scaling
 CONFIGS="-DNUM_ALU_BLOCK=4 -DNUM_FPU_LANES=2" ./ci/blackbox.sh --driver=rtlsim --app=sgemm
 CONFIGS="-DNUM_ALU_BLOCK=2 -DNUM_FPU_LANES=4" ./ci/blackbox.sh --driver=rtlsim --app=sgemm
@@ -52,11 +52,21 @@ extern "C" {
   void dpi_trace_stop();
 
   uint64_t dpi_uuid_gen(bool reset, int wid, uint64_t PC);
+
+  void dpi_commit(int core_id, int wid, uint64_t PC, uint64_t tmask, bool wb, int rd, bool eop);
+  void dpi_commit_data(int core_id, int wid, int tid, iword_t value);
 }
 
 bool sim_trace_enabled();
 void sim_trace_enable(bool enable);
 
+// scheduled PC notification for the trace triggers of the harness
+__attribute__((weak)) void sim_trace_pc(uint64_t /*pc*/) {}
+
+// committed instruction stream for the co-simulation checker of the harness
+__attribute__((weak)) void sim_commit(int /*core_id*/, int /*wid*/, uint64_t /*PC*/, uint64_t /*tmask*/, bool /*wb*/, int /*rd*/, bool /*eop*/) {}
+__attribute__((weak)) void sim_commit_data(int /*core_id*/, int /*wid*/, int /*tid*/, uint64_t /*value*/) {}
+
 class ShiftRegister {
 public:
   ShiftRegister() : init_(false), depth_(0) {}
@@ -225,9 +235,18 @@ uint64_t dpi_uuid_gen(bool reset, int wid, uint64_t PC) {
   } else {
     uuid_gen = it->second;
   }
+  sim_trace_pc(PC);
   uint32_t instr_uuid = uuid_gen->get_uuid(PC);
   uint32_t instr_id  = instr_uuid & 0xffff;
   uint32_t instr_ref = instr_uuid >> 16;
   uint64_t uuid = (uint64_t(instr_ref) << 32) | (wid << 16) | instr_id;
   return uuid;
-}
\ No newline at end of file
+}
+
+void dpi_commit(int core_id, int wid, uint64_t PC, uint64_t tmask, bool wb, int rd, bool eop) {
+  sim_commit(core_id, wid, PC, tmask, wb, rd, eop);
+}
+
+void dpi_commit_data(int core_id, int wid, int tid, iword_t value) {
+  sim_commit_data(core_id, wid, tid, uword_t(value));
+}
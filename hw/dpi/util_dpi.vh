@@ -34,4 +34,7 @@ import "DPI-C" function void dpi_trace_stop();
 
 import "DPI-C" function longint dpi_uuid_gen(input logic reset, input int wid, input longint PC);
 
+import "DPI-C" function void dpi_commit(input int core_id, input int wid, input longint PC, input longint tmask, input logic wb, input int rd, input logic eop);
+import "DPI-C" function void dpi_commit_data(input int core_id, input int wid, input int tid, input `INT_TYPE value);
+
 `endif
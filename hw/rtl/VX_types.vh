@@ -59,6 +59,10 @@
 
 `define VX_CSR_MNSTATUS                 12'h744
 
+// Simulation marker (ends SimX fast-forward)
+
+`define VX_CSR_SIM_MARKER               12'h800
+
 `define VX_CSR_MPM_BASE                 12'hB00
 `define VX_CSR_MPM_BASE_H               12'hB80
 
@@ -194,6 +194,22 @@ module VX_commit import VX_gpu_pkg::*; #(
         end
     end
     assign sim_wb_value = sim_wb_value_r;
+
+`ifdef COSIM
+    // committed instruction stream for the lockstep co-simulation of rtlsim
+    for (genvar i = 0; i < `ISSUE_WIDTH; ++i) begin
+        always @(posedge clk) begin
+            if (~reset && commit_fire[i]) begin
+                for (integer t = 0; t < THREAD_CNT; ++t) begin
+                    if (commit_if[i].data.tmask[t]) begin
+                        dpi_commit_data(CORE_ID, 32'(commit_if[i].data.wid), t, commit_if[i].data.data[t]);
+                    end
+                end
+                dpi_commit(CORE_ID, 32'(commit_if[i].data.wid), 64'(commit_if[i].data.PC), 64'(commit_if[i].data.tmask), commit_if[i].data.wb, 32'(commit_if[i].data.rd), commit_if[i].data.eop);
+            end
+        end
+    end
+`endif
     
 `ifdef DBG_TRACE_CORE_PIPELINE
     for (genvar i = 0; i < `ISSUE_WIDTH; ++i) begin
@@ -137,7 +137,8 @@ import VX_fpu_pkg::*;
                 `VX_CSR_MTVEC,
                 `VX_CSR_MEPC,
                 `VX_CSR_PMPCFG0,
-                `VX_CSR_PMPADDR0: /* do nothing!*/;
+                `VX_CSR_PMPADDR0,
+                `VX_CSR_SIM_MARKER: /* do nothing!*/;
                 default: begin
                     `ASSERT(0, ("%t: *** invalid CSR write address: %0h (#%0d)", $time, write_addr, write_uuid));
                 end
@@ -240,6 +240,11 @@ inline void vx_fence() {
     asm volatile ("fence iorw, iorw");
 }
 
+// Simulation marker: switches a fast-forwarded simulation to cycle-accurate mode
+inline void vx_sim_marker() {
+    csr_write(VX_CSR_SIM_MARKER, 0);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -25,14 +25,34 @@ CONFIGS="-DDCACHE_NUM_WAYS=8" ./ci/blackbox.sh --driver=rtlsim --app=sgemm --arg
 echo "cache tests done!"
 }
 
+replay()
+{
+echo "begin cache replay tests"
+
+# capture the memory requests of a single run, then replay them per configuration
+SIMX_MEM_TRACE=$PWD/perf/cache/sgemm.vxmt ./ci/blackbox.sh --driver=simx --app=sgemm --args="-n64"
+echo -n > ./perf/cache/cache_replay.log
+for config in "-DDCACHE_NUM_WAYS=2" "-DDCACHE_NUM_WAYS=4" "-DDCACHE_NUM_WAYS=8" "-DICACHE_NUM_WAYS=2" "-DICACHE_NUM_WAYS=4" "-DICACHE_NUM_WAYS=8"
+do
+    CONFIGS="$config" make -B -C sim/simx memreplay > /dev/null
+    echo "$config" >> ./perf/cache/cache_replay.log
+    ./sim/simx/memreplay ./perf/cache/sgemm.vxmt | grep 'PERF' >> ./perf/cache/cache_replay.log
+    echo -e "\n**************************************\n" >> ./perf/cache/cache_replay.log
+done
+
+echo "cache replay tests done!"
+}
+
 usage()
 {
-    echo "usage: [-s] [-h|--help]"
+    echo "usage: [-s] [-r] [-h|--help]"
 }
 
 case $1 in
     -s ) sgemm
             ;;
+    -r ) replay
+            ;;
     -h | --help ) usage
                     ;;
     * ) sgemm
@@ -18,6 +18,7 @@
 #include <iostream>
 #include <future>
 #include <chrono>
+#include <memory>
 
 #include <vortex.h>
 #include <utils.h>
@@ -88,8 +89,8 @@ class vx_device {
 public:
     vx_device() 
         : arch_(NUM_THREADS, NUM_WARPS, NUM_CORES, NUM_CLUSTERS)
-        , ram_(RAM_PAGE_SIZE)
-        , processor_(arch_)
+        , ram_(create_ram())
+        , processor_(arch_, dram_config())
         , global_mem_(
             ALLOC_BASE_ADDR,
             ALLOC_MAX_ADDR - ALLOC_BASE_ADDR,
@@ -102,7 +103,28 @@ public:
             1)
     {
         // attach memory module
-        processor_.attach_ram(&ram_);
+        processor_.attach_ram(ram_.get());
+
+        // number of threads used to simulate clusters in parallel
+        auto num_threads_s = getenv("SIMX_THREADS");
+        if (num_threads_s) {
+            processor_.set_num_threads(std::atoi(num_threads_s));
+        }
+
+        // functional fast-forward (e.g. SIMX_FAST_FORWARD=marker,warmup)
+        auto fast_forward_s = getenv("SIMX_FAST_FORWARD");
+        if (fast_forward_s) {
+            Processor::FastForward fast_forward;
+            if (Processor::FastForward::parse(fast_forward_s, &fast_forward)) {
+                processor_.set_fast_forward(fast_forward);
+            }
+        }
+
+        // memory request trace for the memreplay tool (e.g. SIMX_MEM_TRACE=sgemm.vxmt)
+        auto mem_trace_s = getenv("SIMX_MEM_TRACE");
+        if (mem_trace_s && !processor_.set_mem_trace(mem_trace_s)) {
+            std::abort();
+        }
     }
 
     ~vx_device() {
@@ -150,7 +172,7 @@ public:
         if (dest_addr + asize > GLOBAL_MEM_SIZE)
             return -1;
 
-        ram_.write((const uint8_t*)src, dest_addr, size);
+        ram_->write((const uint8_t*)src, dest_addr, size);
         
         /*DBGPRINT("upload %ld bytes to 0x%lx\n", size, dest_addr);
         for (uint64_t i = 0; i < size && i < 1024; i += 4) {
@@ -165,7 +187,7 @@ public:
         if (src_addr + asize > GLOBAL_MEM_SIZE)
             return -1;
 
-        ram_.read((uint8_t*)dest, src_addr, size);
+        ram_->read((uint8_t*)dest, src_addr, size);
         
         /*DBGPRINT("download %ld bytes from 0x%lx\n", size, src_addr);
         for (uint64_t i = 0; i < size && i < 1024; i += 4) {
@@ -218,8 +240,34 @@ public:
     }
 
 private:
+
+    static DramSim::Config dram_config() {
+        // DRAM backend (e.g. VORTEX_DRAM=standard=HBM,channels=8)
+        DramSim::Config config;
+        auto dram_s = getenv("VORTEX_DRAM");
+        if (dram_s && !DramSim::Config::parse(dram_s, &config)) {
+            std::abort();
+        }
+        return config;
+    }
+
+    static RAM* create_ram() {
+        // memory-mapped RAM (e.g. SIMX_MAPPED_RAM=1), optionally starting
+        // from a saved memory image (e.g. SIMX_RAM_IMAGE=input.img)
+        auto image_s = getenv("SIMX_RAM_IMAGE");
+        auto mapped_s = getenv("SIMX_MAPPED_RAM");
+        if (image_s || (mapped_s && std::atoi(mapped_s))) {
+            auto ram = new MappedRAM(RAM_PAGE_SIZE, RAM_MAPPED_SIZE);
+            if (image_s && !ram->loadImage(image_s)) {
+                std::abort();
+            }
+            return ram;
+        }
+        return new RAM(RAM_PAGE_SIZE);
+    }
+
     Arch                arch_;
-    RAM                 ram_;
+    std::unique_ptr<RAM> ram_;
     Processor           processor_;
     MemoryAllocator     global_mem_;
     MemoryAllocator     local_mem_;
@@ -28,6 +28,10 @@ constexpr bool ispow2(uint32_t value) {
   return value && !(value & (value - 1));
 }
 
+constexpr bool ispow2_64(uint64_t value) {
+  return value && !(value & (value - 1));
+}
+
 constexpr uint32_t log2ceil(uint32_t value) {
   return 32 - count_leading_zeros(value - 1);
 }
@@ -0,0 +1,295 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dram_sim.h"
+#include "util.h"
+#include <cstdlib>
+#include <cctype>
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <vector>
+#include <deque>
+
+DISABLE_WARNING_PUSH
+DISABLE_WARNING_UNUSED_PARAMETER
+#define RAMULATOR
+#include <ramulator/src/Gem5Wrapper.h>
+#include <ramulator/src/Request.h>
+#include <ramulator/src/Statistics.h>
+DISABLE_WARNING_POP
+
+using namespace vortex;
+
+namespace {
+
+struct dram_standard_t {
+  const char* name;
+  const char* speed;
+  const char* org;
+  uint32_t min_channels;
+  uint32_t max_channels; // 0: unbounded
+  uint32_t max_ranks;    // 0: unbounded
+};
+
+// ramulator standards available through its Gem5 wrapper, with default timings
+// and the channel and rank counts ramulator asserts on (channel counts must
+// also be a power of two)
+const dram_standard_t dram_standards[] = {
+  {"DDR3",    "DDR3_1600K",   "DDR3_4Gb_x8",    1, 0, 0},
+  {"DDR4",    "DDR4_2400R",   "DDR4_4Gb_x8",    1, 0, 0},
+  {"LPDDR3",  "LPDDR3_1600",  "LPDDR3_8Gb_x16", 1, 0, 0},
+  {"LPDDR4",  "LPDDR4_3200",  "LPDDR4_8Gb_x16", 2, 0, 0},
+  {"GDDR5",   "GDDR5_7000",   "GDDR5_8Gb_x32",  1, 0, 1},
+  {"HBM",     "HBM_1Gbps",    "HBM_4Gb",        8, 8, 0},
+  {"WideIO",  "WideIO_266",   "WideIO_4Gb",     4, 4, 1},
+  {"WideIO2", "WideIO2_1066", "WideIO2_8Gb",    4, 8, 2},
+};
+
+const dram_standard_t* find_standard(const std::string& name) {
+  for (auto& standard : dram_standards) {
+    if (name == standard.name)
+      return &standard;
+  }
+  return nullptr;
+}
+
+}
+
+bool DramSim::Config::parse(const char* spec, Config* out) {
+  Config config(*out);
+  bool has_channels = false;
+  bool has_ranks = false;
+  std::stringstream ss(spec);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    auto pos = item.find('=');
+    auto key = item.substr(0, pos);
+    auto value = (pos != std::string::npos) ? item.substr(pos + 1) : std::string();
+    if (value.empty()) {
+      std::cout << "Error: invalid dram option: " << item << std::endl;
+      return false;
+    }
+    if (key == "standard") {
+      if (value != config.standard) {
+        config.speed.clear();
+        config.org.clear();
+      }
+      config.standard = value;
+    } else if (key == "speed") {
+      config.speed = value;
+    } else if (key == "org") {
+      config.org = value;
+    } else if (key == "channels") {
+      config.channels = std::strtoul(value.c_str(), nullptr, 0);
+      has_channels = true;
+    } else if (key == "ranks") {
+      config.ranks = std::strtoul(value.c_str(), nullptr, 0);
+      has_ranks = true;
+    } else if (key == "latency") {
+      config.latency = std::strtoul(value.c_str(), nullptr, 0);
+    } else if (key == "bandwidth") {
+      config.bandwidth = std::strtod(value.c_str(), nullptr);
+    } else {
+      std::cout << "Error: invalid dram option: " << item << std::endl;
+      return false;
+    }
+  }
+  if (config.fixed()) {
+    if (config.bandwidth <= 0) {
+      std::cout << "Error: invalid dram bandwidth: " << config.bandwidth << std::endl;
+      return false;
+    }
+  } else {
+    auto standard = find_standard(config.standard);
+    if (!standard) {
+      std::cout << "Error: unsupported dram standard: " << config.standard << std::endl;
+      return false;
+    }
+    // fit the preset counts to the standard, explicit ones are checked as is
+    if (!has_channels && config.channels != 0) {
+      config.channels = std::max(config.channels, standard->min_channels);
+      if (standard->max_channels != 0)
+        config.channels = std::min(config.channels, standard->max_channels);
+    } else if (!has_channels && standard->min_channels > 1) {
+      config.channels = standard->min_channels;
+    }
+    if (!has_ranks && standard->max_ranks != 0) {
+      config.ranks = std::min(config.ranks, standard->max_ranks);
+    }
+    if (config.channels != 0
+     && (config.channels < standard->min_channels
+      || (standard->max_channels != 0 && config.channels > standard->max_channels)
+      || (config.channels & (config.channels - 1)) != 0)) {
+      std::cout << "Error: unsupported dram channels for " << config.standard << ": " << config.channels
+                << " (expected ";
+      if (standard->max_channels == standard->min_channels) {
+        std::cout << standard->min_channels;
+      } else if (standard->max_channels != 0) {
+        std::cout << "a power of two from " << standard->min_channels << " to " << standard->max_channels;
+      } else if (standard->min_channels > 1) {
+        std::cout << "a power of two of at least " << standard->min_channels;
+      } else {
+        std::cout << "a power of two";
+      }
+      std::cout << ")" << std::endl;
+      return false;
+    }
+    if (config.ranks == 0 || (standard->max_ranks != 0 && config.ranks > standard->max_ranks)) {
+      std::cout << "Error: unsupported dram ranks for " << config.standard << ": " << config.ranks << std::endl;
+      return false;
+    }
+    // ramulator silently falls back to its first entry on unknown names
+    auto prefix = config.standard + "_";
+    if ((!config.speed.empty() && config.speed.compare(0, prefix.size(), prefix) != 0)
+     || (!config.org.empty() && config.org.compare(0, prefix.size(), prefix) != 0)) {
+      std::cout << "Error: dram speed/org do not match standard: " << config.standard << std::endl;
+      return false;
+    }
+  }
+  *out = config;
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+class DramSim::Impl {
+public:
+  virtual ~Impl() {}
+  virtual void tick() = 0;
+  virtual bool send(uint64_t addr, bool write, uint32_t source, const ResponseCallback& callback) = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class DramSim::RamulatorImpl : public DramSim::Impl {
+private:
+  ramulator::Gem5Wrapper* dram_;
+
+public:
+  RamulatorImpl(const Config& config, uint32_t block_size, uint32_t num_cores) {
+    auto standard = find_standard(config.standard);
+    ramulator::Config ram_config;
+    ram_config.add("standard", config.standard);
+    ram_config.add("channels", std::to_string(std::max<uint32_t>(config.channels, 1)));
+    ram_config.add("ranks", std::to_string(config.ranks));
+    ram_config.add("speed", config.speed.empty() ? standard->speed : config.speed);
+    ram_config.add("org", config.org.empty() ? standard->org : config.org);
+    ram_config.add("mapping", "defaultmapping");
+    ram_config.set_core_num(num_cores);
+    dram_ = new ramulator::Gem5Wrapper(ram_config, block_size);
+    auto log_name = config.standard;
+    std::transform(log_name.begin(), log_name.end(), log_name.begin(), ::tolower);
+    Stats::statlist.output("ramulator." + log_name + ".log");
+  }
+
+  ~RamulatorImpl() {
+    dram_->finish();
+    Stats::statlist.printall();
+    delete dram_;
+  }
+
+  void tick() override {
+    dram_->tick();
+  }
+
+  bool send(uint64_t addr, bool write, uint32_t source, const ResponseCallback& callback) override {
+    if (write) {
+      ramulator::Request dram_req(addr, ramulator::Request::Type::WRITE, source);
+      return dram_->send(dram_req);
+    }
+    ramulator::Request dram_req(
+      addr,
+      ramulator::Request::Type::READ,
+      [callback](ramulator::Request&) { callback(); },
+      source
+    );
+    return dram_->send(dram_req);
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Each channel owns a token bucket refilled by 'bandwidth' bytes per cycle,
+// a request needs a full block of tokens and reads respond after 'latency'.
+class DramSim::FixedImpl : public DramSim::Impl {
+private:
+  struct pending_read_t {
+    uint64_t ready;
+    ResponseCallback callback;
+  };
+
+  uint32_t latency_;
+  double bandwidth_;
+  double burst_;
+  uint32_t block_size_;
+  std::vector<double> tokens_;
+  std::deque<pending_read_t> pending_reads_;
+  uint64_t clock_;
+
+public:
+  FixedImpl(const Config& config, uint32_t block_size)
+    : latency_(config.latency)
+    , bandwidth_(config.bandwidth)
+    , burst_(std::max<double>(config.bandwidth, block_size))
+    , block_size_(block_size)
+    , tokens_(std::max<uint32_t>(config.channels, 1), burst_)
+    , clock_(0)
+  {}
+
+  void tick() override {
+    ++clock_;
+    for (auto& tokens : tokens_) {
+      tokens = std::min(tokens + bandwidth_, burst_);
+    }
+    // fixed latency keeps the reads in issue order
+    while (!pending_reads_.empty() && pending_reads_.front().ready <= clock_) {
+      auto callback = pending_reads_.front().callback;
+      pending_reads_.pop_front();
+      callback();
+    }
+  }
+
+  bool send(uint64_t addr, bool write, uint32_t /*source*/, const ResponseCallback& callback) override {
+    auto& tokens = tokens_.at((addr / block_size_) % tokens_.size());
+    if (tokens < block_size_)
+      return false;
+    tokens -= block_size_;
+    if (!write) {
+      pending_reads_.push_back({clock_ + latency_, callback});
+    }
+    return true;
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+DramSim::DramSim(const Config& config, uint32_t block_size, uint32_t num_cores) {
+  if (config.fixed()) {
+    impl_ = new FixedImpl(config, block_size);
+  } else {
+    impl_ = new RamulatorImpl(config, block_size, num_cores);
+  }
+}
+
+DramSim::~DramSim() {
+  delete impl_;
+}
+
+void DramSim::tick() {
+  impl_->tick();
+}
+
+bool DramSim::send(uint64_t addr, bool write, uint32_t source, const ResponseCallback& callback) {
+  return impl_->send(addr, write, source, callback);
+}
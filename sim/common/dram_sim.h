@@ -0,0 +1,71 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <functional>
+
+namespace vortex {
+
+// DRAM timing backend shared by the simulators: a ramulator device model or
+// an analytic fixed-latency model with a per-channel bandwidth budget.
+class DramSim {
+public:
+  struct Config {
+    std::string standard; // ramulator standard (DDR4, HBM, GDDR5, ...) or "fixed"
+    std::string speed;    // empty: standard default
+    std::string org;      // empty: standard default
+    uint32_t channels;    // 0: simulator default
+    uint32_t ranks;
+    uint32_t latency;     // fixed model: read latency in DRAM cycles
+    double   bandwidth;   // fixed model: bytes per DRAM cycle per channel
+
+    Config()
+      : standard("DDR4")
+      , channels(0)
+      , ranks(1)
+      , latency(100)
+      , bandwidth(16)
+    {}
+
+    bool fixed() const {
+      return (standard == "fixed");
+    }
+
+    // update from a comma-separated list of "standard=", "speed=", "org=",
+    // "channels=", "ranks=", "latency=" and "bandwidth=" options, preset
+    // channel and rank counts are fitted to what the standard supports
+    static bool parse(const char* spec, Config* out);
+  };
+
+  typedef std::function<void()> ResponseCallback;
+
+  DramSim(const Config& config, uint32_t block_size, uint32_t num_cores);
+  ~DramSim();
+
+  void tick();
+
+  // returns false if the request was not accepted this cycle,
+  // only reads complete through the callback
+  bool send(uint64_t addr, bool write, uint32_t source, const ResponseCallback& callback);
+
+private:
+  class Impl;
+  class RamulatorImpl;
+  class FixedImpl;
+  Impl* impl_;
+};
+
+}
@@ -16,7 +16,16 @@
 #include <iostream>
 #include <fstream>
 #include <assert.h>
+#include <algorithm>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "util.h"
+#include "bitmanip.h"
+#include "serialize.h"
 
 using namespace vortex;
 
@@ -121,8 +130,23 @@ void MemoryUnit::ADecoder::write(const void* data, uint64_t addr, uint64_t size)
 
 ///////////////////////////////////////////////////////////////////////////////
 
+namespace {
+enum {
+  PTE_V = 1 << 0,
+  PTE_R = 1 << 1,
+  PTE_W = 1 << 2,
+  PTE_X = 1 << 3,
+  PTE_U = 1 << 4,
+};
+const uint32_t VM_PAGE_BITS = 12;
+}
+
 MemoryUnit::MemoryUnit(uint64_t pageSize)
-  : pageSize_(pageSize)
+  : tlb1Ways_(1)
+  , tlbClock_(0)
+  , pageSize_(pageSize)
+  , vmMode_(VMMode::Bare)
+  , rootPPN_(0)
   , enableVM_(pageSize != 0)
   , amo_reservation_({0x0, false}) {
   if (pageSize != 0) {
@@ -134,23 +158,120 @@ void MemoryUnit::attach(MemDevice &m, uint64_t start, uint64_t end) {
   decoder_.map(start, end, m);
 }
 
-MemoryUnit::TLBEntry MemoryUnit::tlbLookup(uint64_t vAddr, uint32_t flagMask) {
-  auto iter = tlb_.find(vAddr / pageSize_);
-  if (iter != tlb_.end()) {
-    if (iter->second.flags & flagMask)
-      return iter->second;
-    else {
-      throw PageFault(vAddr, false);
+void MemoryUnit::setTLB(uint32_t l0Size, uint32_t l1Sets, uint32_t l1Ways) {
+  assert(0 == l0Size || ispow2(l0Size));
+  assert(0 == l1Ways || ispow2(l1Sets));
+  tlb0_.assign(l0Size, tlb_line_t{0, TLBEntry(0, 0), 0, false});
+  tlb1_.assign(l1Sets * l1Ways, tlb_line_t{0, TLBEntry(0, 0), 0, false});
+  tlb1Ways_ = std::max<uint32_t>(l1Ways, 1);
+}
+
+void MemoryUnit::setVM(VMMode mode, uint64_t rootPPN) {
+  vmMode_   = mode;
+  rootPPN_  = rootPPN;
+  enableVM_ = (mode != VMMode::Bare);
+  pageSize_ = 1ull << VM_PAGE_BITS;
+  this->tlbFlush();
+}
+
+MemoryUnit::TLBEntry MemoryUnit::pageWalk(uint64_t vAddr) {
+  bool sv32 = (vmMode_ == VMMode::Sv32);
+  int levels = sv32 ? 2 : 3;
+  uint32_t vpnBits = sv32 ? 10 : 9;
+  uint32_t pteSize = sv32 ? 4 : 8;
+  uint64_t ppnMask = sv32 ? ((1ull << 22) - 1) : ((1ull << 44) - 1);
+  uint64_t vpn = vAddr >> VM_PAGE_BITS;
+  uint64_t table = rootPPN_;
+  ++tlbStats_.walks;
+  for (int level = levels - 1; level >= 0; --level) {
+    uint64_t index = (vpn >> (level * vpnBits)) & ((1ull << vpnBits) - 1);
+    uint64_t pte = 0;
+    decoder_.read(&pte, (table << VM_PAGE_BITS) + index * pteSize, pteSize);
+    if (!(pte & PTE_V) || (!(pte & PTE_R) && (pte & PTE_W)))
+      throw PageFault(vAddr, true);
+    uint64_t ppn = (pte >> 10) & ppnMask;
+    if (pte & (PTE_R | PTE_X)) {
+      // superpages take the low page number bits from the virtual address
+      uint64_t lowMask = (1ull << (level * vpnBits)) - 1;
+      if (ppn & lowMask)
+        throw PageFault(vAddr, false);
+      return TLBEntry(ppn | (vpn & lowMask), pte & 077);
     }
-  } else {
+    table = ppn;
+  }
+  throw PageFault(vAddr, true);
+}
+
+MemoryUnit::TLBEntry MemoryUnit::tlbRefill(uint64_t vAddr) {
+  uint64_t vpn = vAddr / pageSize_;
+  auto iter = tlb_.find(vpn);
+  if (iter != tlb_.end())
+    return iter->second;
+  if (vmMode_ == VMMode::Bare)
     throw PageFault(vAddr, true);
+  // walks are memoized until the next flush
+  auto entry = this->pageWalk(vAddr);
+  tlb_[vpn] = entry;
+  return entry;
+}
+
+MemoryUnit::TLBEntry MemoryUnit::tlbLookup(uint64_t vAddr, uint32_t flagMask, bool sup) {
+  uint64_t vpn = vAddr / pageSize_;
+  TLBEntry entry;
+  bool hit = false;
+
+  tlb_line_t* l0 = nullptr;
+  if (!tlb0_.empty()) {
+    l0 = &tlb0_[vpn & (tlb0_.size() - 1)];
+    if (l0->valid && l0->vpn == vpn) {
+      entry = l0->entry;
+      hit = true;
+    }
   }
+
+  tlb_line_t* victim = nullptr;
+  if (!hit && !tlb1_.empty()) {
+    auto ways = tlb1_.data() + (vpn & (tlb1_.size() / tlb1Ways_ - 1)) * tlb1Ways_;
+    victim = ways;
+    for (uint32_t w = 0; w < tlb1Ways_; ++w) {
+      auto& line = ways[w];
+      if (line.valid && line.vpn == vpn) {
+        line.lru = ++tlbClock_;
+        entry = line.entry;
+        hit = true;
+        break;
+      }
+      if (victim->valid && (!line.valid || line.lru < victim->lru)) {
+        victim = &line;
+      }
+    }
+  }
+
+  if (hit) {
+    ++tlbStats_.hits;
+  } else {
+    ++tlbStats_.misses;
+    entry = this->tlbRefill(vAddr);
+    if (victim) {
+      *victim = tlb_line_t{vpn, entry, ++tlbClock_, true};
+    }
+  }
+
+  if (l0) {
+    *l0 = tlb_line_t{vpn, entry, 0, true};
+  }
+
+  // user accesses need PTE_U, supervisor ones cannot reach user pages
+  if ((entry.flags & flagMask) != flagMask || ((entry.flags & PTE_U) != 0) == sup)
+    throw PageFault(vAddr, false);
+
+  return entry;
 }
 
-uint64_t MemoryUnit::toPhyAddr(uint64_t addr, uint32_t flagMask) {
+uint64_t MemoryUnit::toPhyAddr(uint64_t addr, uint32_t flagMask, bool sup) {
   uint64_t pAddr;
   if (enableVM_) {
-    TLBEntry t = this->tlbLookup(addr, flagMask);
+    TLBEntry t = this->tlbLookup(addr, flagMask, sup);
     pAddr = t.pfn * pageSize_ + addr % pageSize_;
   } else {
     pAddr = addr;    
@@ -158,107 +279,275 @@ uint64_t MemoryUnit::toPhyAddr(uint64_t addr, uint32_t flagMask) {
   return pAddr;
 }
 
-void MemoryUnit::read(void* data, uint64_t addr, uint64_t size, bool sup) {
-  uint64_t pAddr = this->toPhyAddr(addr, sup ? 8 : 1);
+uint64_t MemoryUnit::peekPhyAddr(uint64_t vAddr) const {
+  if (!enableVM_)
+    return vAddr;
+  uint64_t vpn = vAddr / pageSize_;
+  if (!tlb0_.empty()) {
+    auto& l0 = tlb0_[vpn & (tlb0_.size() - 1)];
+    if (l0.valid && l0.vpn == vpn)
+      return l0.entry.pfn * pageSize_ + vAddr % pageSize_;
+  }
+  auto iter = tlb_.find(vpn);
+  if (iter != tlb_.end())
+    return iter->second.pfn * pageSize_ + vAddr % pageSize_;
+  return vAddr;
+}
+
+void MemoryUnit::read(void* data, uint64_t addr, uint64_t size, bool sup, bool fetch) {
+  uint64_t pAddr = this->toPhyAddr(addr, fetch ? PTE_X : PTE_R, sup);
   return decoder_.read(data, pAddr, size);
 }
 
 void MemoryUnit::write(const void* data, uint64_t addr, uint64_t size, bool sup) {
-  uint64_t pAddr = this->toPhyAddr(addr, sup ? 16 : 1);
+  uint64_t pAddr = this->toPhyAddr(addr, PTE_W, sup);
   decoder_.write(data, pAddr, size);
   amo_reservation_.valid = false;
 }
 
 void MemoryUnit::amo_reserve(uint64_t addr) {
-  uint64_t pAddr = this->toPhyAddr(addr, 1);
+  uint64_t pAddr = this->toPhyAddr(addr, PTE_R, false);
   amo_reservation_.addr = pAddr;
   amo_reservation_.valid = true;
 }
 
 bool MemoryUnit::amo_check(uint64_t addr) {
-  uint64_t pAddr = this->toPhyAddr(addr, 1);
+  uint64_t pAddr = this->toPhyAddr(addr, PTE_R, false);
   return amo_reservation_.valid && (amo_reservation_.addr == pAddr);
 }
+
 void MemoryUnit::tlbAdd(uint64_t virt, uint64_t phys, uint32_t flags) {
-  tlb_[virt / pageSize_] = TLBEntry(phys / pageSize_, flags);
+  uint64_t vpn = virt / pageSize_;
+  tlb_[vpn] = TLBEntry(phys / pageSize_, flags);
+  this->tlbInvalidate(vpn);
 }
 
 void MemoryUnit::tlbRm(uint64_t va) {
-  if (tlb_.find(va / pageSize_) != tlb_.end())
-    tlb_.erase(tlb_.find(va / pageSize_));
+  uint64_t vpn = va / pageSize_;
+  if (tlb_.find(vpn) != tlb_.end())
+    tlb_.erase(tlb_.find(vpn));
+  this->tlbInvalidate(vpn);
+}
+
+void MemoryUnit::tlbInvalidate(uint64_t vpn) {
+  for (auto& line : tlb0_) {
+    line.valid &= (line.vpn != vpn);
+  }
+  for (auto& line : tlb1_) {
+    line.valid &= (line.vpn != vpn);
+  }
+}
+
+void MemoryUnit::tlbFlush() {
+  tlb_.clear();
+  for (auto& line : tlb0_) {
+    line.valid = false;
+  }
+  for (auto& line : tlb1_) {
+    line.valid = false;
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 RAM::RAM(uint32_t page_size, uint64_t capacity) 
-  : capacity_(capacity)
-  , page_bits_(log2ceil(page_size))
+  : page_bits_(log2ceil(page_size))
+  , capacity_(capacity)
+  , num_pages_(0)
   , last_page_(nullptr)
   , last_page_index_(0) {    
    assert(ispow2(page_size));
-   assert(0 == capacity || ispow2(capacity));
+   assert(0 == capacity || ispow2_64(capacity));
    assert(0 == (capacity % page_size));
+   // uninitialized data reads as "baadf00d"
+   fill_page_ = new uint8_t[page_size];
+   for (uint32_t i = 0; i < page_size; ++i) {
+     fill_page_[i] = (0xbaadf00d >> ((i & 0x3) * 8)) & 0xff;
+   }
 }
 
 RAM::~RAM() {
   this->clear();
+  delete[] fill_page_;
 }
 
 void RAM::clear() {
-  for (auto& page : pages_) {
-    delete[] page.second;
+  auto free_leaf = [&](uint8_t** leaf) {
+    for (uint32_t i = 0; i < (1u << RAM_LEAF_BITS); ++i) {
+      delete[] leaf[i];
+    }
+    delete[] leaf;
+  };
+  for (auto leaf : page_dir_) {
+    if (leaf) {
+      free_leaf(leaf);
+    }
+  }
+  for (auto& entry : far_page_dir_) {
+    free_leaf(entry.second);
   }
+  page_dir_.clear();
+  far_page_dir_.clear();
+  num_pages_ = 0;
+  last_page_ = nullptr;
 }
 
 uint64_t RAM::size() const {
-  return uint64_t(pages_.size()) << page_bits_;
+  return num_pages_ << page_bits_;
 }
 
-uint8_t *RAM::get(uint64_t address) const {
-  if (capacity_ != 0 && address >= capacity_) {
-    throw OutOfRange();
-  }
-  uint32_t page_size   = 1 << page_bits_;  
-  uint32_t page_offset = address & (page_size - 1);
-  uint64_t page_index  = address >> page_bits_;
-
-  uint8_t* page;
-  if (last_page_ && last_page_index_ == page_index) {
-    page = last_page_;
+uint8_t **RAM::leaf_entry(uint64_t page_index, bool create) const {
+  uint64_t dir_index = page_index >> RAM_LEAF_BITS;
+  uint8_t** leaf = nullptr;
+  if (dir_index < (1ull << RAM_DIR_BITS)) {
+    if (dir_index < page_dir_.size()) {
+      leaf = page_dir_[dir_index];
+    }
+    if (nullptr == leaf) {
+      if (!create)
+        return nullptr;
+      if (dir_index >= page_dir_.size()) {
+        page_dir_.resize(dir_index + 1, nullptr);
+      }
+      leaf = new uint8_t*[1u << RAM_LEAF_BITS]();
+      page_dir_[dir_index] = leaf;
+    }
   } else {
-    auto it = pages_.find(page_index);
-    if (it != pages_.end()) {
-      page = it->second;
+    auto it = far_page_dir_.find(dir_index);
+    if (it != far_page_dir_.end()) {
+      leaf = it->second;
     } else {
-      uint8_t *ptr = new uint8_t[page_size];
-      // set uninitialized data to "baadf00d"
-      for (uint32_t i = 0; i < page_size; ++i) {
-        ptr[i] = (0xbaadf00d >> ((i & 0x3) * 8)) & 0xff;
-      }
-      pages_.emplace(page_index, ptr);
-      page = ptr;
+      if (!create)
+        return nullptr;
+      leaf = new uint8_t*[1u << RAM_LEAF_BITS]();
+      far_page_dir_.emplace(dir_index, leaf);
     }
-    last_page_ = page;
-    last_page_index_ = page_index;
   }
+  return &leaf[page_index & ((1u << RAM_LEAF_BITS) - 1)];
+}
+
+uint8_t *RAM::find_page(uint64_t page_index) const {
+  if (last_page_ && last_page_index_ == page_index)
+    return last_page_;
+  auto entry = this->leaf_entry(page_index, false);
+  if (nullptr == entry || nullptr == *entry)
+    return nullptr;
+  last_page_ = *entry;
+  last_page_index_ = page_index;
+  return last_page_;
+}
+
+uint8_t *RAM::map_page(uint64_t page_index, bool fill) const {
+  auto page = this->find_page(page_index);
+  if (page)
+    return page;
+  uint32_t page_size = 1 << page_bits_;
+  page = new uint8_t[page_size];
+  if (fill) {
+    memcpy(page, fill_page_, page_size);
+  }
+  *this->leaf_entry(page_index, true) = page;
+  ++num_pages_;
+  last_page_ = page;
+  last_page_index_ = page_index;
+  return page;
+}
+
+void RAM::check_range(uint64_t addr, uint64_t size) const {
+  if (capacity_ != 0 && (addr >= capacity_ || size > (capacity_ - addr))) {
+    throw OutOfRange();
+  }
+}
 
-  return page + page_offset;
+uint8_t *RAM::get(uint64_t address) const {
+  this->check_range(address, 1);
+  uint32_t page_offset = address & ((1 << page_bits_) - 1);
+  return this->map_page(address >> page_bits_, true) + page_offset;
 }
 
 void RAM::read(void* data, uint64_t addr, uint64_t size) {
+  this->check_range(addr, size);
   uint8_t* d = (uint8_t*)data;
-  for (uint64_t i = 0; i < size; i++) {
-    d[i] = *this->get(addr + i);
+  uint64_t page_size = 1ull << page_bits_;
+  while (size != 0) {
+    uint64_t page_offset = addr & (page_size - 1);
+    uint64_t n = std::min(size, page_size - page_offset);
+    // unmapped pages are not allocated on reads
+    auto page = this->find_page(addr >> page_bits_);
+    memcpy(d, (page ? page : fill_page_) + page_offset, n);
+    d += n;
+    addr += n;
+    size -= n;
   }
 }
 
 void RAM::write(const void* data, uint64_t addr, uint64_t size) {
+  this->check_range(addr, size);
   const uint8_t* d = (const uint8_t*)data;
-  for (uint64_t i = 0; i < size; i++) {
-    *this->get(addr + i) = d[i];
+  uint64_t page_size = 1ull << page_bits_;
+  while (size != 0) {
+    uint64_t page_offset = addr & (page_size - 1);
+    uint64_t n = std::min(size, page_size - page_offset);
+    // fully overwritten pages skip the uninitialized fill
+    auto page = this->map_page(addr >> page_bits_, n != page_size);
+    memcpy(page + page_offset, d, n);
+    d += n;
+    addr += n;
+    size -= n;
+  }
+}
+
+void RAM::save(std::ostream& os) const {
+  // pages are stored in address order so that checkpoints are reproducible
+  std::vector<uint64_t> dir_indices;
+  for (uint64_t i = 0, n = page_dir_.size(); i < n; ++i) {
+    if (page_dir_[i]) {
+      dir_indices.push_back(i);
+    }
+  }
+  std::vector<uint64_t> far_indices;
+  for (auto& entry : far_page_dir_) {
+    far_indices.push_back(entry.first);
+  }
+  std::sort(far_indices.begin(), far_indices.end());
+  dir_indices.insert(dir_indices.end(), far_indices.begin(), far_indices.end());
+
+  uint32_t page_size = 1 << page_bits_;
+  write_pod(os, page_bits_);
+  write_pod(os, num_pages_);
+  for (auto dir_index : dir_indices) {
+    for (uint64_t i = 0; i < (1u << RAM_LEAF_BITS); ++i) {
+      uint64_t index = (dir_index << RAM_LEAF_BITS) | i;
+      auto page = *this->leaf_entry(index, false);
+      if (nullptr == page)
+        continue;
+      write_pod(os, index);
+      os.write((const char*)page, page_size);
+    }
   }
 }
 
+bool RAM::load(std::istream& is) {
+  uint32_t page_bits = 0;
+  uint64_t num_pages = 0;
+  read_pod(is, &page_bits);
+  read_pod(is, &num_pages);
+  if (!is || page_bits != page_bits_) {
+    std::cout << "Error: invalid RAM checkpoint (page_bits=" << page_bits << ")" << std::endl;
+    return false;
+  }
+
+  this->clear();
+  uint32_t page_size = 1 << page_bits_;
+  for (uint64_t i = 0; i < num_pages; ++i) {
+    uint64_t index = 0;
+    read_pod(is, &index);
+    auto page = this->map_page(index, false);
+    is.read((char*)page, page_size);
+  }
+  return bool(is);
+}
+
 void RAM::loadBinImage(const char* filename, uint64_t destination) {
   std::ifstream ifs(filename);
   if (!ifs) {
@@ -343,3 +632,193 @@ void RAM::loadHexImage(const char* filename) {
     --size;
   }
 }
+
+///////////////////////////////////////////////////////////////////////////////
+
+MappedRAM::MappedRAM(uint32_t page_size, uint64_t capacity)
+  : RAM(page_size, capacity)
+  , map_size_(capacity) {
+  assert(0 != capacity);
+  // pages are tracked at no less than the host page granularity
+  page_bits_ = std::max<uint32_t>(page_bits_, log2ceil(sysconf(_SC_PAGESIZE)));
+  assert(0 == (capacity % (1ull << page_bits_)));
+  auto base = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (base == MAP_FAILED) {
+    std::cout << "Error: failed reserving " << map_size_ << " bytes of memory: " << strerror(errno) << std::endl;
+    std::abort();
+  }
+  base_ = (uint8_t*)base;
+}
+
+MappedRAM::~MappedRAM() {
+  munmap(base_, map_size_);
+}
+
+void MappedRAM::map_anonymous(uint64_t offset, uint64_t size) {
+  // remapping over the range releases its pages back to the OS
+  auto base = mmap(base_ + offset, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+  if (base == MAP_FAILED) {
+    std::cout << "Error: failed remapping memory: " << strerror(errno) << std::endl;
+    std::abort();
+  }
+}
+
+void MappedRAM::clear() {
+  this->map_anonymous(0, map_size_);
+  image_pages_.clear();
+}
+
+std::vector<uint64_t> MappedRAM::dirty_pages() const {
+  // only resident pages or pages loaded from an image can hold data, and
+  // all-zero pages are dropped. Image pages the run never touched need not
+  // be resident, mincore() reports the page cache state of the file.
+  uint64_t host_page_size = sysconf(_SC_PAGESIZE);
+  std::vector<unsigned char> residency(map_size_ / host_page_size);
+  if (mincore(base_, map_size_, residency.data()) != 0) {
+    std::cout << "Error: failed querying memory residency: " << strerror(errno) << std::endl;
+    std::abort();
+  }
+  uint64_t page_size = 1ull << page_bits_;
+  uint64_t host_pages = page_size / host_page_size;
+  std::vector<uint64_t> pages;
+  for (uint64_t index = 0, n = map_size_ >> page_bits_; index < n; ++index) {
+    bool resident = (index < image_pages_.size() && image_pages_[index]);
+    for (uint64_t i = 0; i < host_pages; ++i) {
+      resident |= (residency[index * host_pages + i] & 0x1);
+    }
+    if (!resident)
+      continue;
+    auto page = base_ + (index << page_bits_);
+    bool zero = (page[0] == 0) && (0 == memcmp(page, page + 1, page_size - 1));
+    if (zero)
+      continue;
+    pages.push_back(index);
+  }
+  return pages;
+}
+
+uint64_t MappedRAM::size() const {
+  return this->dirty_pages().size() << page_bits_;
+}
+
+uint8_t *MappedRAM::get(uint64_t address) const {
+  this->check_range(address, 1);
+  return base_ + address;
+}
+
+void MappedRAM::read(void* data, uint64_t addr, uint64_t size) {
+  this->check_range(addr, size);
+  memcpy(data, base_ + addr, size);
+}
+
+void MappedRAM::write(const void* data, uint64_t addr, uint64_t size) {
+  this->check_range(addr, size);
+  memcpy(base_ + addr, data, size);
+}
+
+void MappedRAM::save(std::ostream& os) const {
+  auto pages = this->dirty_pages();
+  uint64_t num_pages = pages.size();
+  uint32_t page_size = 1 << page_bits_;
+  write_pod(os, page_bits_);
+  write_pod(os, num_pages);
+  for (auto index : pages) {
+    write_pod(os, index);
+    os.write((const char*)(base_ + (index << page_bits_)), page_size);
+  }
+}
+
+bool MappedRAM::load(std::istream& is) {
+  uint32_t page_bits = 0;
+  uint64_t num_pages = 0;
+  read_pod(is, &page_bits);
+  read_pod(is, &num_pages);
+  if (!is || page_bits != page_bits_) {
+    std::cout << "Error: invalid RAM checkpoint (page_bits=" << page_bits << ")" << std::endl;
+    return false;
+  }
+
+  this->clear();
+  uint32_t page_size = 1 << page_bits_;
+  for (uint64_t i = 0; i < num_pages; ++i) {
+    uint64_t index = 0;
+    read_pod(is, &index);
+    this->check_range(index << page_bits_, page_size);
+    is.read((char*)(base_ + (index << page_bits_)), page_size);
+  }
+  return bool(is);
+}
+
+bool MappedRAM::saveImage(const char* filename) const {
+  int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    std::cout << "Error: cannot create memory image: " << filename << std::endl;
+    return false;
+  }
+  // only dirty pages are written, everything else stays a file hole
+  bool success = (0 == ftruncate(fd, map_size_));
+  uint64_t page_size = 1ull << page_bits_;
+  for (auto index : this->dirty_pages()) {
+    if (!success)
+      break;
+    uint64_t offset = index << page_bits_;
+    success = (ssize_t(page_size) == pwrite(fd, base_ + offset, page_size, offset));
+  }
+  close(fd);
+  if (!success) {
+    std::cout << "Error: failed writing memory image: " << filename << std::endl;
+  }
+  return success;
+}
+
+bool MappedRAM::loadImage(const char* filename) {
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    std::cout << "Error: cannot open memory image: " << filename << std::endl;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || uint64_t(st.st_size) > map_size_) {
+    std::cout << "Error: invalid memory image: " << filename << std::endl;
+    close(fd);
+    return false;
+  }
+  this->clear();
+  // whole host pages past the end of the file would fault, so the tail of
+  // the last page keeps its anonymous mapping
+  uint64_t host_page_size = sysconf(_SC_PAGESIZE);
+  uint64_t file_size = (uint64_t(st.st_size) + host_page_size - 1) & ~(host_page_size - 1);
+  bool success = true;
+  if (file_size != 0) {
+    // the image is mapped copy-on-write, simulation never modifies the file
+    auto base = mmap(base_, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_NORESERVE | MAP_FIXED, fd, 0);
+    success = (base != MAP_FAILED);
+  }
+  if (success) {
+    // record the data extents of the file, its holes read as zero
+    uint64_t page_size = 1ull << page_bits_;
+    image_pages_.assign(map_size_ >> page_bits_, false);
+    off_t end = st.st_size;
+    off_t data = lseek(fd, 0, SEEK_DATA);
+    if (data < 0 && errno != ENXIO) {
+      // no hole reporting, the whole file is data
+      data = 0;
+    }
+    while (data >= 0 && data < end) {
+      off_t hole = lseek(fd, data, SEEK_HOLE);
+      if (hole < 0) {
+        hole = end;
+      }
+      for (uint64_t index = uint64_t(data) >> page_bits_, n = (uint64_t(hole) + page_size - 1) >> page_bits_; index < n; ++index) {
+        image_pages_[index] = true;
+      }
+      data = (hole < end) ? lseek(fd, hole, SEEK_DATA) : -1;
+    }
+  }
+  close(fd);
+  if (!success) {
+    std::cout << "Error: failed mapping memory image: " << filename << std::endl;
+    this->clear();
+  }
+  return success;
+}
@@ -16,6 +16,7 @@
 #include <cstdint>
 #include <vector>
 #include <unordered_map>
+#include <iostream>
 #include <cstdint>
 
 namespace vortex {
@@ -81,11 +82,31 @@ public:
     bool      notFound;
   };
 
+  // page-table walker modes (RISC-V Sv32/Sv39 page tables)
+  enum class VMMode {
+    Bare,
+    Sv32,
+    Sv39,
+  };
+
+  struct TLBStats {
+    uint64_t hits;    // L0 or L1 hits
+    uint64_t misses;  // L1 misses, resolved by the translation map or a walk
+    uint64_t walks;   // page-table walks
+
+    TLBStats()
+      : hits(0)
+      , misses(0)
+      , walks(0)
+    {}
+  };
+
   MemoryUnit(uint64_t pageSize = 0);
 
   void attach(MemDevice &m, uint64_t start, uint64_t end);
 
-  void read(void* data, uint64_t addr, uint64_t size, bool sup);
+  // fetch: instruction fetches need execute permission instead of read
+  void read(void* data, uint64_t addr, uint64_t size, bool sup, bool fetch = false);
   void write(const void* data, uint64_t addr, uint64_t size, bool sup);
 
   void amo_reserve(uint64_t addr);
@@ -93,8 +114,22 @@ public:
 
   void tlbAdd(uint64_t virt, uint64_t phys, uint32_t flags);
   void tlbRm(uint64_t vaddr);
-  void tlbFlush() {
-    tlb_.clear();
+  void tlbFlush();
+
+  // TLB geometry: a direct-mapped L0 in front of a set-associative L1,
+  // sizes are powers of two (0 disables a level)
+  void setTLB(uint32_t l0Size, uint32_t l1Sets, uint32_t l1Ways);
+
+  // translate through the page tables rooted at 'rootPPN' (4KB pages),
+  // Bare disables the walker
+  void setVM(VMMode mode, uint64_t rootPPN);
+
+  // translation of an address accessed earlier, for timing models:
+  // no permission check, no TLB update and no statistics
+  uint64_t peekPhyAddr(uint64_t vAddr) const;
+
+  const TLBStats& tlbStats() const {
+    return tlbStats_;
   }
 
 private:
@@ -131,22 +166,43 @@ private:
     std::vector<entry_t> entries_;
   };
 
+  // flags use the PTE permission bits (V, R, W, X, U, G)
   struct TLBEntry {
     TLBEntry() {}
-    TLBEntry(uint32_t pfn, uint32_t flags)
+    TLBEntry(uint64_t pfn, uint32_t flags)
       : pfn(pfn)
       , flags(flags) 
     {}
-    uint32_t pfn;
+    uint64_t pfn;
     uint32_t flags;
   };
 
-  TLBEntry tlbLookup(uint64_t vAddr, uint32_t flagMask);
+  struct tlb_line_t {
+    uint64_t vpn;
+    TLBEntry entry;
+    uint64_t lru;
+    bool     valid;
+  };
+
+  TLBEntry tlbLookup(uint64_t vAddr, uint32_t flagMask, bool sup);
+
+  TLBEntry tlbRefill(uint64_t vAddr);
+
+  TLBEntry pageWalk(uint64_t vAddr);
 
-  uint64_t toPhyAddr(uint64_t vAddr, uint32_t flagMask);
+  void tlbInvalidate(uint64_t vpn);
+
+  uint64_t toPhyAddr(uint64_t vAddr, uint32_t flagMask, bool sup);
 
   std::unordered_map<uint64_t, TLBEntry> tlb_;
+  std::vector<tlb_line_t> tlb0_;
+  std::vector<tlb_line_t> tlb1_;
+  uint32_t  tlb1Ways_;
+  uint64_t  tlbClock_;
+  TLBStats  tlbStats_;
   uint64_t  pageSize_;
+  VMMode    vmMode_;
+  uint64_t  rootPPN_;
   ADecoder  decoder_;  
   bool      enableVM_;
 
@@ -159,9 +215,9 @@ class RAM : public MemDevice {
 public:
   
    RAM(uint32_t page_size, uint64_t capacity = 0);
-  ~RAM();
+  virtual ~RAM();
 
-  void clear();
+  virtual void clear();
 
   uint64_t size() const override;
 
@@ -171,6 +227,10 @@ public:
   void loadBinImage(const char* filename, uint64_t destination);
   void loadHexImage(const char* filename);
 
+  // checkpoint serialization of the allocated pages
+  virtual void save(std::ostream& os) const;
+  virtual bool load(std::istream& is);
+
   uint8_t& operator[](uint64_t address) {
     return *this->get(address);
   }
@@ -179,15 +239,78 @@ public:
     return *this->get(address);
   }
 
+protected:
+
+  virtual uint8_t *get(uint64_t address) const;
+
+  void check_range(uint64_t addr, uint64_t size) const;
+
+  uint32_t page_bits_;
+
 private:
 
-  uint8_t *get(uint64_t address) const;
+  // Pages are mapped through a two-level table: a flat directory of leaf
+  // tables, each covering (1 << RAM_LEAF_BITS) pages. Directory entries
+  // beyond (1 << RAM_DIR_BITS) are kept in a sparse map.
+  enum {
+    RAM_LEAF_BITS = 10,
+    RAM_DIR_BITS  = 20
+  };
+
+  uint8_t *find_page(uint64_t page_index) const;
+
+  uint8_t *map_page(uint64_t page_index, bool fill) const;
+
+  uint8_t **leaf_entry(uint64_t page_index, bool create) const;
 
   uint64_t capacity_;
-  uint32_t page_bits_;  
-  mutable std::unordered_map<uint64_t, uint8_t*> pages_;
+  mutable std::vector<uint8_t**> page_dir_;
+  mutable std::unordered_map<uint64_t, uint8_t**> far_page_dir_;
+  mutable uint64_t num_pages_;
   mutable uint8_t* last_page_;
   mutable uint64_t last_page_index_;
+  uint8_t* fill_page_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// RAM backed by a single MAP_NORESERVE reservation of the whole device
+// address space, leaving sparsity to the host OS. Untouched memory reads
+// as zero. Memory images are saved as sparse files and reloaded as private
+// copy-on-write file mappings.
+class MappedRAM : public RAM {
+public:
+
+   MappedRAM(uint32_t page_size, uint64_t capacity);
+  ~MappedRAM();
+
+  void clear() override;
+
+  uint64_t size() const override;
+
+  void read(void* data, uint64_t addr, uint64_t size) override;  
+  void write(const void* data, uint64_t addr, uint64_t size) override;
+
+  void save(std::ostream& os) const override;
+  bool load(std::istream& is) override;
+
+  // sparse file snapshots of the whole address space
+  bool saveImage(const char* filename) const;
+  bool loadImage(const char* filename);
+
+protected:
+
+  uint8_t *get(uint64_t address) const override;
+
+private:
+
+  void map_anonymous(uint64_t offset, uint64_t size);
+
+  std::vector<uint64_t> dirty_pages() const;
+
+  uint8_t* base_;
+  uint64_t map_size_;
+  std::vector<bool> image_pages_;
 };
 
 } // namespace vortex
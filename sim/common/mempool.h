@@ -13,50 +13,137 @@
 
 #pragma once
 
-#include <stack>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <mutex>
 
+// Slab allocator for fixed-size objects of type T.
+// Memory is carved out of slabs of 'slab_size' objects and recycled through an
+// intrusive free list threaded through the released objects themselves, so
+// allocation and release never touch the system heap once the pool is warm.
+// Slabs are only returned to the system when the pool is destroyed.
+// Each object remembers the pool that created it, so an object may be released
+// through any pool instance (e.g. one pool per thread) as long as the owning
+// pool is not accessed concurrently.
 template <typename T>
 class MemoryPool {
 public:  
-  MemoryPool(uint32_t max_size) : max_size_(max_size) {}
+  MemoryPool(uint32_t slab_size) 
+    : free_list_(nullptr)
+    , slab_size_(slab_size) 
+  {}
 
   MemoryPool(MemoryPool && other) 
-    : free_list_(std::move(other.free_list_)) 
-  {}
+    : slabs_(std::move(other.slabs_))
+    , free_list_(other.free_list_)
+    , slab_size_(other.slab_size_) {
+    other.free_list_ = nullptr;
+    for (auto slab : slabs_) {
+      for (uint32_t i = 0; i < slab_size_; ++i) {
+        slab[i].owner = this;
+      }
+    }
+  }
 
   ~MemoryPool() {
     this->flush();
   }
 
   void* allocate() {
-    void* mem;
-    if (!free_list_.empty()) {
-      auto entry = free_list_.top();
-      free_list_.pop();
-      mem = static_cast<void*>(entry);      
-    } else {
-      mem = ::operator new(sizeof(T));
+    if (nullptr == free_list_) {
+      this->grow();
     }
-    return mem;
+    auto node = free_list_;
+    free_list_ = node->u.next;
+    return static_cast<void*>(node->u.storage);
   }
 
   void deallocate(void * object) {
-    if (free_list_.size() < max_size_) {
-      free_list_.push(static_cast<T*>(object));
-    } else {
-      ::operator delete(object);
-    }
+    auto node = reinterpret_cast<node_t*>(
+      static_cast<unsigned char*>(object) - offsetof(node_t, u));
+    auto owner = node->owner;
+    node->u.next = owner->free_list_;
+    owner->free_list_ = node;
   }
 
+  // release all slabs, invalidating any outstanding object
   void flush() {
-    while (!free_list_.empty()) {
-      auto entry = free_list_.top();
-      free_list_.pop();
-      ::operator delete(entry);      
+    for (auto slab : slabs_) {
+      delete[] slab;
     }
+    slabs_.clear();
+    free_list_ = nullptr;
   }
 
 private:
-  std::stack<T*> free_list_;
-  uint32_t max_size_;
+
+  struct node_t {
+    MemoryPool* owner;
+    union {
+      node_t* next;
+      alignas(T) unsigned char storage[sizeof(T)];
+    } u;
+  };
+
+  void grow() {
+    auto slab = new node_t[slab_size_];
+    for (uint32_t i = 0; i < slab_size_; ++i) {
+      slab[i].owner = this;
+      slab[i].u.next = free_list_;
+      free_list_ = &slab[i];
+    }
+    slabs_.push_back(slab);
+  }
+
+  std::vector<node_t*> slabs_;
+  node_t* free_list_;
+  uint32_t slab_size_;
+};
+
+// Pool of the calling thread for objects of type T.
+// A thread's pool is handed back when the thread exits and adopted by the next
+// thread that needs one, so restarting worker threads does not grow memory.
+// Objects allocated from a handed-back pool remain valid and are still
+// released to it. Idle pools are kept until the process exits.
+template <typename T>
+class ThreadMemoryPool {
+public:
+  static MemoryPool<T>& get() {
+    static thread_local Handle handle;
+    return *handle.pool;
+  }
+
+private:
+
+  struct Handle {
+    MemoryPool<T>* pool;
+
+    Handle() {
+      std::lock_guard<std::mutex> lock(mutex());
+      auto& pools = idle_pools();
+      if (pools.empty()) {
+        pool = new MemoryPool<T>(64);
+      } else {
+        pool = pools.back();
+        pools.pop_back();
+      }
+    }
+
+    ~Handle() {
+      std::lock_guard<std::mutex> lock(mutex());
+      idle_pools().push_back(pool);
+    }
+  };
+
+  // never destroyed, threads may exit during static destruction
+  static std::mutex& mutex() {
+    static auto instance = new std::mutex();
+    return *instance;
+  }
+
+  static std::vector<MemoryPool<T>*>& idle_pools() {
+    static auto instance = new std::vector<MemoryPool<T>*>();
+    return *instance;
+  }
 };
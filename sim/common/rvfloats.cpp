@@ -13,6 +13,7 @@
 
 #include "rvfloats.h"
 #include <stdio.h>
+#include <string.h>
 
 extern "C" {
 #include <softfloat.h>
@@ -34,6 +35,82 @@ inline void rv_init(uint32_t frm) {
   softfloat_roundingMode = frm;
 }
 
+// lane block size of the host FPU path
+#define FOP_BLOCK 8
+
+inline float u2f(uint32_t x) { float f; memcpy(&f, &x, 4); return f; }
+inline uint32_t f2u(float f) { uint32_t x; memcpy(&x, &f, 4); return x; }
+
+// normal numbers and zeros are handled identically by the host
+inline bool fop_input_ok(uint32_t x) {
+  uint32_t exp = (x >> 23) & 0xff;
+  return exp != 0xff && (exp != 0 || (x & 0x7fffff) == 0);
+}
+
+// results at or near the subnormal range may have underflowed
+inline bool fop_result_ok(uint32_t x) {
+  uint32_t exp = (x >> 23) & 0xff;
+  return exp >= 2 && exp != 0xff;
+}
+
+// Each operation returns the rounded result and whether it is inexact.
+// Products of two floats are exact in double, which gives the rounding error
+// of multiplications, divisions and fused multiply-adds without reading the
+// host FPU flags. The ambiguous flag marks fused results where rounding the
+// double sum to float may differ from a single rounding.
+inline float fop_add(float x, float y, uint32_t* inexact, uint32_t* ambiguous) {
+  // TwoSum: the rounding error of the sum is exact
+  float s  = x + y;
+  float yy = s - x;
+  float e  = (x - (s - yy)) + (y - yy);
+  *inexact = (e != 0.0f);
+  *ambiguous = 0;
+  return s;
+}
+
+inline float fop_mul(float x, float y, uint32_t* inexact, uint32_t* ambiguous) {
+  double p = double(x) * double(y);
+  float r  = float(p);
+  *inexact = (double(r) != p);
+  *ambiguous = 0;
+  return r;
+}
+
+inline float fop_div(float x, float y, uint32_t* inexact, uint32_t* ambiguous) {
+  float q = x / y;
+  *inexact = (double(q) * double(y) != double(x));
+  *ambiguous = 0;
+  return q;
+}
+
+inline float fop_fma(float x, float y, float z, uint32_t* inexact, uint32_t* ambiguous) {
+  double p  = double(x) * double(y);
+  double zz = double(z);
+  double s  = p + zz;
+  double pp = s - zz;
+  double e  = (zz - (s - pp)) + (p - pp);
+  float r   = float(s);
+  // rounding an inexact double to float twice only errs on a float midpoint
+  uint64_t bits;
+  memcpy(&bits, &s, 8);
+  uint32_t midpoint = (bits & 0x1fffffff) == 0x10000000;
+  *inexact = (e != 0.0) | (double(r) != s);
+  *ambiguous = (e != 0.0) & midpoint;
+  return r;
+}
+
+template <typename Op>
+inline void fop_lanes(const float* __restrict a, const float* __restrict b, const float* __restrict c, 
+                      float* __restrict r, uint32_t* __restrict inexact, uint32_t* __restrict ambiguous, 
+                      uint32_t num_lanes, const Op& op) {
+  for (size_t t = 0; t < num_lanes; t += FOP_BLOCK) {
+    for (size_t j = 0; j < FOP_BLOCK; ++j) {
+      size_t i = t + j;
+      r[i] = op(a[i], b[i], c[i], &inexact[i], &ambiguous[i]);
+    }
+  }
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -496,6 +573,80 @@ uint64_t rv_ftod(uint32_t a) {
   return from_float64_t(r);
 }
 
+uint32_t rv_fop_s_lanes(uint32_t op, const uint32_t* a, const uint32_t* b, const uint32_t* c, 
+                        uint32_t* r, uint32_t num_lanes, uint32_t mask, uint32_t* fflags) {
+  float fa[32], fb[32], fc[32];
+  uint32_t num_srcs = (op >= RV_FOP_MADD) ? 3 : 2;
+  uint32_t soft_mask = 0;
+
+  // inactive and rejected lanes compute 1.0 op 1.0
+  uint32_t padded_lanes = (num_lanes + FOP_BLOCK - 1) & ~(FOP_BLOCK - 1);
+  for (uint32_t t = 0; t < num_lanes; ++t) {
+    uint32_t active = (mask >> t) & 0x1;
+    uint32_t valid = active 
+                   & fop_input_ok(a[t]) 
+                   & fop_input_ok(b[t]) 
+                   & (num_srcs < 3 || fop_input_ok(c[t]));
+    fa[t] = valid ? u2f(a[t]) : 1.0f;
+    fb[t] = valid ? u2f(b[t]) : 1.0f;
+    fc[t] = (valid && num_srcs == 3) ? u2f(c[t]) : 1.0f;
+    soft_mask |= (active & ~valid) << t;
+  }
+  for (uint32_t t = num_lanes; t < padded_lanes; ++t) {
+    fa[t] = fb[t] = fc[t] = 1.0f;
+  }
+
+  // the host environment is RNE with no flush-to-zero
+  float fr[32];
+  uint32_t fnx[32], famb[32];
+  switch (op) {
+  case RV_FOP_ADD:   fop_lanes(fa, fb, fc, fr, fnx, famb, padded_lanes, [](float x, float y, float, uint32_t* nx, uint32_t* am) { return fop_add(x, y, nx, am); }); break;
+  case RV_FOP_SUB:   fop_lanes(fa, fb, fc, fr, fnx, famb, padded_lanes, [](float x, float y, float, uint32_t* nx, uint32_t* am) { return fop_add(x, -y, nx, am); }); break;
+  case RV_FOP_MUL:   fop_lanes(fa, fb, fc, fr, fnx, famb, padded_lanes, [](float x, float y, float, uint32_t* nx, uint32_t* am) { return fop_mul(x, y, nx, am); }); break;
+  case RV_FOP_DIV:   fop_lanes(fa, fb, fc, fr, fnx, famb, padded_lanes, [](float x, float y, float, uint32_t* nx, uint32_t* am) { return fop_div(x, y, nx, am); }); break;
+  case RV_FOP_MADD:  fop_lanes(fa, fb, fc, fr, fnx, famb, padded_lanes, [](float x, float y, float z, uint32_t* nx, uint32_t* am) { return fop_fma(x, y, z, nx, am); }); break;
+  case RV_FOP_MSUB:  fop_lanes(fa, fb, fc, fr, fnx, famb, padded_lanes, [](float x, float y, float z, uint32_t* nx, uint32_t* am) { return fop_fma(x, y, -z, nx, am); }); break;
+  case RV_FOP_NMADD: fop_lanes(fa, fb, fc, fr, fnx, famb, padded_lanes, [](float x, float y, float z, uint32_t* nx, uint32_t* am) { return fop_fma(-x, y, -z, nx, am); }); break;
+  case RV_FOP_NMSUB: fop_lanes(fa, fb, fc, fr, fnx, famb, padded_lanes, [](float x, float y, float z, uint32_t* nx, uint32_t* am) { return fop_fma(-x, y, z, nx, am); }); break;
+  default: 
+    return mask;
+  }
+
+  uint32_t inexact = 0;
+  for (uint32_t t = 0; t < num_lanes; ++t) {
+    if (!((mask >> t) & 0x1) || ((soft_mask >> t) & 0x1))
+      continue;
+    uint32_t x = f2u(fr[t]);
+    bool ok = fop_result_ok(x) && !famb[t];
+    if (!ok && (x & 0x7fffffff) == 0) {
+      // exact zeros: additions cannot underflow, products need a zero factor
+      switch (op) {
+      case RV_FOP_ADD:
+      case RV_FOP_SUB:
+        ok = true;
+        break;
+      case RV_FOP_MUL:
+        ok = (a[t] & 0x7fffffff) == 0 || (b[t] & 0x7fffffff) == 0;
+        break;
+      case RV_FOP_DIV:
+        ok = (a[t] & 0x7fffffff) == 0;
+        break;
+      default:
+        break;
+      }
+    }
+    if (ok) {
+      r[t] = x;
+      inexact |= fnx[t];
+    } else {
+      soft_mask |= (1u << t);
+    }
+  }
+
+  *fflags = inexact; // NX
+  return soft_mask;
+}
+
 #ifdef __cplusplus
 }
 #endif
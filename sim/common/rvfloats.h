@@ -87,6 +87,27 @@ uint64_t rv_fmax_d(uint64_t a, uint64_t b, uint32_t* fflags);
 uint32_t rv_dtof(uint64_t a);
 uint64_t rv_ftod(uint32_t a);
 
+///////////////////////////////////////////////////////////////////////////////
+
+enum {
+  RV_FOP_ADD,
+  RV_FOP_SUB,
+  RV_FOP_MUL,
+  RV_FOP_DIV,
+  RV_FOP_MADD,
+  RV_FOP_MSUB,
+  RV_FOP_NMADD,
+  RV_FOP_NMSUB
+};
+
+// Host FPU evaluation of a single-precision operation with RNE rounding over
+// the lanes in 'mask' (up to 32). Lanes whose operands or result fall outside
+// the range where the host matches RISC-V semantics (NaN, infinity, subnormal,
+// underflow) are left out and returned as a mask for SoftFloat evaluation.
+// 'fflags' receives the flags raised by the computed lanes.
+uint32_t rv_fop_s_lanes(uint32_t op, const uint32_t* a, const uint32_t* b, const uint32_t* c, 
+                        uint32_t* r, uint32_t num_lanes, uint32_t mask, uint32_t* fflags);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,79 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <bitset>
+#include <type_traits>
+
+// Binary serialization helpers used by simulator checkpoints.
+// Values are stored in host byte order.
+
+namespace vortex {
+
+template <typename T>
+void write_pod(std::ostream& os, const T& value) {
+  static_assert(std::is_trivially_copyable<T>::value, "invalid type");
+  os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void read_pod(std::istream& is, T* value) {
+  static_assert(std::is_trivially_copyable<T>::value, "invalid type");
+  is.read(reinterpret_cast<char*>(value), sizeof(T));
+}
+
+template <typename T>
+void write_vector(std::ostream& os, const std::vector<T>& values) {
+  static_assert(std::is_trivially_copyable<T>::value, "invalid type");
+  write_pod(os, uint64_t(values.size()));
+  os.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+template <typename T>
+void read_vector(std::istream& is, std::vector<T>* values) {
+  static_assert(std::is_trivially_copyable<T>::value, "invalid type");
+  uint64_t size = 0;
+  read_pod(is, &size);
+  if (!is)
+    return;
+  values->resize(size);
+  is.read(reinterpret_cast<char*>(values->data()), size * sizeof(T));
+}
+
+template <size_t N>
+void write_bits(std::ostream& os, const std::bitset<N>& bits) {
+  for (size_t i = 0; i < N; i += 8) {
+    uint8_t byte = 0;
+    for (size_t j = 0; j < 8 && (i + j) < N; ++j) {
+      byte |= uint8_t(bits.test(i + j)) << j;
+    }
+    write_pod(os, byte);
+  }
+}
+
+template <size_t N>
+void read_bits(std::istream& is, std::bitset<N>* bits) {
+  for (size_t i = 0; i < N; i += 8) {
+    uint8_t byte = 0;
+    read_pod(is, &byte);
+    for (size_t j = 0; j < 8 && (i + j) < N; ++j) {
+      bits->set(i + j, (byte >> j) & 0x1);
+    }
+  }
+}
+
+}
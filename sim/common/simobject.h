@@ -19,6 +19,10 @@
 #include <vector>
 #include <list>
 #include <queue>
+#include <map>
+#include <atomic>
+#include <thread>
+#include <algorithm>
 #include <assert.h>
 #include "mempool.h"
 
@@ -140,10 +144,10 @@ protected:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Scheduled events are owned by the platform's event wheel and linked
+// intrusively through next_, with storage coming from a per-type slab pool.
 class SimEventBase {
 public:
-  typedef std::shared_ptr<SimEventBase> Ptr;
-
   virtual ~SimEventBase() {}
   
   virtual void fire() const = 0;
@@ -153,9 +157,17 @@ public:
   }
 
 protected:
-  SimEventBase(uint64_t cycles) : cycles_(cycles) {}
+  SimEventBase(uint64_t cycles) 
+    : cycles_(cycles)
+    , next_(nullptr) 
+  {}
 
   uint64_t cycles_;
+
+private:
+  SimEventBase* next_;
+
+  friend class SimEventWheel;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -187,9 +199,12 @@ protected:
   Func func_;
   Pkt  pkt_;
 
+  // one pool per thread so that concurrently ticked objects allocate without
+  // locking; events are released serially and return to their owning pool.
+  // pools are never destroyed so that events released during static
+  // destruction of the platform remain valid
   static MemoryPool<SimCallEvent<Pkt>>& allocator() {
-    static MemoryPool<SimCallEvent<Pkt>> instance(64);
-    return instance;
+    return ThreadMemoryPool<SimCallEvent<Pkt>>::get();
   }
 };
 
@@ -220,10 +235,140 @@ protected:
   const SimPort<Pkt>* port_; 
   Pkt pkt_;
 
+  // one pool per thread so that concurrently ticked objects allocate without
+  // locking; events are released serially and return to their owning pool.
+  // pools are never destroyed so that events released during static
+  // destruction of the platform remain valid
   static MemoryPool<SimPortEvent<Pkt>>& allocator() {
-    static MemoryPool<SimPortEvent<Pkt>> instance(64);
-    return instance;
+    return ThreadMemoryPool<SimPortEvent<Pkt>>::get();
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Timing wheel of pending events keyed on their firing cycle.
+// Events within the wheel's horizon are chained by (cycle % num_slots) so that
+// firing a cycle only touches the events due at that cycle. Events scheduled
+// further out are parked in an ordered overflow map and migrated into the wheel
+// as the horizon advances. Events due at the same cycle fire in schedule order
+// and are released together once the whole slot has fired.
+class SimEventWheel {
+public:
+  SimEventWheel(uint32_t num_slots = 256)
+    : slots_(num_slots)
+    , slot_mask_(num_slots - 1)
+    , size_(0)
+  {
+    assert(num_slots != 0 && 0 == (num_slots & (num_slots - 1)));
+  }
+
+  ~SimEventWheel() {
+    this->clear();
+  }
+
+  bool empty() const {
+    return (0 == size_);
+  }
+
+  uint64_t size() const {
+    return size_;
+  }
+
+  // take ownership of the event
+  void push(SimEventBase* event, uint64_t cycles) {
+    assert(event->cycles() > cycles);
+    if ((event->cycles() - cycles) < slots_.size()) {
+      slots_.at(event->cycles() & slot_mask_).push(event);
+    } else {
+      overflow_.emplace(event->cycles(), event);
+    }
+    ++size_;
+  }
+
+  // fire all events due at the given cycle
+  void fire(uint64_t cycles) {
+    auto& slot = slots_.at(cycles & slot_mask_);
+    auto head = slot.head;
+    if (nullptr == head)
+      return;
+    for (auto event = head; event != nullptr; event = event->next_) {
+      assert(event->cycles() == cycles);
+      event->fire();
+    }
+    slot.head = nullptr;
+    slot.tail = nullptr;
+    size_ -= release(head);
+  }
+
+  // move overflow events entering the horizon of the given cycle into the wheel
+  void advance(uint64_t cycles) {
+    while (!overflow_.empty()) {
+      auto it = overflow_.begin();
+      if ((it->first - cycles) >= slots_.size())
+        break;
+      slots_.at(it->first & slot_mask_).push(it->second);
+      overflow_.erase(it);
+    }
+  }
+
+  // cycle of the earliest pending event, or UINT64_MAX if none
+  uint64_t next_cycle(uint64_t cycles) const {
+    if (0 == size_)
+      return UINT64_MAX;
+    for (uint64_t i = 0, n = slots_.size(); i < n; ++i) {
+      if (slots_.at((cycles + i) & slot_mask_).head)
+        return cycles + i;
+    }
+    return overflow_.begin()->first;
+  }
+
+  void clear() {
+    for (auto& slot : slots_) {
+      release(slot.head);
+      slot.head = nullptr;
+      slot.tail = nullptr;
+    }
+    for (auto& entry : overflow_) {
+      delete entry.second;
+    }
+    overflow_.clear();
+    size_ = 0;
+  }
+
+private:
+
+  struct slot_t {
+    SimEventBase* head;
+    SimEventBase* tail;
+
+    slot_t() : head(nullptr), tail(nullptr) {}
+
+    void push(SimEventBase* event) {
+      event->next_ = nullptr;
+      if (tail) {
+        tail->next_ = event;
+      } else {
+        head = event;
+      }
+      tail = event;
+    }
+  };
+
+  static uint64_t release(SimEventBase* event) {
+    uint64_t count = 0;
+    while (event) {
+      auto next = event->next_;
+      delete event;
+      event = next;
+      ++count;
+    }
+    return count;
   }
+
+  std::vector<slot_t> slots_;
+  std::multimap<uint64_t, SimEventBase*> overflow_;
+  uint64_t slot_mask_;
+  uint64_t size_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -240,6 +385,10 @@ public:
     return name_;
   } 
 
+  uint32_t partition() const {
+    return partition_;
+  }
+
 protected:
 
   SimObjectBase(const SimContext& ctx, const char* name); 
@@ -250,7 +399,38 @@ private:
 
   virtual void do_tick() = 0;
 
+  virtual bool do_idle() const = 0;
+
+  virtual void do_skip(uint64_t cycles) = 0;
+
+  // ticks the object unless it is idle, returns false if the tick was elided
+  bool step(uint64_t cycles) {
+    if (this->do_idle()) {
+      if (!idle_) {
+        idle_ = true;
+        idle_start_ = cycles;
+      }
+      return false;
+    }
+    this->wake(cycles);
+    this->do_tick();
+    return true;
+  }
+
+  // accounts for the ticks elided since the object went idle
+  void wake(uint64_t cycles) {
+    if (!idle_)
+      return;
+    idle_ = false;
+    if (cycles != idle_start_) {
+      this->do_skip(cycles - idle_start_);
+    }
+  }
+
   std::string name_;
+  uint32_t partition_;
+  bool idle_;
+  uint64_t idle_start_;
 
   friend class SimPlatform;
 };
@@ -288,6 +468,25 @@ private:
   void do_tick() override {
     this->impl()->tick();
   }
+
+  bool do_idle() const override {
+    return this->impl()->idle();
+  }
+
+  void do_skip(uint64_t cycles) override {
+    this->impl()->skip(cycles);
+  }
+
+protected:
+
+  // Objects opt into idle elision by hiding these two methods: idle() returns
+  // true when tick() would leave the object unchanged, except for per-cycle
+  // state that skip() can advance in bulk once the object is ticked again.
+  bool idle() const {
+    return false;
+  }
+
+  void skip(uint64_t /*cycles*/) {}
 };
 
 class SimContext {
@@ -319,11 +518,50 @@ public:
   typename SimObject<Impl>::Ptr create_object(Args&&... args) {
     auto obj = std::make_shared<Impl>(SimContext{}, std::forward<Args>(args)...);
     objects_.push_back(obj);
+    partitions_dirty_ = true;
     return obj;
   }
 
   void release_object(const SimObjectBase::Ptr& object) {
     objects_.remove(object);
+    partitions_dirty_ = true;
+  }
+
+  // Objects are assigned to the partition selected at their creation.
+  // Partition 0 is always ticked first on the calling thread; the remaining
+  // partitions only interact through delayed events and may be ticked
+  // concurrently. Objects must be created in increasing partition order.
+  void set_partition(uint32_t partition) {
+    partition_ = partition;
+  }
+
+  uint32_t partition() const {
+    return partition_;
+  }
+
+  // number of threads used to tick partitions > 0
+  void set_num_threads(uint32_t num_threads) {
+    num_threads = std::max<uint32_t>(num_threads, 1);
+    if (num_threads == num_threads_)
+      return; // keep the running workers
+    this->stop_workers();
+    num_threads_ = num_threads;
+    partitions_dirty_ = true;
+  }
+
+  uint32_t num_threads() const {
+    return num_threads_;
+  }
+
+  // Blocks until all lower partitions have completed the current tick.
+  // Objects call it before touching state shared across partitions (e.g.
+  // functional memory) so that accesses happen in sequential tick order.
+  void wait_turn() {
+    auto ctx = tls_context();
+    if (nullptr == ctx || ctx->has_turn)
+      return;
+    spin_wait([&]{ return turn_.load(std::memory_order_acquire) == ctx->partition; });
+    ctx->has_turn = true;
   }
 
   template <typename Pkt>
@@ -331,37 +569,51 @@ public:
                 const Pkt& pkt, 
                 uint64_t delay) {    
     assert(delay != 0);
-    auto evt = std::make_shared<SimCallEvent<Pkt>>(callback, pkt, cycles_ + delay);    
-    events_.emplace_back(evt);
+    auto evt = new SimCallEvent<Pkt>(callback, pkt, cycles_ + delay);    
+    this->push_event(evt);
   }
 
   void reset() {
     events_.clear();
     for (auto& object : objects_) {
+      object->idle_ = false;
       object->do_reset();
     }
     cycles_ = 0;
   }
 
-  void tick() {
+  // returns false once every object is idle and no event is pending
+  bool tick() {
     // evaluate events
-    auto evt_it = events_.begin();
-    auto evt_it_end = events_.end();
-    while (evt_it != evt_it_end) {
-      auto& event = *evt_it;
-      if (cycles_ >= event->cycles()) {        
-        event->fire();
-        evt_it = events_.erase(evt_it);
-      } else {        
-        ++evt_it;
-      }
-    }
+    events_.fire(cycles_);
     // evaluate components
-    for (auto& object : objects_) {
-      object->do_tick();
+    bool busy = false;
+    if (num_threads_ > 1 && this->prepare_workers()) {
+      busy = this->tick_parallel();
+    } else {
+      for (auto& object : objects_) {
+        busy |= object->step(cycles_);
+      }
     }
     // advance clock    
     ++cycles_;
+    events_.advance(cycles_);
+    // with every object idle, nothing changes until the next event fires
+    if (!busy) {
+      auto next = events_.next_cycle(cycles_);
+      if (next != UINT64_MAX && next > cycles_) {
+        cycles_ = next;
+        events_.advance(cycles_);
+      }
+    }
+    return busy || !events_.empty();
+  }
+
+  // bring idle objects up to date before reading their statistics
+  void sync() {
+    for (auto& object : objects_) {
+      object->wake(cycles_);
+    }
   }
 
   uint64_t cycles() const {
@@ -370,27 +622,183 @@ public:
 
 private:
 
-  SimPlatform() : cycles_(0) {}
+  // per-thread state of the partition being ticked
+  struct context_t {
+    uint32_t partition;
+    bool     has_turn;
+    std::vector<SimEventBase*>* events;
+  };
+
+  SimPlatform() 
+    : cycles_(0)
+    , partition_(0)
+    , num_threads_(1)
+    , partitions_dirty_(true)
+    , parallel_(false)
+    , stop_(false)
+    , epoch_(0)
+    , pending_(0)
+    , turn_(0)
+    , busy_(false)
+  {}
 
   virtual ~SimPlatform() {
     this->clear();
   }
 
   void clear() {
+    this->stop_workers();
     objects_.clear();
     events_.clear();
+    partitions_.clear();
+    partitions_dirty_ = true;
+    partition_ = 0;
   }
 
   template <typename Pkt>
   void schedule(const SimPort<Pkt>* port, const Pkt& pkt, uint64_t delay) {
     assert(delay != 0);
-    auto evt = SimEventBase::Ptr(new SimPortEvent<Pkt>(port, pkt, cycles_ + delay));
-    events_.emplace_back(evt);
+    auto evt = new SimPortEvent<Pkt>(port, pkt, cycles_ + delay);
+    this->push_event(evt);
+  }
+
+  void push_event(SimEventBase* evt) {
+    // events scheduled by concurrent partitions are buffered and merged in
+    // partition order at the end of the tick to preserve the firing order
+    auto ctx = tls_context();
+    if (ctx) {
+      ctx->events->push_back(evt);
+    } else {
+      events_.push(evt, cycles_);
+    }
+  }
+
+  static context_t*& tls_context() {
+    static thread_local context_t* ctx = nullptr;
+    return ctx;
+  }
+
+  template <typename Pred>
+  static void spin_wait(const Pred& pred) {
+    uint32_t spins = 0;
+    while (!pred()) {
+      if (++spins >= 64) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  // group objects by partition and start the worker threads,
+  // returns false if the object list cannot be ticked in parallel
+  bool prepare_workers() {
+    if (!partitions_dirty_)
+      return parallel_;
+    this->stop_workers();
+    partitions_dirty_ = false;
+    parallel_ = false;
+    partitions_.clear();
+    for (auto& object : objects_) {
+      auto pid = object->partition_;
+      if (pid + 1 < partitions_.size())
+        return false; // out of order
+      partitions_.resize(pid + 1);
+      partitions_.at(pid).push_back(object.get());
+    }
+    uint32_t num_partitions = partitions_.size();
+    if (num_partitions < 3)
+      return false; // nothing to overlap
+    buffers_.resize(num_partitions);
+    uint32_t num_workers = std::min(num_threads_, num_partitions - 1);
+    chunks_.resize(num_workers + 1);
+    for (uint32_t i = 0; i <= num_workers; ++i) {
+      chunks_.at(i) = 1 + (i * (num_partitions - 1)) / num_workers;
+    }
+    stop_ = false;
+    auto epoch = epoch_.load(std::memory_order_relaxed);
+    for (uint32_t i = 1; i < num_workers; ++i) {
+      workers_.emplace_back([this, i, epoch]{ this->worker_main(i, epoch); });
+    }
+    parallel_ = true;
+    return true;
+  }
+
+  void stop_workers() {
+    if (workers_.empty())
+      return;
+    stop_ = true;
+    epoch_.fetch_add(1, std::memory_order_release);
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+    workers_.clear();
+  }
+
+  void worker_main(uint32_t index, uint64_t epoch) {
+    for (;;) {
+      spin_wait([&]{ return epoch_.load(std::memory_order_acquire) != epoch; });
+      epoch = epoch_.load(std::memory_order_acquire);
+      if (stop_)
+        break;
+      this->tick_chunk(index);
+      pending_.fetch_sub(1, std::memory_order_release);
+    }
+  }
+
+  void tick_chunk(uint32_t index) {
+    for (uint32_t pid = chunks_.at(index), end = chunks_.at(index + 1); pid < end; ++pid) {
+      context_t ctx{pid, false, &buffers_.at(pid)};
+      tls_context() = &ctx;
+      bool busy = false;
+      for (auto object : partitions_.at(pid)) {
+        busy |= object->step(cycles_);
+      }
+      if (busy) {
+        busy_.store(true, std::memory_order_relaxed);
+      }
+      this->wait_turn();
+      tls_context() = nullptr;
+      turn_.store(pid + 1, std::memory_order_release);
+    }
+  }
+
+  bool tick_parallel() {
+    bool busy = false;
+    for (auto object : partitions_.at(0)) {
+      busy |= object->step(cycles_);
+    }
+    busy_.store(busy, std::memory_order_relaxed);
+    turn_.store(1, std::memory_order_relaxed);
+    pending_.store(workers_.size(), std::memory_order_relaxed);
+    epoch_.fetch_add(1, std::memory_order_release);
+    this->tick_chunk(0);
+    spin_wait([&]{ return pending_.load(std::memory_order_acquire) == 0; });
+    for (uint32_t pid = 1; pid < buffers_.size(); ++pid) {
+      auto& buffer = buffers_.at(pid);
+      for (auto evt : buffer) {
+        events_.push(evt, cycles_);
+      }
+      buffer.clear();
+    }
+    return busy_.load(std::memory_order_relaxed);
   }
 
   std::list<SimObjectBase::Ptr> objects_;
-  std::list<SimEventBase::Ptr> events_;
+  SimEventWheel events_;
   uint64_t cycles_;
+  uint32_t partition_;
+  uint32_t num_threads_;
+
+  std::vector<std::vector<SimObjectBase*>> partitions_;
+  std::vector<std::vector<SimEventBase*>> buffers_;
+  std::vector<uint32_t> chunks_;
+  std::vector<std::thread> workers_;
+  bool partitions_dirty_;
+  bool parallel_;
+  std::atomic<bool> stop_;
+  std::atomic<uint64_t> epoch_;
+  std::atomic<uint32_t> pending_;
+  std::atomic<uint32_t> turn_;
+  std::atomic<bool> busy_;
 
   template <typename U> friend class SimPort;
   friend class SimObjectBase;
@@ -399,7 +807,10 @@ private:
 ///////////////////////////////////////////////////////////////////////////////
 
 inline SimObjectBase::SimObjectBase(const SimContext&, const char* name) 
-  : name_(name) 
+  : name_(name)
+  , partition_(SimPlatform::instance().partition())
+  , idle_(false)
+  , idle_start_(0)
 {}
 
 template <typename Impl>
@@ -24,12 +24,9 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <stdlib.h>
 #include <mem.h>
-
-#define RAMULATOR
-#include <ramulator/src/Gem5Wrapper.h>
-#include <ramulator/src/Request.h>
-#include <ramulator/src/Statistics.h>
+#include <dram_sim.h>
 
 #include <VX_config.h>
 #include <vortex_afu.h>
@@ -127,17 +124,14 @@ public:
 
     ram_ = new RAM(RAM_PAGE_SIZE);
 
-    // initialize dram simulator
-    ramulator::Config ram_config;
-    ram_config.add("standard", "DDR4");
-    ram_config.add("channels", std::to_string(MEMORY_BANKS));
-    ram_config.add("ranks", "1");
-    ram_config.add("speed", "DDR4_2400R");
-    ram_config.add("org", "DDR4_4Gb_x8");
-    ram_config.add("mapping", "defaultmapping");
-    ram_config.set_core_num(1);
-    dram_ = new ramulator::Gem5Wrapper(ram_config, MEM_BLOCK_SIZE);
-    Stats::statlist.output("ramulator.ddr4.log");
+    // initialize dram simulator (e.g. VORTEX_DRAM=standard=HBM,channels=8)
+    DramSim::Config dram_config;
+    dram_config.channels = MEMORY_BANKS;
+    auto dram_s = getenv("VORTEX_DRAM");
+    if (dram_s && !DramSim::Config::parse(dram_s, &dram_config)) {
+      std::abort();
+    }
+    dram_ = new DramSim(dram_config, MEM_BLOCK_SIZE, 1);
 
     // reset the device
     this->reset();
@@ -167,11 +161,7 @@ public:
     
     delete ram_;
 
-    if (dram_) {
-      dram_->finish();
-      Stats::statlist.printall();
-      delete dram_;
-    }
+    delete dram_;
   }
 
   int prepare_buffer(uint64_t len, void **buf_addr, uint64_t *wsid, int flags) {
@@ -286,7 +276,8 @@ private:
     this->avs_bus();
 
     if (!dram_queue_.empty()) {
-      if (dram_->send(dram_queue_.front()))
+      auto& dram_req = dram_queue_.front();
+      if (dram_->send(dram_req.addr, dram_req.write, 0, dram_req.callback))
         dram_queue_.pop();
     }
         
@@ -433,12 +424,7 @@ private:
         printf("\n");*/
 
         // send dram request
-        ramulator::Request dram_req( 
-          byte_addr,
-          ramulator::Request::Type::WRITE,
-          0
-        );
-        dram_queue_.push(dram_req);
+        dram_queue_.push({byte_addr, true, nullptr});
       } else
       if (device_->avs_read[b]) {
         auto mem_req = new mem_rd_req_t();
@@ -457,15 +443,9 @@ private:
         printf("}\n");*/
 
         // send dram request
-        ramulator::Request dram_req( 
-          byte_addr,
-          ramulator::Request::Type::READ,
-          std::bind([](ramulator::Request& dram_req, mem_rd_req_t* mem_req) {
-              mem_req->ready = true;
-            }, placeholders::_1, mem_req),
-          0
-        );
-        dram_queue_.push(dram_req);
+        dram_queue_.push({byte_addr, false, [mem_req]() {
+          mem_req->ready = true;
+        }});
       }
 
       device_->avs_waitrequest[b] = false;
@@ -512,9 +492,15 @@ private:
 
   RAM* ram_;
 
-  ramulator::Gem5Wrapper* dram_;
+  struct dram_req_t {
+    uint64_t addr;
+    bool write;
+    DramSim::ResponseCallback callback;
+  };
+
+  DramSim* dram_;
 
-  std::queue<ramulator::Request> dram_queue_;
+  std::queue<dram_req_t> dram_queue_;
 
   Vvortex_afu_shim *device_;
 #ifdef VCD_OUTPUT
@@ -0,0 +1,451 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cosim.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <deque>
+#include <vector>
+#include <stdlib.h>
+#include <verilated.h>
+#include <mem.h>
+#include <VX_config.h>
+#include <VX_types.h>
+#include "processor_impl.h"
+#include "instr.h"
+
+using namespace vortex;
+
+namespace {
+
+// instructions the model may run ahead of the RTL commits of a warp: the
+// execution units have different latencies, so a warp commits out of order
+const uint32_t COSIM_LOOKAHEAD = 32;
+
+// floating-point registers are numbered after the integer ones, as in the RTL
+const uint32_t COSIM_FREG_BASE = 32;
+
+// the cycle and performance counters (and their user-mode shadows) and the
+// mask of the active warps depend on the timing, the model takes the values
+// read by the RTL
+bool is_timing_csr(uint32_t addr) {
+  if (addr == VX_CSR_WARP_MASK)
+    return true;
+  auto base = addr & ~0x1fu;
+  return base == VX_CSR_MPM_BASE || base == VX_CSR_MPM_BASE_H
+      || base == (VX_CSR_MPM_BASE + 0x100) || base == (VX_CSR_MPM_BASE_H + 0x100);
+}
+
+bool is_timing_read(uint32_t code) {
+  uint32_t opcode = code & 0x7f;
+  uint32_t func3  = (code >> 12) & 0x7;
+  return opcode == 0x73 && func3 != 0 && is_timing_csr(code >> 20);
+}
+
+// loads, stores and atomics read memory shared with the other warps, the
+// model executes them in the RTL commit order
+bool is_memory_access(uint32_t code) {
+  switch (Opcode(code & 0x7f)) {
+  case Opcode::L_INST:
+  case Opcode::S_INST:
+  case Opcode::FL:
+  case Opcode::FS:
+  case Opcode::AMO:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// the model runs on the fixed-latency DRAM model: ramulator keeps global
+// statistics that a second instance beside rtlsim's own would assert on
+DramSim::Config cosim_dram_config() {
+  DramSim::Config config;
+  config.standard = "fixed";
+  return config;
+}
+
+struct cosim_instr_t {
+  uint64_t PC;
+  uint64_t tmask;
+  bool     wb;
+  uint32_t rd;
+  bool     timing;
+  std::vector<uint64_t> data;
+};
+
+struct cosim_warp_t {
+  // executed by the model, waiting for their RTL commit, in program order
+  std::deque<cosim_instr_t> pending;
+  // committed by the RTL, waiting for their last packet
+  std::vector<cosim_instr_t> partial;
+  // committed by the RTL before the model could execute them: past a timing CSR
+  // read or a memory access not committed yet, or while the model warp waits
+  // at a barrier
+  std::vector<cosim_instr_t> deferred;
+  // data of the commit packet in flight
+  std::vector<uint64_t> lanes;
+  // the last pending instruction is a timing CSR read
+  bool     fenced;
+  uint64_t committed;
+  uint64_t last_PC;
+};
+
+}
+
+class CoSim::Impl {
+public:
+  Impl()
+    : arch_(NUM_THREADS, NUM_WARPS, NUM_CORES, NUM_CLUSTERS)
+    , model_(arch_, cosim_dram_config())
+    , decoder_(arch_)
+    , ram_(RAM_PAGE_SIZE)
+    , warps_(arch_.num_clusters() * arch_.num_cores() * arch_.num_warps())
+  {
+    model_.attach_ram(&ram_);
+  }
+
+  void write_dcr(uint32_t addr, uint32_t value) {
+    model_.write_dcr(addr, value);
+  }
+
+  void start(const RAM& ram) {
+    std::stringstream ss;
+    ram.save(ss);
+    if (!ram_.load(ss)) {
+      std::cout << "Error: co-simulation cannot copy the device memory" << std::endl;
+      std::abort();
+    }
+    model_.start();
+    for (auto& warp : warps_) {
+      warp.pending.clear();
+      warp.partial.clear();
+      warp.deferred.clear();
+      warp.lanes.assign(arch_.num_threads(), 0);
+      warp.fenced = false;
+      warp.committed = 0;
+      warp.last_PC = 0;
+    }
+    cycle_ = 0;
+  }
+
+  void finish() {
+    for (uint32_t i = 0; i < warps_.size(); ++i) {
+      auto& warp = warps_.at(i);
+      uint32_t core_id = i / arch_.num_warps();
+      uint32_t wid = i % arch_.num_warps();
+      this->retry(core_id, wid);
+      if (!warp.deferred.empty()) {
+        this->report("the model cannot execute the committed instruction", core_id, wid, &warp.deferred.front(), nullptr);
+      }
+      if (!warp.pending.empty()) {
+        this->report("the RTL did not commit the executed instruction", core_id, wid, nullptr, &warp.pending.front());
+      }
+      if (model_.core(core_id)->warp(wid).getTmask() != 0) {
+        this->report("the model warp has not completed", core_id, wid, nullptr, nullptr);
+      }
+    }
+  }
+
+  void commit_data(uint32_t core_id, uint32_t wid, uint32_t tid, uint64_t value) {
+    this->warp(core_id, wid).lanes.at(tid) = value;
+  }
+
+  void commit(uint64_t cycle, uint32_t core_id, uint32_t wid, uint64_t PC, uint64_t tmask, bool wb, uint32_t rd, bool eop) {
+    cycle_ = cycle;
+    auto& warp = this->warp(core_id, wid);
+
+    // merge the packets of an instruction
+    auto it = warp.partial.begin();
+    while (it != warp.partial.end() && it->PC != PC) {
+      ++it;
+    }
+    if (it == warp.partial.end()) {
+      cosim_instr_t instr;
+      instr.PC = PC;
+      instr.tmask = 0;
+      instr.wb = wb && (rd != 0);
+      instr.rd = rd;
+      instr.timing = false;
+      instr.data.resize(arch_.num_threads());
+      it = warp.partial.insert(warp.partial.end(), instr);
+    }
+    for (uint32_t t = 0; t < arch_.num_threads(); ++t) {
+      if (tmask & (1ull << t)) {
+        it->data.at(t) = warp.lanes.at(t);
+      }
+    }
+    it->tmask |= tmask;
+    if (!eop)
+      return;
+
+    auto instr = *it;
+    warp.partial.erase(it);
+    warp.deferred.push_back(instr);
+    this->retry(core_id, wid);
+    if (warp.deferred.size() > COSIM_LOOKAHEAD) {
+      this->report("the model cannot execute the committed instruction", core_id, wid, &warp.deferred.front(), nullptr);
+    }
+  }
+
+private:
+
+  cosim_warp_t& warp(uint32_t core_id, uint32_t wid) {
+    return warps_.at(core_id * arch_.num_warps() + wid);
+  }
+
+  // match the deferred commits until the model cannot progress
+  void retry(uint32_t core_id, uint32_t wid) {
+    auto& warp = this->warp(core_id, wid);
+    bool progress;
+    do {
+      progress = false;
+      for (auto it = warp.deferred.begin(); it != warp.deferred.end(); ++it) {
+        if (this->match(core_id, wid, *it)) {
+          warp.deferred.erase(it);
+          progress = true;
+          break;
+        }
+      }
+    } while (progress);
+  }
+
+  // check an RTL commit against the oldest model instruction at the same PC,
+  // executing the warp ahead as needed, false if the model cannot progress
+  bool match(uint32_t core_id, uint32_t wid, const cosim_instr_t& rtl) {
+    auto& warp = this->warp(core_id, wid);
+    auto it = warp.pending.begin();
+    while (it != warp.pending.end() && it->PC != rtl.PC) {
+      ++it;
+    }
+    while (it == warp.pending.end()) {
+      if (warp.fenced)
+        return false;
+      if (warp.pending.size() >= COSIM_LOOKAHEAD) {
+        this->report("the RTL committed another instruction", core_id, wid, &rtl, &warp.pending.front());
+      }
+      // do not run ahead past a memory access, it executes when it commits
+      auto next_PC = model_.core(core_id)->warp(wid).getPC();
+      if (next_PC != rtl.PC && is_memory_access(this->fetch(next_PC)))
+        return false;
+      cosim_instr_t instr;
+      if (!this->step(core_id, wid, &instr))
+        return false;
+      warp.fenced = instr.timing;
+      it = warp.pending.insert(warp.pending.end(), instr);
+      if (instr.PC != rtl.PC) {
+        it = warp.pending.end();
+      }
+    }
+
+    auto& ref = *it;
+    if (ref.tmask != rtl.tmask) {
+      this->report("thread mask mismatch", core_id, wid, &rtl, &ref);
+    }
+    if (ref.wb != rtl.wb || (ref.wb && ref.rd != rtl.rd)) {
+      this->report("destination register mismatch", core_id, wid, &rtl, &ref);
+    }
+    if (ref.timing) {
+      // the timing CSR read is the youngest instruction of the model
+      this->adopt(core_id, wid, rtl);
+      warp.fenced = false;
+    } else if (ref.wb) {
+      for (uint32_t t = 0; t < arch_.num_threads(); ++t) {
+        if ((ref.tmask >> t) & 1) {
+          if (Word(ref.data.at(t)) != Word(rtl.data.at(t))) {
+            this->report("register value mismatch", core_id, wid, &rtl, &ref);
+          }
+        }
+      }
+    }
+
+    warp.pending.erase(it);
+    warp.last_PC = rtl.PC;
+    ++warp.committed;
+    return true;
+  }
+
+  bool step(uint32_t core_id, uint32_t wid, cosim_instr_t* instr) {
+    auto core = model_.core(core_id);
+    auto trace = core->step(wid);
+    if (nullptr == trace)
+      return false;
+    auto& warp = core->warp(wid);
+    instr->PC = trace->PC;
+    instr->tmask = trace->tmask.to_ullong();
+    instr->wb = trace->wb;
+    instr->rd = trace->rdest;
+    if (trace->rdest_type == RegType::Float) {
+      instr->rd += COSIM_FREG_BASE;
+    }
+    instr->timing = trace->wb
+                  && trace->rdest_type == RegType::Integer
+                  && is_timing_read(this->fetch(trace->PC));
+    instr->data.assign(arch_.num_threads(), 0);
+    for (uint32_t t = 0; trace->wb && t < arch_.num_threads(); ++t) {
+      if (!trace->tmask.test(t))
+        continue;
+      if (trace->rdest_type == RegType::Float) {
+        instr->data.at(t) = warp.getFRegValue(trace->rdest, t);
+      } else {
+        instr->data.at(t) = warp.getIRegValue(trace->rdest, t);
+      }
+    }
+    delete trace;
+    return true;
+  }
+
+  void adopt(uint32_t core_id, uint32_t wid, const cosim_instr_t& rtl) {
+    if (!rtl.wb)
+      return;
+    auto& warp = model_.core(core_id)->warp(wid);
+    for (uint32_t t = 0; t < arch_.num_threads(); ++t) {
+      if ((rtl.tmask >> t) & 1) {
+        warp.setIRegValue(rtl.rd, t, Word(rtl.data.at(t)));
+      }
+    }
+  }
+
+  uint32_t fetch(uint64_t PC) {
+    uint32_t code = 0;
+    ram_.read(&code, PC, sizeof(uint32_t));
+    return code;
+  }
+
+  static void print_rd(std::ostream& os, const cosim_instr_t& instr) {
+    if (!instr.wb) {
+      os << "-";
+    } else if (instr.rd >= COSIM_FREG_BASE) {
+      os << "f" << (instr.rd - COSIM_FREG_BASE);
+    } else {
+      os << "x" << instr.rd;
+    }
+  }
+
+  static void print_tmask(std::ostream& os, uint64_t tmask, uint32_t num_threads) {
+    for (uint32_t t = num_threads; t-- != 0;) {
+      os << ((tmask >> t) & 1);
+    }
+  }
+
+  void print_instr(std::ostream& os, const char* name, const cosim_instr_t& instr) {
+    auto code = this->fetch(instr.PC);
+    os << "  " << name << ": PC=0x" << std::hex << instr.PC
+       << ", instr=0x" << std::setw(8) << std::setfill('0') << code << std::setfill(' ') << std::dec;
+    auto decoded = decoder_.decode(code);
+    if (decoded) {
+      os << " (" << *decoded << ")";
+    }
+    os << ", tmask=";
+    print_tmask(os, instr.tmask, arch_.num_threads());
+    os << ", rd=";
+    print_rd(os, instr);
+    os << std::endl;
+  }
+
+  void report(const char* what,
+              uint32_t core_id,
+              uint32_t wid,
+              const cosim_instr_t* rtl,
+              const cosim_instr_t* ref) {
+    auto& warp = this->warp(core_id, wid);
+    std::cout << std::dec << "Error: co-simulation mismatch at cycle " << cycle_ << ": " << what << std::endl
+              << "  core=" << core_id << ", wid=" << wid << ", committed=" << warp.committed
+              << ", last PC=0x" << std::hex << warp.last_PC
+              << ", model PC=0x" << model_.core(core_id)->warp(wid).getPC() << std::dec << std::endl;
+    if (rtl) {
+      this->print_instr(std::cout, "rtl ", *rtl);
+    }
+    if (ref) {
+      this->print_instr(std::cout, "simx", *ref);
+    }
+    if (rtl && ref && rtl->wb && ref->wb) {
+      for (uint32_t t = 0; t < arch_.num_threads(); ++t) {
+        bool rtl_active = (rtl->tmask >> t) & 1;
+        bool ref_active = (ref->tmask >> t) & 1;
+        if (!rtl_active && !ref_active)
+          continue;
+        std::cout << "  thread " << t << ": rtl=";
+        if (rtl_active) {
+          std::cout << "0x" << std::hex << Word(rtl->data.at(t)) << std::dec;
+        } else {
+          std::cout << "-";
+        }
+        std::cout << ", simx=";
+        if (ref_active) {
+          std::cout << "0x" << std::hex << Word(ref->data.at(t)) << std::dec;
+        } else {
+          std::cout << "-";
+        }
+        if (!rtl_active || !ref_active || Word(rtl->data.at(t)) != Word(ref->data.at(t))) {
+          std::cout << " <--";
+        }
+        std::cout << std::endl;
+      }
+    }
+    for (auto& pending : warp.pending) {
+      if (&pending != ref) {
+        this->print_instr(std::cout, "simx pending", pending);
+      }
+    }
+    std::cout << std::flush;
+    // keep the waveform up to the mismatch
+    Verilated::runFlushCallbacks();
+    std::abort();
+  }
+
+  Arch          arch_;
+  ProcessorImpl model_;
+  Decoder       decoder_;
+  RAM           ram_;
+  std::vector<cosim_warp_t> warps_;
+  uint64_t      cycle_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+CoSim::CoSim()
+  : impl_(new Impl())
+{}
+
+CoSim::~CoSim() {
+  delete impl_;
+}
+
+void CoSim::write_dcr(uint32_t addr, uint32_t value) {
+  impl_->write_dcr(addr, value);
+}
+
+void CoSim::start(const RAM& ram) {
+  impl_->start(ram);
+}
+
+void CoSim::finish() {
+  impl_->finish();
+}
+
+void CoSim::commit_data(uint32_t core_id, uint32_t wid, uint32_t tid, uint64_t value) {
+  impl_->commit_data(core_id, wid, tid, value);
+}
+
+void CoSim::commit(uint64_t cycle,
+                   uint32_t core_id,
+                   uint32_t wid,
+                   uint64_t PC,
+                   uint64_t tmask,
+                   bool wb,
+                   uint32_t rd,
+                   bool eop) {
+  impl_->commit(cycle, core_id, wid, PC, tmask, wb, rd, eop);
+}
@@ -0,0 +1,59 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+
+namespace vortex {
+
+class RAM;
+
+// Lockstep co-simulation checker (COSIM builds): the SimX functional model
+// executes the instructions of each warp as the RTL commits them and compares
+// the PC, the thread mask and the destination register values. The first
+// divergence is reported with its context and aborts the simulation.
+class CoSim {
+public:
+  CoSim();
+  ~CoSim();
+
+  // mirror of the device configuration writes
+  void write_dcr(uint32_t addr, uint32_t value);
+
+  // copy the device memory and reset the model for a new run
+  void start(const RAM& ram);
+
+  // every instruction the model executed must have been committed
+  void finish();
+
+  // RTL commit stream, see VX_commit.sv: the data of the active threads of a
+  // commit packet followed by the packet itself, 'eop' ends the instruction
+  void commit_data(uint32_t core_id, uint32_t wid, uint32_t tid, uint64_t value);
+
+  void commit(uint64_t cycle,
+              uint32_t core_id,
+              uint32_t wid,
+              uint64_t PC,
+              uint64_t tmask,
+              bool wb,
+              uint32_t rd,
+              bool eop);
+
+private:
+
+  class Impl;
+  Impl* impl_;
+};
+
+}
@@ -23,27 +23,36 @@
 #include "VVortex__Syms.h"
 #endif
 
-#ifdef VCD_OUTPUT
+#if defined(FST_OUTPUT)
+#include <verilated_fst_c.h>
+#define TRACE_OUTPUT
+#define TRACE_FILE_EXT "fst"
+typedef VerilatedFstC VerilatedTraceC;
+#elif defined(VCD_OUTPUT)
 #include <verilated_vcd_c.h>
+#define TRACE_OUTPUT
+#define TRACE_FILE_EXT "vcd"
+typedef VerilatedVcdC VerilatedTraceC;
 #endif
 
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <atomic>
 #include <mem.h>
 
 #include <VX_config.h>
 #include <ostream>
-#include <list>
 #include <queue>
 #include <vector>
 #include <sstream> 
 #include <unordered_map>
+#include <stdlib.h>
+#include <dram_sim.h>
 
-#define RAMULATOR
-#include <ramulator/src/Gem5Wrapper.h>
-#include <ramulator/src/Request.h>
-#include <ramulator/src/Statistics.h>
+#ifdef COSIM
+#include "cosim.h"
+#endif
 
 #ifndef MEMORY_BANKS
   #ifdef PLATFORM_PARAM_LOCAL_MEMORY_BANKS
@@ -65,6 +74,10 @@
 #define TRACE_STOP_TIME -1ull
 #endif
 
+#ifndef TRACE_RING_SEGMENTS
+#define TRACE_RING_SEGMENTS 4
+#endif
+
 #ifndef VERILATOR_RESET_VALUE
 #define VERILATOR_RESET_VALUE 2
 #endif
@@ -82,29 +95,102 @@ typedef uint64_t Word;
 
 using namespace vortex;
 
-static uint64_t timestamp = 0;
+// the simulation time is advanced by the harness thread only, but it is read
+// by the DPI trace functions from the Verilator worker threads
+static std::atomic<uint64_t> timestamp(0);
 
 double sc_time_stamp() { 
-  return timestamp;
+  return timestamp.load(std::memory_order_relaxed);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static bool trace_enabled = false;
-static uint64_t trace_start_time = TRACE_START_TIME;
-static uint64_t trace_stop_time  = TRACE_STOP_TIME;
+// tracing window, opened by the start trigger and closed for good by the 
+// stop trigger: a simulation time, a scheduled PC or the ebreak signal
+struct trace_trigger_t {
+  enum Type { Time, PC, Ebreak };
+  Type     type;
+  uint64_t value;
+};
+
+static trace_trigger_t trace_start = {trace_trigger_t::Time, TRACE_START_TIME};
+static trace_trigger_t trace_stop  = {trace_trigger_t::Time, TRACE_STOP_TIME};
+static std::atomic<bool> trace_window(false);
+static std::atomic<bool> trace_done(false);
+static std::atomic<bool> trace_enabled(false);
+
+static bool trace_match(const trace_trigger_t& trigger, trace_trigger_t::Type type, uint64_t value) {
+  if (trigger.type != type)
+    return false;
+  switch (type) {
+  case trace_trigger_t::Time: return value >= trigger.value;
+  case trace_trigger_t::PC:   return value == trigger.value;
+  default:                    return true;
+  }
+}
+
+static void trace_trigger(trace_trigger_t::Type type, uint64_t value) {
+  if (trace_done.load(std::memory_order_relaxed))
+    return;
+  if (!trace_window.load(std::memory_order_relaxed)) {
+    if (!trace_match(trace_start, type, value))
+      return;
+    trace_window.store(true, std::memory_order_relaxed);
+  }
+  if (trace_match(trace_stop, type, value)) {
+    trace_window.store(false, std::memory_order_relaxed);
+    trace_done.store(true, std::memory_order_relaxed);
+  }
+}
+
+// RTLSIM_TRACE triggers: "<cycle>", "pc:<addr>" or "ebreak", the run ends
+// at ebreak so it can only close the window
+static bool parse_trace_trigger(const std::string& s, bool is_start, trace_trigger_t* trigger) {
+  if (s == "ebreak") {
+    if (is_start)
+      return false;
+    trigger->type = trace_trigger_t::Ebreak;
+    trigger->value = 0;
+  } else if (s.compare(0, 3, "pc:") == 0) {
+    trigger->type = trace_trigger_t::PC;
+    trigger->value = std::strtoull(s.c_str() + 3, nullptr, 0);
+  } else if (!s.empty() && s[0] >= '0' && s[0] <= '9') {
+    trigger->type = trace_trigger_t::Time;
+    trigger->value = std::strtoull(s.c_str(), nullptr, 0) * 2;
+  } else {
+    return false;
+  }
+  return true;
+}
 
 bool sim_trace_enabled() {
-  if (timestamp >= trace_start_time 
-   && timestamp < trace_stop_time)
-    return true;
-  return trace_enabled;
+  return trace_window.load(std::memory_order_relaxed) 
+      || trace_enabled.load(std::memory_order_relaxed);
 }
 
 void sim_trace_enable(bool enable) {
-  trace_enabled = enable;
+  trace_enabled.store(enable, std::memory_order_relaxed);
 }
 
+// called by the warp scheduler of DEBUG builds
+void sim_trace_pc(uint64_t pc) {
+  trace_trigger(trace_trigger_t::PC, pc);
+}
+
+#ifdef COSIM
+static CoSim* cosim_checker = nullptr;
+
+// committed instruction stream of COSIM builds
+void sim_commit(int core_id, int wid, uint64_t PC, uint64_t tmask, bool wb, int rd, bool eop) {
+  auto cycle = timestamp.load(std::memory_order_relaxed) / 2;
+  cosim_checker->commit(cycle, core_id, wid, PC, tmask, wb, rd, eop);
+}
+
+void sim_commit_data(int core_id, int wid, int tid, uint64_t value) {
+  cosim_checker->commit_data(core_id, wid, tid, value);
+}
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class Processor::Impl {
@@ -124,26 +210,42 @@ public:
     device_ = new VVortex();
   #endif
 
-  #ifdef VCD_OUTPUT
+  #ifdef TRACE_OUTPUT
+    // e.g. RTLSIM_TRACE=start=pc:0x80000100,stop=ebreak,ring=10000
+    trace_file_ = "trace";
+    trace_ring_ = 0;
+    trace_ring_index_ = 0;
+    trace_ring_time_ = -1ull;
+    auto trace_s = getenv("RTLSIM_TRACE");
+    if (trace_s && !this->parse_trace_config(trace_s)) {
+      std::cout << "Error: invalid RTLSIM_TRACE: " << trace_s << std::endl
+                << "  options: start=<trigger>, stop=<trigger>, ring=<cycles>, file=<name>" << std::endl
+                << "  triggers: <cycle>, pc:<addr>, ebreak (stop only)" << std::endl;
+      std::abort();
+    }
     Verilated::traceEverOn(true);
-    trace_ = new VerilatedVcdC();
+    trace_ = new VerilatedTraceC();
     device_->trace(trace_, 99);
-    trace_->open("trace.vcd");
+    trace_->open(this->trace_filename().c_str());
+    // a failed assertion or $fatal stops the model in vl_fatal(), which runs
+    // the flush callbacks before aborting
+    Verilated::addFlushCb(Impl::trace_flush, this);
   #endif
 
     ram_ = nullptr;
     
-    // initialize dram simulator
-    ramulator::Config ram_config;
-    ram_config.add("standard", "DDR4");
-    ram_config.add("channels", std::to_string(MEMORY_BANKS));
-    ram_config.add("ranks", "1");
-    ram_config.add("speed", "DDR4_2400R");
-    ram_config.add("org", "DDR4_4Gb_x8");
-    ram_config.add("mapping", "defaultmapping");
-    ram_config.set_core_num(1);
-    dram_ = new ramulator::Gem5Wrapper(ram_config, MEM_BLOCK_SIZE);
-    Stats::statlist.output("ramulator.ddr4.log");
+    // initialize dram simulator (e.g. VORTEX_DRAM=standard=HBM,channels=8)
+    DramSim::Config dram_config;
+    dram_config.channels = MEMORY_BANKS;
+    auto dram_s = getenv("VORTEX_DRAM");
+    if (dram_s && !DramSim::Config::parse(dram_s, &dram_config)) {
+      std::abort();
+    }
+    dram_ = new DramSim(dram_config, MEM_BLOCK_SIZE, 1);
+
+  #ifdef COSIM
+    cosim_checker = new CoSim();
+  #endif
 
     // reset the device
     this->reset();
@@ -155,18 +257,20 @@ public:
   ~Impl() {
     this->cout_flush();
 
-  #ifdef VCD_OUTPUT
+  #ifdef TRACE_OUTPUT
+    Verilated::removeFlushCb(Impl::trace_flush, this);
     trace_->close();
     delete trace_;
   #endif
     
     delete device_;
     
-    if (dram_) {
-      dram_->finish();
-      Stats::statlist.printall();
-      delete dram_;
-    }
+    delete dram_;
+
+  #ifdef COSIM
+    delete cosim_checker;
+    cosim_checker = nullptr;
+  #endif
   }
 
   void cout_flush() {
@@ -186,7 +290,11 @@ public:
     int exitcode = 0;
 
   #ifndef NDEBUG
-    std::cout << std::dec << timestamp << ": [sim] run()" << std::endl;
+    std::cout << std::dec << timestamp.load() << ": [sim] run()" << std::endl;
+  #endif
+
+  #ifdef COSIM
+    cosim_checker->start(*ram_);
   #endif
 
     // start execution
@@ -202,10 +310,20 @@ public:
     while (device_->busy) {
       if (get_ebreak()) {
         exitcode = (int)get_last_wb_value(3);
+      #ifdef TRACE_OUTPUT
+        trace_trigger(trace_trigger_t::Ebreak, 0);
+        trace_->flush();
+      #endif
         break;  
       }
       this->tick();
     }
+
+  #ifdef COSIM
+    if (!get_ebreak()) {
+      cosim_checker->finish();
+    }
+  #endif
     
     // reset device
     this->reset();
@@ -216,6 +334,9 @@ public:
   }
 
   void write_dcr(uint32_t addr, uint32_t value) {
+  #ifdef COSIM
+    cosim_checker->write_dcr(addr, value);
+  #endif
     device_->dcr_wr_valid = 1;
     device_->dcr_wr_addr  = addr;
     device_->dcr_wr_data  = value;
@@ -254,6 +375,10 @@ private:
     }
   }
 
+  // Both clock edges are evaluated and the DRAM model is ticked every cycle,
+  // also when the device is idle: the bus inputs driven after the rising edge
+  // settle on the falling edge, and ramulator keeps draining posted writes and
+  // refreshing without any callback to tell when it is quiescent.
   void tick() {
 
     device_->clk = 0;
@@ -277,7 +402,7 @@ private:
     this->eval_dcr_bus(1);
 
     if (MEM_CYCLE_RATIO > 0) { 
-      auto cycle = timestamp / 2;
+      auto cycle = timestamp.load(std::memory_order_relaxed) / 2;
       if ((cycle % MEM_CYCLE_RATIO) == 0)
         dram_->tick();
     } else {
@@ -286,7 +411,8 @@ private:
     }
 
     if (!dram_queue_.empty()) {
-      if (dram_->send(dram_queue_.front()))
+      auto& dram_req = dram_queue_.front();
+      if (dram_->send(dram_req.addr, dram_req.write, 0, dram_req.callback))
         dram_queue_.pop();
     }
 
@@ -297,16 +423,70 @@ private:
 
   void eval() {
     device_->eval();
-  #ifdef VCD_OUTPUT
+  #ifdef TRACE_OUTPUT
+    auto time = timestamp.load(std::memory_order_relaxed);
+    trace_trigger(trace_trigger_t::Time, time);
     if (sim_trace_enabled()) {
-      trace_->dump(timestamp);
-    } else {
-      exit(-1);
+      if (trace_ring_ != 0) {
+        // rotate over TRACE_RING_SEGMENTS+1 files of 'ring'/TRACE_RING_SEGMENTS
+        // cycles, counted from the window start, together they hold the last
+        // 'ring' to 'ring'+'ring'/TRACE_RING_SEGMENTS cycles
+        if (trace_ring_time_ == -1ull) {
+          trace_ring_time_ = time;
+        } else if ((time - trace_ring_time_) >= trace_ring_) {
+          trace_->close();
+          trace_ring_index_ = (trace_ring_index_ + 1) % (TRACE_RING_SEGMENTS + 1);
+          trace_->open(this->trace_filename().c_str());
+          trace_ring_time_ = time;
+        }
+      }
+      trace_->dump(time);
     }
   #endif
-    ++timestamp;
+    timestamp.fetch_add(1, std::memory_order_relaxed);
   }
 
+#ifdef TRACE_OUTPUT
+
+  bool parse_trace_config(const std::string& config) {
+    std::stringstream ss(config);
+    std::string option;
+    while (std::getline(ss, option, ',')) {
+      auto pos = option.find('=');
+      if (pos == std::string::npos)
+        return false;
+      auto key = option.substr(0, pos);
+      auto value = option.substr(pos + 1);
+      if (key == "start") {
+        if (!parse_trace_trigger(value, true, &trace_start))
+          return false;
+      } else if (key == "stop") {
+        if (!parse_trace_trigger(value, false, &trace_stop))
+          return false;
+      } else if (key == "ring") {
+        auto cycles = std::strtoull(value.c_str(), nullptr, 0);
+        trace_ring_ = ((cycles + TRACE_RING_SEGMENTS - 1) / TRACE_RING_SEGMENTS) * 2;
+      } else if (key == "file") {
+        trace_file_ = value;
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static void trace_flush(void* arg) {
+    reinterpret_cast<Impl*>(arg)->trace_->flush();
+  }
+
+  std::string trace_filename() const {
+    if (trace_ring_ != 0)
+      return trace_file_ + "." + std::to_string(trace_ring_index_) + "." TRACE_FILE_EXT;
+    return trace_file_ + "." TRACE_FILE_EXT;
+  }
+
+#endif
+
 #ifdef AXI_BUS
 
   void reset_axi_bus() {    
@@ -338,10 +518,9 @@ private:
     }    
     if (!mem_rd_rsp_active_) {      
       if (!pending_mem_reqs_.empty()
-       && (*pending_mem_reqs_.begin())->ready 
-       && !(*pending_mem_reqs_.begin())->write) {      
-        auto mem_rsp_it = pending_mem_reqs_.begin();
-        auto mem_rsp = *mem_rsp_it;
+       && pending_mem_reqs_.front().ready 
+       && !pending_mem_reqs_.front().write) {      
+        auto mem_rsp = &pending_mem_reqs_.front();
         /*
           printf("%0ld: [sim] MEM Rd Rsp: bank=%d, addr=%0lx, data=", timestamp, last_mem_rsp_bank_, mem_rsp->addr);
           for (int i = 0; i < MEM_BLOCK_SIZE; i++) {
@@ -354,9 +533,8 @@ private:
         device_->m_axi_rresp[0]  = 0;
         device_->m_axi_rlast[0]  = 1;
         memcpy(device_->m_axi_rdata[0].data(), mem_rsp->block.data(), MEM_BLOCK_SIZE);
-        pending_mem_reqs_.erase(mem_rsp_it);
+        pending_mem_reqs_.pop();
         mem_rd_rsp_active_ = true;
-        delete mem_rsp;
       } else {
         device_->m_axi_rvalid[0] = 0;
       }
@@ -369,19 +547,17 @@ private:
     }
     if (!mem_wr_rsp_active_) {
       if (!pending_mem_reqs_.empty()
-       && (*pending_mem_reqs_.begin())->ready 
-       && (*pending_mem_reqs_.begin())->write) {
-        auto mem_rsp_it = pending_mem_reqs_.begin();
-        auto mem_rsp = *mem_rsp_it;
+       && pending_mem_reqs_.front().ready 
+       && pending_mem_reqs_.front().write) {
+        auto mem_rsp = &pending_mem_reqs_.front();
         /*
           printf("%0ld: [sim] MEM Wr Rsp: bank=%d, addr=%0lx\n", timestamp, last_mem_rsp_bank_, mem_rsp->addr);        
         */
         device_->m_axi_bvalid[0] = 1;      
         device_->m_axi_bid[0]    = mem_rsp->tag;
         device_->m_axi_bresp[0]  = 0;
-        pending_mem_reqs_.erase(mem_rsp_it);        
+        pending_mem_reqs_.pop();
         mem_wr_rsp_active_ = true;
-        delete mem_rsp;
       } else {
         device_->m_axi_bvalid[0] = 0;
       }      
@@ -419,47 +595,34 @@ private:
             }
             printf("\n");
           */
-          for (int i = 0; i < MEM_BLOCK_SIZE; i++) {
-            if ((byteen >> i) & 0x1) {            
-              (*ram_)[base_addr + i] = data[i];
-            }
-          }  
+          this->ram_write(base_addr, data, byteen);
 
-          auto mem_req = new mem_req_t();
-          mem_req->tag   = device_->m_axi_awid[0];
-          mem_req->addr  = device_->m_axi_awaddr[0];        
-          mem_req->write = true;
-          mem_req->ready = true;
-          pending_mem_reqs_.emplace_back(mem_req);
+          auto& mem_req = pending_mem_reqs_.push();
+          mem_req.tag   = device_->m_axi_awid[0];
+          mem_req.addr  = device_->m_axi_awaddr[0];        
+          mem_req.write = true;
+          mem_req.ready = true;
 
           // send dram request
-          ramulator::Request dram_req( 
-            device_->m_axi_awaddr[0],
-            ramulator::Request::Type::WRITE,
-            0
-          );
-          dram_queue_.push(dram_req);
+          dram_queue_.push({device_->m_axi_awaddr[0], true, nullptr});
         }        
       } else {
         // process reads
-        auto mem_req = new mem_req_t();
-        mem_req->tag  = device_->m_axi_arid[0];
-        mem_req->addr = device_->m_axi_araddr[0];
-        ram_->read(mem_req->block.data(), device_->m_axi_araddr[0], MEM_BLOCK_SIZE);
-        mem_req->write = false;
-        mem_req->ready = false;
-        pending_mem_reqs_.emplace_back(mem_req);
+        auto id = pending_mem_reqs_.next_id();
+        auto& mem_req = pending_mem_reqs_.push();
+        mem_req.tag  = device_->m_axi_arid[0];
+        mem_req.addr = device_->m_axi_araddr[0];
+        ram_->read(mem_req.block.data(), device_->m_axi_araddr[0], MEM_BLOCK_SIZE);
+        mem_req.write = false;
+        mem_req.ready = false;
 
         // send dram request
-        ramulator::Request dram_req( 
-          device_->m_axi_araddr[0],
-          ramulator::Request::Type::READ,
-          std::bind([&](ramulator::Request& dram_req, mem_req_t* mem_req) {
-              mem_req->ready = true;
-            }, placeholders::_1, mem_req),
-          0
-        );
-        dram_queue_.push(dram_req);
+        dram_queue_.push({device_->m_axi_araddr[0], false, [this, id]() {
+          auto mem_req = pending_mem_reqs_.find(id);
+          if (mem_req) {
+            mem_req->ready = true;
+          }
+        }});
       } 
     } 
 
@@ -493,10 +656,9 @@ private:
     }
     if (!mem_rd_rsp_active_) {
       if (!pending_mem_reqs_.empty()
-       && (*pending_mem_reqs_.begin())->ready) {
+       && pending_mem_reqs_.front().ready) {
         device_->mem_rsp_valid = 1;      
-        auto mem_rsp_it = pending_mem_reqs_.begin();
-        auto mem_rsp = *mem_rsp_it;
+        auto mem_rsp = &pending_mem_reqs_.front();
         /*
           printf("%0ld: [sim] MEM Rd: bank=%d, tag=%0lx, addr=%0lx, data=", timestamp, last_mem_rsp_bank_, mem_rsp->tag, mem_rsp->addr);
           for (int i = 0; i < MEM_BLOCK_SIZE; i++) {
@@ -506,9 +668,8 @@ private:
         */
         memcpy(device_->mem_rsp_data.data(), mem_rsp->block.data(), MEM_BLOCK_SIZE);
         device_->mem_rsp_tag = mem_rsp->tag;   
-        pending_mem_reqs_.erase(mem_rsp_it);
+        pending_mem_reqs_.pop();
         mem_rd_rsp_active_ = true;
-        delete mem_rsp;
       } else {
         device_->mem_rsp_valid = 0;
       }
@@ -544,42 +705,30 @@ private:
             }
             printf("\n");
           */
-          for (int i = 0; i < MEM_BLOCK_SIZE; i++) {
-            if ((byteen >> i) & 0x1) {            
-              (*ram_)[byte_addr + i] = data[i];
-            }
-          }
+          this->ram_write(byte_addr, data, byteen);
 
           // send dram request
-          ramulator::Request dram_req( 
-            byte_addr,
-            ramulator::Request::Type::WRITE,
-            0
-          );
-          dram_queue_.push(dram_req);
+          dram_queue_.push({byte_addr, true, nullptr});
         }         
       } else {
         // process reads
-        auto mem_req = new mem_req_t();
-        mem_req->tag   = device_->mem_req_tag;   
-        mem_req->addr  = byte_addr;
-        mem_req->write = false;
-        mem_req->ready = false;
-        ram_->read(mem_req->block.data(), byte_addr, MEM_BLOCK_SIZE);
-        pending_mem_reqs_.emplace_back(mem_req);
+        auto id = pending_mem_reqs_.next_id();
+        auto& mem_req = pending_mem_reqs_.push();
+        mem_req.tag   = device_->mem_req_tag;   
+        mem_req.addr  = byte_addr;
+        mem_req.write = false;
+        mem_req.ready = false;
+        ram_->read(mem_req.block.data(), byte_addr, MEM_BLOCK_SIZE);
 
         //printf("%0ld: [sim] MEM Rd Req: addr=%0x, tag=%0lx\n", timestamp, byte_addr, device_->mem_req_tag);
 
         // send dram request
-        ramulator::Request dram_req( 
-          byte_addr,
-          ramulator::Request::Type::READ,
-          std::bind([&](ramulator::Request& dram_req, mem_req_t* mem_req) {
-              mem_req->ready = true;
-            }, placeholders::_1, mem_req),
-          0
-        );
-        dram_queue_.push(dram_req);
+        dram_queue_.push({byte_addr, false, [this, id]() {
+          auto mem_req = pending_mem_reqs_.find(id);
+          if (mem_req) {
+            mem_req->ready = true;
+          }
+        }});
       }
     }   
 
@@ -601,6 +750,23 @@ private:
     }
   }
 
+  // writes the enabled bytes of a memory block, one copy per contiguous run
+  void ram_write(uint64_t addr, const uint8_t* data, uint64_t byteen) {
+    int i = 0;
+    while (i < MEM_BLOCK_SIZE) {
+      if (0 == ((byteen >> i) & 0x1)) {
+        ++i;
+        continue;
+      }
+      int j = i + 1;
+      while (j < MEM_BLOCK_SIZE && ((byteen >> j) & 0x1)) {
+        ++j;
+      }
+      ram_->write(data + i, addr + i, j - i);
+      i = j;
+    }
+  }
+
   void wait(uint32_t cycles) {
     for (int i = 0; i < cycles; ++i) {
       this->tick();
@@ -633,18 +799,71 @@ private:
     bool write;
   } mem_req_t;
 
+  // in-order pending memory requests: a power-of-two ring of reusable slots 
+  // indexed by a sequence id, ids from before a reset are no longer found
+  class MemReqRing {
+  public:
+    MemReqRing() : slots_(64), head_(0), tail_(0) {}
+
+    bool empty() const {
+      return head_ == tail_;
+    }
+
+    mem_req_t& front() {
+      return slots_[head_ & (slots_.size() - 1)];
+    }
+
+    void pop() {
+      ++head_;
+    }
+
+    uint64_t next_id() const {
+      return tail_;
+    }
+
+    mem_req_t& push() {
+      if ((tail_ - head_) == slots_.size()) {
+        std::vector<mem_req_t> slots(2 * slots_.size());
+        for (auto id = head_; id != tail_; ++id) {
+          slots[id & (slots.size() - 1)] = slots_[id & (slots_.size() - 1)];
+        }
+        slots_.swap(slots);
+      }
+      return slots_[tail_++ & (slots_.size() - 1)];
+    }
+
+    mem_req_t* find(uint64_t id) {
+      if (id < head_ || id >= tail_)
+        return nullptr;
+      return &slots_[id & (slots_.size() - 1)];
+    }
+
+    void clear() {
+      head_ = tail_;
+    }
+
+  private:
+    std::vector<mem_req_t> slots_;
+    uint64_t head_;
+    uint64_t tail_;
+  };
+
 #ifdef AXI_BUS
   VVortex_axi *device_;
 #else
   VVortex *device_;
 #endif
-#ifdef VCD_OUTPUT
-  VerilatedVcdC *trace_;
+#ifdef TRACE_OUTPUT
+  VerilatedTraceC *trace_;
+  std::string trace_file_;
+  uint64_t trace_ring_;
+  uint64_t trace_ring_time_;
+  uint32_t trace_ring_index_;
 #endif
 
   std::unordered_map<int, std::stringstream> print_bufs_;
 
-  std::list<mem_req_t*> pending_mem_reqs_;
+  MemReqRing pending_mem_reqs_;
 
   bool mem_rd_rsp_active_;
   bool mem_rd_rsp_ready_;
@@ -654,9 +873,15 @@ private:
 
   RAM *ram_;
 
-  ramulator::Gem5Wrapper* dram_;
+  struct dram_req_t {
+    uint64_t addr;
+    bool write;
+    DramSim::ResponseCallback callback;
+  };
+
+  DramSim* dram_;
 
-  std::queue<ramulator::Request> dram_queue_;
+  std::queue<dram_req_t> dram_queue_;
 
   bool running_;
 };
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <serialize.h>
 #include "cache_sim.h"
 
 namespace vortex {
@@ -91,6 +92,60 @@ public:
     
     void tick() {}
 
+    bool idle() const {
+        return true;
+    }
+
+    bool warmup(uint32_t unit, uint64_t addr, bool write) {
+        // same unit-to-cache mapping as the memory arbiters
+        uint32_t index = unit >> log2ceil(CoreReqPorts.size() / caches_.size());
+        return caches_.at(index)->warmup(addr, write);
+    }
+
+    // flush the cache serving the given unit
+    void flush(uint32_t unit) {
+        uint32_t index = unit >> log2ceil(CoreReqPorts.size() / caches_.size());
+        caches_.at(index)->flush();
+    }
+
+    bool flushing(uint32_t unit) const {
+        uint32_t index = unit >> log2ceil(CoreReqPorts.size() / caches_.size());
+        return caches_.at(index)->flushing();
+    }
+
+    void flush() {
+        for (auto cache : caches_) {
+            cache->flush();
+        }
+    }
+
+    bool flushing() const {
+        for (auto cache : caches_) {
+            if (cache->flushing())
+                return true;
+        }
+        return false;
+    }
+
+    void save(std::ostream& os) const {
+        write_pod(os, uint32_t(caches_.size()));
+        for (auto cache : caches_) {
+            cache->save(os);
+        }
+    }
+
+    bool load(std::istream& is) {
+        uint32_t num_caches = 0;
+        read_pod(is, &num_caches);
+        if (num_caches != caches_.size())
+            return false;
+        for (auto cache : caches_) {
+            if (!cache->load(is))
+                return false;
+        }
+        return true;
+    }
+
     CacheSim::PerfStats perf_stats() const {
         CacheSim::PerfStats perf;
         for (auto cache : caches_) {
@@ -0,0 +1,228 @@
+// Copyright © 2019-2023
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <queue>
+#include <functional>
+#include <unordered_map>
+#include <assert.h>
+
+namespace vortex {
+
+struct bank_req_port_t {
+    uint32_t req_id;
+    uint64_t req_tag;
+    bool     valid;
+
+    void clear() {
+        valid = false;
+    }
+};
+
+struct bank_req_t {
+
+    enum ReqType {
+        None   = 0,
+        Fill   = 1,
+        Replay = 2,
+        Core   = 3
+    };
+
+    std::vector<bank_req_port_t> ports;
+    uint64_t tag;
+    uint32_t set_id;
+    uint32_t cid;
+    uint64_t uuid;
+    ReqType  type;
+    bool     write;
+    bool     prefetch;
+
+    bank_req_t(uint32_t num_ports)
+        : ports(num_ports)
+        , prefetch(false)
+    {}
+
+    void clear() {
+        for (auto& port : ports) {
+            port.clear();
+        }
+        type = ReqType::None;
+    }
+};
+
+struct mshr_entry_t {
+    bank_req_t bank_req;
+    uint32_t   line_id;
+    int32_t    prev;    // previous entry of the same line
+    int32_t    next;    // next entry of the same line
+
+    mshr_entry_t(uint32_t num_ports)
+        : bank_req(num_ports)
+        , prev(-1)
+        , next(-1)
+    {}
+
+    void clear() {
+        bank_req.clear();
+        prev = -1;
+        next = -1;
+    }
+};
+
+// Miss status holding registers of a cache bank.
+// Pending entries are indexed by set/tag and linked per line in allocation
+// order. Entries are allocated and replayed lowest index first, which
+// matches a linear scan of the entries.
+class MSHR {
+private:
+    struct line_key_t {
+        uint64_t tag;
+        uint32_t set_id;
+
+        bool operator==(const line_key_t& other) const {
+            return tag == other.tag && set_id == other.set_id;
+        }
+    };
+
+    struct line_key_hash_t {
+        size_t operator()(const line_key_t& key) const {
+            return std::hash<uint64_t>()(key.tag * 0x9e3779b97f4a7c15ull + key.set_id);
+        }
+    };
+
+    struct line_chain_t {
+        int32_t head;
+        int32_t tail;
+    };
+
+    typedef std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> index_queue_t;
+
+    std::vector<mshr_entry_t> entries_;
+    std::unordered_map<line_key_t, line_chain_t, line_key_hash_t> lines_;
+    index_queue_t free_entries_;
+    index_queue_t replay_entries_;
+    uint32_t size_;
+
+public:
+    MSHR(uint32_t size, uint32_t num_ports)
+        : entries_(size, num_ports)
+        , size_(0) {
+        lines_.reserve(size);
+        this->clear();
+    }
+
+    bool empty() const {
+        return (0 == size_);
+    }
+
+    bool full() const {
+        return (size_ == entries_.size());
+    }
+
+    // returns the oldest pending entry of the request's line, an in-flight
+    // prefetch is always the oldest entry of its line
+    mshr_entry_t* lookup(const bank_req_t& bank_req) {
+        auto it = lines_.find({bank_req.tag, bank_req.set_id});
+        if (it == lines_.end())
+            return nullptr;
+        return &entries_.at(it->second.head);
+    }
+
+    int allocate(const bank_req_t& bank_req, uint32_t line_id) {
+        if (free_entries_.empty())
+            return -1;
+        int32_t id = free_entries_.top();
+        free_entries_.pop();
+        auto& entry = entries_.at(id);
+        entry.bank_req = bank_req;
+        entry.line_id = line_id;
+        entry.next = -1;
+        // append to the line chain
+        auto it = lines_.find({bank_req.tag, bank_req.set_id});
+        if (it == lines_.end()) {
+            entry.prev = -1;
+            lines_.emplace(line_key_t{bank_req.tag, bank_req.set_id}, line_chain_t{id, id});
+        } else {
+            entry.prev = it->second.tail;
+            entries_.at(it->second.tail).next = id;
+            it->second.tail = id;
+        }
+        ++size_;
+        return id;
+    }
+
+    mshr_entry_t& replay(uint32_t id) {
+        auto& root_entry = entries_.at(id);
+        assert(root_entry.bank_req.type == bank_req_t::Core);
+        // mark all related mshr entries for replay
+        auto& chain = lines_.at({root_entry.bank_req.tag, root_entry.bank_req.set_id});
+        for (int32_t i = chain.head; i != -1; i = entries_.at(i).next) {
+            auto& entry = entries_.at(i);
+            if (entry.bank_req.type == bank_req_t::Core) {
+                entry.bank_req.type = bank_req_t::Replay;
+                replay_entries_.push(i);
+            }
+        }
+        return root_entry;
+    }
+
+    bool pop(bank_req_t* out) {
+        if (replay_entries_.empty())
+            return false;
+        int32_t id = replay_entries_.top();
+        replay_entries_.pop();
+        auto& entry = entries_.at(id);
+        assert(entry.bank_req.type == bank_req_t::Replay);
+        *out = entry.bank_req;
+        entry.bank_req.type = bank_req_t::None;
+        // unlink from the line chain
+        auto it = lines_.find({entry.bank_req.tag, entry.bank_req.set_id});
+        if (entry.prev != -1) {
+            entries_.at(entry.prev).next = entry.next;
+        } else {
+            it->second.head = entry.next;
+        }
+        if (entry.next != -1) {
+            entries_.at(entry.next).prev = entry.prev;
+        } else {
+            it->second.tail = entry.prev;
+        }
+        if (it->second.head == -1) {
+            lines_.erase(it);
+        }
+        entry.prev = -1;
+        entry.next = -1;
+        free_entries_.push(id);
+        --size_;
+        return true;
+    }
+
+    void clear() {
+        for (auto& entry : entries_) {
+            entry.clear();
+        }
+        lines_.clear();
+        free_entries_ = index_queue_t();
+        replay_entries_ = index_queue_t();
+        for (uint32_t i = 0, n = entries_.size(); i < n; ++i) {
+            free_entries_.push(i);
+        }
+        size_ = 0;
+    }
+};
+
+}
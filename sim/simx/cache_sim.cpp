@@ -12,16 +12,23 @@
 // limitations under the License.
 
 #include "cache_sim.h"
+#include "cache_mshr.h"
 #include "debug.h"
 #include "types.h"
 #include <util.h>
+#include <serialize.h>
 #include <unordered_map>
 #include <vector>
 #include <list>
 #include <queue>
+#include <deque>
+#include <algorithm>
 
 using namespace vortex;
 
+// pending prefetch line addresses per cache
+#define PREFETCH_QUEUE_SIZE 16
+
 struct params_t {
     uint32_t sets_per_bank;
     uint32_t lines_per_set;    
@@ -109,156 +116,493 @@ struct params_t {
 
 struct line_t {  
     uint64_t tag;
-    uint32_t lru_ctr;
     bool     valid;
     bool     dirty;
+    bool     prefetched; // filled by a prefetch and not referenced yet
 
     void clear() {
         valid = false;
         dirty = false;
+        prefetched = false;
     }
 };
 
-struct set_t {
-    std::vector<line_t> lines;
+///////////////////////////////////////////////////////////////////////////////
 
-    set_t(uint32_t num_ways) 
-        : lines(num_ways) 
+// Replacement state for all the sets of a cache, sets are indexed
+// globally across banks. Invalid lines are always filled first, the
+// policy only picks victims among valid lines.
+class ReplPolicy {
+public:
+    typedef CacheSim::ReplType Type;
+
+    ReplPolicy(uint32_t num_sets, uint32_t num_ways)
+        : num_sets_(num_sets)
+        , num_ways_(num_ways)
     {}
 
-    void clear() {
-        for (auto& line : lines) {
-            line.clear();
+    virtual ~ReplPolicy() {}
+
+    virtual void reset() = 0;
+
+    // a demand request hit the line
+    virtual void touch(uint32_t set_id, uint32_t way) = 0;
+
+    // a demand request missed in the set
+    virtual void miss(uint32_t /*set_id*/) {}
+
+    // the line was filled
+    virtual void insert(uint32_t set_id, uint32_t way) = 0;
+
+    virtual uint32_t victim(uint32_t set_id) = 0;
+
+    virtual void save(std::ostream& os) const = 0;
+
+    virtual void load(std::istream& is) = 0;
+
+    static ReplPolicy* Create(Type type, uint32_t num_sets, uint32_t num_ways);
+
+protected:
+    uint32_t num_sets_;
+    uint32_t num_ways_;
+};
+
+// true LRU as a per-set recency stack, most recent way first
+class LruPolicy : public ReplPolicy {
+public:
+    LruPolicy(uint32_t num_sets, uint32_t num_ways)
+        : ReplPolicy(num_sets, num_ways)
+        , stacks_(num_sets * num_ways) {
+        assert(num_ways <= 256);
+        this->reset();
+    }
+
+    void reset() override {
+        for (uint32_t s = 0; s < num_sets_; ++s) {
+            for (uint32_t w = 0; w < num_ways_; ++w) {
+                stacks_[s * num_ways_ + w] = w;
+            }
         }
     }
-};
 
-struct bank_req_port_t {
-    uint32_t req_id;
-    uint64_t req_tag;
-    bool     valid;
+    void touch(uint32_t set_id, uint32_t way) override {
+        auto stack = &stacks_[set_id * num_ways_];
+        uint32_t pos = 0;
+        while (stack[pos] != way) {
+            ++pos;
+        }
+        for (; pos != 0; --pos) {
+            stack[pos] = stack[pos - 1];
+        }
+        stack[0] = way;
+    }
 
-    void clear() {
-        valid = false;   
+    void insert(uint32_t set_id, uint32_t way) override {
+        this->touch(set_id, way);
+    }
+
+    uint32_t victim(uint32_t set_id) override {
+        return stacks_[set_id * num_ways_ + num_ways_ - 1];
     }
+
+    void save(std::ostream& os) const override {
+        write_vector(os, stacks_);
+    }
+
+    void load(std::istream& is) override {
+        read_vector(is, &stacks_);
+    }
+
+private:
+    std::vector<uint8_t> stacks_;
 };
 
-struct bank_req_t {
+// binary tree pseudo-LRU, each node points toward the next victim
+class PlruPolicy : public ReplPolicy {
+public:
+    PlruPolicy(uint32_t num_sets, uint32_t num_ways)
+        : ReplPolicy(num_sets, num_ways)
+        , levels_(log2ceil(num_ways))
+        , trees_(num_sets) {
+        assert(ispow2(num_ways) && num_ways <= 64);
+    }
 
-    enum ReqType {
-        None   = 0,
-        Fill   = 1,
-        Replay = 2,        
-        Core   = 3
-    };
+    void reset() override {
+        std::fill(trees_.begin(), trees_.end(), 0);
+    }
 
-    std::vector<bank_req_port_t> ports;
-    uint64_t tag;
-    uint32_t set_id;
-    uint32_t cid;
-    uint64_t uuid;
-    ReqType  type;
-    bool     write;
-
-    bank_req_t(uint32_t num_ports)
-        : ports(num_ports) 
-    {}
+    void touch(uint32_t set_id, uint32_t way) override {
+        auto& tree = trees_[set_id];
+        uint32_t node = 0;
+        for (uint32_t l = 0; l < levels_; ++l) {
+            uint32_t dir = (way >> (levels_ - 1 - l)) & 0x1;
+            // point away from the accessed way
+            if (dir) {
+                tree &= ~(1ull << node);
+            } else {
+                tree |= (1ull << node);
+            }
+            node = 2 * node + 1 + dir;
+        }
+    }
 
-    void clear() {
-        for (auto& port : ports) {
-            port.clear();
+    void insert(uint32_t set_id, uint32_t way) override {
+        this->touch(set_id, way);
+    }
+
+    uint32_t victim(uint32_t set_id) override {
+        auto tree = trees_[set_id];
+        uint32_t node = 0;
+        uint32_t way = 0;
+        for (uint32_t l = 0; l < levels_; ++l) {
+            uint32_t dir = (tree >> node) & 0x1;
+            way = (way << 1) | dir;
+            node = 2 * node + 1 + dir;
         }
-        type = ReqType::None;
+        return way;
     }
+
+    void save(std::ostream& os) const override {
+        write_vector(os, trees_);
+    }
+
+    void load(std::istream& is) override {
+        read_vector(is, &trees_);
+    }
+
+private:
+    uint32_t levels_;
+    std::vector<uint64_t> trees_;
 };
 
-struct mshr_entry_t {
-    bank_req_t bank_req;
-    uint32_t   line_id;
+// deterministic xorshift victim selection
+class RandomPolicy : public ReplPolicy {
+public:
+    RandomPolicy(uint32_t num_sets, uint32_t num_ways)
+        : ReplPolicy(num_sets, num_ways) {
+        this->reset();
+    }
 
-    mshr_entry_t(uint32_t num_ports) 
-        : bank_req(num_ports) 
-    {}
+    void reset() override {
+        state_ = 0x2545f491;
+    }
 
-    void clear() {
-        bank_req.clear();
+    void touch(uint32_t, uint32_t) override {}
+
+    void insert(uint32_t, uint32_t) override {}
+
+    uint32_t victim(uint32_t) override {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return state_ % num_ways_;
+    }
+
+    void save(std::ostream& os) const override {
+        write_pod(os, state_);
+    }
+
+    void load(std::istream& is) override {
+        read_pod(is, &state_);
     }
-};
 
-class MSHR {
 private:
-    std::vector<mshr_entry_t> entries_;
-    uint32_t size_;
+    uint32_t state_;
+};
 
-public:    
-    MSHR(uint32_t size, uint32_t num_ports)
-        : entries_(size, num_ports)
-        , size_(0) 
-    {}
+// 2-bit re-reference interval prediction, BRRIP inserts at the distant
+// interval except for one in every BRRIP_EPSILON insertions
+class RripPolicy : public ReplPolicy {
+public:
+    enum {
+        RRPV_MAX = 3,
+        BRRIP_EPSILON = 32
+    };
 
-    bool empty() const {
-        return (0 == size_);
+    RripPolicy(uint32_t num_sets, uint32_t num_ways, bool bimodal)
+        : ReplPolicy(num_sets, num_ways)
+        , bimodal_(bimodal)
+        , rrpvs_(num_sets * num_ways) {
+        this->reset();
     }
-    
-    bool full() const {
-        return (size_ == entries_.size());
+
+    void reset() override {
+        std::fill(rrpvs_.begin(), rrpvs_.end(), RRPV_MAX);
+        insertions_ = 0;
     }
 
-    bool lookup(const bank_req_t& bank_req) {
-         for (auto& entry : entries_) {;
-            if (entry.bank_req.type != bank_req_t::None
-             && entry.bank_req.set_id == bank_req.set_id 
-             && entry.bank_req.tag == bank_req.tag) {
-                return true;
+    void touch(uint32_t set_id, uint32_t way) override {
+        rrpvs_[set_id * num_ways_ + way] = 0;
+    }
+
+    void insert(uint32_t set_id, uint32_t way) override {
+        uint8_t rrpv = RRPV_MAX - 1;
+        if (bimodal_ && (++insertions_ % BRRIP_EPSILON) != 0) {
+            rrpv = RRPV_MAX;
+        }
+        rrpvs_[set_id * num_ways_ + way] = rrpv;
+    }
+
+    uint32_t victim(uint32_t set_id) override {
+        auto rrpvs = &rrpvs_[set_id * num_ways_];
+        for (;;) {
+            for (uint32_t w = 0; w < num_ways_; ++w) {
+                if (rrpvs[w] == RRPV_MAX)
+                    return w;
+            }
+            for (uint32_t w = 0; w < num_ways_; ++w) {
+                ++rrpvs[w];
             }
         }
-        return false;
     }
 
-    int allocate(const bank_req_t& bank_req, uint32_t line_id) {
-        for (uint32_t i = 0, n = entries_.size(); i < n; ++i) {
-            auto& entry = entries_.at(i);
-            if (entry.bank_req.type == bank_req_t::None) {
-                entry.bank_req = bank_req;
-                entry.line_id = line_id;  
-                ++size_;              
-                return i;
+    void save(std::ostream& os) const override {
+        write_vector(os, rrpvs_);
+        write_pod(os, insertions_);
+    }
+
+    void load(std::istream& is) override {
+        read_vector(is, &rrpvs_);
+        read_pod(is, &insertions_);
+    }
+
+private:
+    bool bimodal_;
+    std::vector<uint8_t> rrpvs_;
+    uint32_t insertions_;
+};
+
+// oldest fill first, hits do not update the state
+class FifoPolicy : public ReplPolicy {
+public:
+    FifoPolicy(uint32_t num_sets, uint32_t num_ways)
+        : ReplPolicy(num_sets, num_ways)
+        , stamps_(num_sets * num_ways) {
+        this->reset();
+    }
+
+    void reset() override {
+        std::fill(stamps_.begin(), stamps_.end(), 0);
+        clock_ = 0;
+    }
+
+    void touch(uint32_t, uint32_t) override {}
+
+    void insert(uint32_t set_id, uint32_t way) override {
+        stamps_[set_id * num_ways_ + way] = ++clock_;
+    }
+
+    uint32_t victim(uint32_t set_id) override {
+        auto stamps = &stamps_[set_id * num_ways_];
+        uint32_t way = 0;
+        for (uint32_t w = 1; w < num_ways_; ++w) {
+            if (stamps[w] < stamps[way]) {
+                way = w;
             }
         }
-        return -1;
+        return way;
+    }
+
+    void save(std::ostream& os) const override {
+        write_vector(os, stamps_);
+        write_pod(os, clock_);
+    }
+
+    void load(std::istream& is) override {
+        read_vector(is, &stamps_);
+        read_pod(is, &clock_);
+    }
+
+private:
+    std::vector<uint64_t> stamps_;
+    uint64_t clock_;
+};
+
+// the original CacheSim age counters: each demand lookup ages the filled
+// lines of the set and clears the hit line, a fill keeps the age of the
+// replaced line, and the victim is the last free line or oldest filled line
+// seen in way order, so a free line does not always win
+class CounterPolicy : public ReplPolicy {
+public:
+    CounterPolicy(uint32_t num_sets, uint32_t num_ways)
+        : ReplPolicy(num_sets, num_ways)
+        , ages_(num_sets * num_ways)
+        , filled_(num_sets * num_ways) {
+        this->reset();
+    }
+
+    void reset() override {
+        std::fill(ages_.begin(), ages_.end(), 0);
+        std::fill(filled_.begin(), filled_.end(), 0);
+    }
+
+    void touch(uint32_t set_id, uint32_t way) override {
+        this->miss(set_id);
+        ages_[set_id * num_ways_ + way] = 0;
+    }
+
+    void miss(uint32_t set_id) override {
+        auto ages = &ages_[set_id * num_ways_];
+        auto filled = &filled_[set_id * num_ways_];
+        for (uint32_t w = 0; w < num_ways_; ++w) {
+            ages[w] += filled[w];
+        }
+    }
+
+    void insert(uint32_t set_id, uint32_t way) override {
+        filled_[set_id * num_ways_ + way] = 1;
     }
 
-    mshr_entry_t& replay(uint32_t id) {
-        auto& root_entry = entries_.at(id);
-        assert(root_entry.bank_req.type == bank_req_t::Core);
-        // mark all related mshr entries for replay
-        for (auto& entry : entries_) {
-            if (entry.bank_req.type == bank_req_t::Core 
-             && entry.bank_req.set_id == root_entry.bank_req.set_id 
-             && entry.bank_req.tag == root_entry.bank_req.tag) {
-                entry.bank_req.type = bank_req_t::Replay;
+    uint32_t victim(uint32_t set_id) override {
+        auto ages = &ages_[set_id * num_ways_];
+        uint32_t way = 0;
+        uint32_t max_age = 0;
+        auto filled = &filled_[set_id * num_ways_];
+        for (uint32_t w = 0; w < num_ways_; ++w) {
+            if (!filled[w]) {
+                way = w;
+            } else if (ages[w] > max_age) {
+                max_age = ages[w];
+                way = w;
             }
         }
-        return root_entry;
+        return way;
+    }
+
+    void save(std::ostream& os) const override {
+        write_vector(os, ages_);
+        write_vector(os, filled_);
+    }
+
+    void load(std::istream& is) override {
+        read_vector(is, &ages_);
+        read_vector(is, &filled_);
     }
 
-    bool pop(bank_req_t* out) {
-        for (auto& entry : entries_) {
-            if (entry.bank_req.type == bank_req_t::Replay) {
-                *out = entry.bank_req;
-                entry.bank_req.type = bank_req_t::None;
-                --size_;
-                return true;
+private:
+    std::vector<uint32_t> ages_;
+    std::vector<uint8_t> filled_;
+};
+
+ReplPolicy* ReplPolicy::Create(Type type, uint32_t num_sets, uint32_t num_ways) {
+    switch (type) {
+    case Type::LRU:    return new LruPolicy(num_sets, num_ways);
+    case Type::PLRU:   return new PlruPolicy(num_sets, num_ways);
+    case Type::Random: return new RandomPolicy(num_sets, num_ways);
+    case Type::SRRIP:  return new RripPolicy(num_sets, num_ways, false);
+    case Type::BRRIP:  return new RripPolicy(num_sets, num_ways, true);
+    case Type::FIFO:   return new FifoPolicy(num_sets, num_ways);
+    case Type::Counter: return new CounterPolicy(num_sets, num_ways);
+    }
+    std::abort();
+    return nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Generates prefetch line addresses from the demand read stream.
+class Prefetcher {
+public:
+    typedef CacheSim::PrefetchType Type;
+
+    Prefetcher(Type type, uint32_t degree, uint32_t num_inputs)
+        : type_(type)
+        , degree_(degree)
+        , streams_(num_inputs)
+    {}
+
+    void reset() {
+        for (auto& stream : streams_) {
+            stream = stream_t();
+        }
+    }
+
+    // observe a demand read of a line, candidate lines are appended to out
+    void observe(uint32_t req_id, uint64_t line_addr, bool miss, bool prefetch_hit, std::vector<uint64_t>* out) {
+        switch (type_) {
+        case Type::None:
+            break;
+        case Type::NextLine:
+            // tagged next-line: a hit on a prefetched line continues the stream
+            if (miss || prefetch_hit) {
+                for (uint32_t i = 1; i <= degree_; ++i) {
+                    out->push_back(line_addr + i);
+                }
+            }
+            break;
+        case Type::Stride: {
+            auto& stream = streams_.at(req_id);
+            int64_t stride = int64_t(line_addr - stream.last_addr);
+            if (stream.valid && stride != 0) {
+                if (stride == stream.stride) {
+                    stream.confidence = std::min<uint32_t>(stream.confidence + 1, 3);
+                } else {
+                    stream.stride = stride;
+                    stream.confidence = 0;
+                }
             }
+            if (stride != 0) {
+                stream.last_addr = line_addr;
+                stream.valid = true;
+            }
+            if (stream.confidence >= 2) {
+                for (uint32_t i = 1; i <= degree_; ++i) {
+                    out->push_back(line_addr + stream.stride * i);
+                }
+            }
+        } break;
         }
-        return false;
     }
 
+    void save(std::ostream& os) const {
+        write_pod(os, type_);
+        write_vector(os, streams_);
+    }
+
+    // the streams of a different prefetcher configuration are dropped
+    void load(std::istream& is) {
+        Type type = Type::None;
+        std::vector<stream_t> streams;
+        read_pod(is, &type);
+        read_vector(is, &streams);
+        if (type == type_ && streams.size() == streams_.size()) {
+            streams_ = std::move(streams);
+        } else {
+            this->reset();
+        }
+    }
+
+private:
+    struct stream_t {
+        uint64_t last_addr;
+        int64_t  stride;
+        uint32_t confidence;
+        bool     valid;
+
+        stream_t() 
+            : last_addr(0)
+            , stride(0)
+            , confidence(0)
+            , valid(false) 
+        {}
+    };
+
+    Type type_;
+    uint32_t degree_;
+    std::vector<stream_t> streams_;
+};
+
+struct set_t {
+    std::vector<line_t> lines;
+
+    set_t(uint32_t num_ways) 
+        : lines(num_ways) 
+    {}
+
     void clear() {
-        for (auto& entry : entries_) {
-            entry.clear();
+        for (auto& line : lines) {
+            line.clear();
         }
-        size_ = 0;
     }
 };
 
@@ -298,6 +642,12 @@ private:
     uint64_t pending_read_reqs_;
     uint64_t pending_write_reqs_;
     uint64_t pending_fill_reqs_;
+    ReplPolicy* repl_policy_;
+    Prefetcher prefetcher_;
+    std::deque<uint64_t> prefetch_queue_;
+    std::vector<uint64_t> prefetch_addrs_;
+    std::vector<uint32_t> flush_cursors_;
+    bool flushing_;
 
 public:
     Impl(CacheSim* simobject, const Config& config) 
@@ -308,6 +658,10 @@ public:
         , mem_req_ports_(config.num_banks, simobject)
         , mem_rsp_ports_(config.num_banks, simobject)
         , pipeline_reqs_(config.num_banks, config.ports_per_bank)
+        , repl_policy_(ReplPolicy::Create(config.repl_policy, config.num_banks * params_.sets_per_bank, params_.lines_per_set))
+        , prefetcher_(config.prefetcher, config.prefetch_degree, config.num_inputs)
+        , flush_cursors_(config.num_banks, 0)
+        , flushing_(false)
     {
         char sname[100];
         snprintf(sname, 100, "%s-bypass-arb", simobject->name().c_str());
@@ -345,6 +699,10 @@ public:
         init_cycles_ = params_.sets_per_bank * params_.lines_per_set;
     }
 
+    ~Impl() {
+        delete repl_policy_;
+    }
+
     void reset() {
         if (config_.bypass)
             return;
@@ -352,10 +710,26 @@ public:
         for (auto& bank : banks_) {
             bank.clear();
         }
+        repl_policy_->reset();
+        prefetcher_.reset();
+        prefetch_queue_.clear();
         perf_stats_ = PerfStats();
         pending_read_reqs_  = 0;
         pending_write_reqs_ = 0;
         pending_fill_reqs_  = 0;
+        flushing_ = false;
+    }
+
+    void flush() {
+        // write-through caches hold no dirty lines
+        if (config_.bypass || config_.write_through)
+            return;
+        std::fill(flush_cursors_.begin(), flush_cursors_.end(), 0);
+        flushing_ = true;
+    }
+
+    bool flushing() const {
+        return flushing_;
     }
 
     void tick() {
@@ -480,15 +854,207 @@ public:
             perf_stats_.pipeline_stalls += (SimPlatform::instance().cycles() - time);
         }
     
+        // schedule prefetch requests into idle banks
+        if (!prefetch_queue_.empty()) {
+            uint64_t addr = prefetch_queue_.front() << config_.B;
+            auto bank_id = params_.addr_bank_id(addr);
+            auto& bank = banks_.at(bank_id);
+            auto& pipeline_req = pipeline_reqs_.at(bank_id);
+            if (pipeline_req.type == bank_req_t::None && !bank.mshr.full()) {
+                pipeline_req.tag      = params_.addr_tag(addr);
+                pipeline_req.set_id   = params_.addr_set_id(addr);
+                pipeline_req.cid      = 0;
+                pipeline_req.uuid     = 0;
+                pipeline_req.type     = bank_req_t::Core;
+                pipeline_req.write    = false;
+                pipeline_req.prefetch = true;
+                prefetch_queue_.pop_front();
+            }
+        }
+
+        // write back dirty lines through idle banks
+        if (flushing_) {
+            this->processFlush();
+        }
+
         // process active request        
         this->processBankRequests();
     } 
 
+    bool idle() const {
+        if (config_.bypass)
+            return true;
+        // outstanding fills accumulate memory latency every cycle
+        if (init_cycles_ != 0 || pending_fill_reqs_ != 0 || !prefetch_queue_.empty() || flushing_)
+            return false;
+        if (!bypass_switch_->RspIn.at(1).empty())
+            return false;
+        for (uint32_t bank_id = 0, n = config_.num_banks; bank_id < n; ++bank_id) {
+            if (!banks_.at(bank_id).mshr.empty() 
+             || !mem_rsp_ports_.at(bank_id).empty())
+                return false;
+        }
+        for (auto& core_req_port : simobject_->CoreReqPorts) {
+            if (!core_req_port.empty())
+                return false;
+        }
+        return true;
+    }
+
     const PerfStats& perf_stats() const {
         return perf_stats_;
     }
 
+    bool warmup(uint64_t addr, bool write) {
+        if (config_.bypass)
+            return false;
+
+        auto bank_id = params_.addr_bank_id(addr);
+        auto set_id  = params_.addr_set_id(addr);
+        auto tag     = params_.addr_tag(addr);
+        auto& set    = banks_.at(bank_id).sets.at(set_id);
+
+        uint32_t hit_line_id, repl_line_id;
+        bool found_free_line;
+        bool hit = this->tag_lookup(bank_id, set_id, tag, &hit_line_id, &repl_line_id, &found_free_line);
+
+        if (write && config_.write_through)
+            return false; // forwarded to memory
+        if (hit) {
+            if (write) {
+                set.lines.at(hit_line_id).dirty = true;
+            }
+            repl_policy_->touch(this->set_index(bank_id, set_id), hit_line_id);
+            return true;
+        }
+        repl_policy_->miss(this->set_index(bank_id, set_id));
+
+        // fill the replaced line
+        repl_line_id = this->fill_line(bank_id, set_id, repl_line_id, found_free_line);
+        auto& line = set.lines.at(repl_line_id);
+        line.valid = true;
+        line.dirty = write;
+        line.prefetched = false;
+        line.tag   = tag;
+        repl_policy_->insert(this->set_index(bank_id, set_id), repl_line_id);
+        return false;
+    }
+
+    void save(std::ostream& os) const {
+        // bypassed caches hold no lines
+        uint32_t num_banks = config_.bypass ? 0 : banks_.size();
+        write_pod(os, num_banks);
+        write_pod(os, params_.sets_per_bank);
+        write_pod(os, params_.lines_per_set);
+        write_pod(os, config_.repl_policy);
+        for (uint32_t b = 0; b < num_banks; ++b) {
+            for (auto& set : banks_.at(b).sets) {
+                for (auto& line : set.lines) {
+                    write_pod(os, line.tag);
+                    write_pod(os, line.valid);
+                    write_pod(os, line.dirty);
+                    write_pod(os, line.prefetched);
+                }
+            }
+        }
+        if (num_banks != 0) {
+            repl_policy_->save(os);
+            prefetcher_.save(os);
+            write_pod(os, uint64_t(prefetch_queue_.size()));
+            for (auto line_addr : prefetch_queue_) {
+                write_pod(os, line_addr);
+            }
+        }
+    }
+
+    bool load(std::istream& is) {
+        uint32_t num_banks = 0, sets_per_bank = 0, lines_per_set = 0;
+        ReplType repl_policy = ReplType::LRU;
+        read_pod(is, &num_banks);
+        read_pod(is, &sets_per_bank);
+        read_pod(is, &lines_per_set);
+        read_pod(is, &repl_policy);
+        if (!is
+         || num_banks != (config_.bypass ? 0 : banks_.size())
+         || sets_per_bank != params_.sets_per_bank
+         || lines_per_set != params_.lines_per_set
+         || repl_policy != config_.repl_policy)
+            return false;
+        for (uint32_t b = 0; b < num_banks; ++b) {
+            for (auto& set : banks_.at(b).sets) {
+                for (auto& line : set.lines) {
+                    read_pod(is, &line.tag);
+                    read_pod(is, &line.valid);
+                    read_pod(is, &line.dirty);
+                    read_pod(is, &line.prefetched);
+                }
+            }
+        }
+        if (num_banks != 0) {
+            repl_policy_->load(is);
+            prefetcher_.load(is);
+            uint64_t queue_size = 0;
+            read_pod(is, &queue_size);
+            prefetch_queue_.clear();
+            for (uint64_t i = 0; i < queue_size && is; ++i) {
+                uint64_t line_addr = 0;
+                read_pod(is, &line_addr);
+                prefetch_queue_.push_back(line_addr);
+            }
+            if (config_.prefetcher == PrefetchType::None) {
+                // pending prefetches are only replayed by a prefetching cache
+                prefetch_queue_.clear();
+            }
+        }
+        return bool(is);
+    }
+
 private:
+
+    uint32_t set_index(uint32_t bank_id, uint32_t set_id) const {
+        return bank_id * params_.sets_per_bank + set_id;
+    }
+
+    // on a miss, *repl_line_id is the first free line if there is one
+    bool tag_lookup(uint32_t bank_id, uint32_t set_id, uint64_t tag, uint32_t* hit_line_id, uint32_t* repl_line_id, bool* found_free_line) {
+        auto& set = banks_.at(bank_id).sets.at(set_id);
+        *hit_line_id = 0;
+        *repl_line_id = 0;
+        *found_free_line = false;
+        for (uint32_t i = 0, n = set.lines.size(); i < n; ++i) {
+            auto& line = set.lines.at(i);
+            if (line.valid) {
+                if (line.tag == tag) {
+                    *hit_line_id = i;
+                    return true;
+                }
+            } else if (!*found_free_line) {
+                *found_free_line = true;
+                *repl_line_id = i;
+            }
+        }
+        return false;
+    }
+
+    // the line replaced by a fill, the victim is only selected when the fill
+    // is allocated since selecting it updates the replacement state
+    uint32_t fill_line(uint32_t bank_id, uint32_t set_id, uint32_t free_line_id, bool found_free_line) {
+        if (found_free_line && config_.repl_policy != ReplType::Counter)
+            return free_line_id;
+        return repl_policy_->victim(this->set_index(bank_id, set_id));
+    }
+
+    void prefetch(uint32_t req_id, uint64_t addr, bool miss, bool prefetch_hit) {
+        prefetch_addrs_.clear();
+        prefetcher_.observe(req_id, addr >> config_.B, miss, prefetch_hit, &prefetch_addrs_);
+        for (auto line_addr : prefetch_addrs_) {
+            if (prefetch_queue_.size() >= PREFETCH_QUEUE_SIZE)
+                break;
+            if (std::find(prefetch_queue_.begin(), prefetch_queue_.end(), line_addr) != prefetch_queue_.end())
+                continue;
+            prefetch_queue_.push_back(line_addr);
+        }
+    }
     
     void processBypassResponse(const MemRsp& mem_rsp) {
         uint32_t req_id = mem_rsp.tag & ((1 << params_.log2_num_inputs)-1);                
@@ -515,6 +1081,39 @@ private:
         }
     }
 
+    void writeback(uint32_t bank_id, uint32_t set_id, line_t& line, uint32_t cid) {
+        MemReq mem_req;
+        mem_req.addr  = params_.mem_addr(bank_id, set_id, line.tag);
+        mem_req.write = true;
+        mem_req.cid   = cid;
+        mem_req_ports_.at(bank_id).send(mem_req, 1);
+        DT(3, simobject_->name() << "-dram-" << mem_req);
+        line.dirty = false;
+        ++perf_stats_.evictions;
+    }
+
+    // each idle bank writes back its next dirty line
+    void processFlush() {
+        uint32_t lines_per_bank = params_.sets_per_bank * params_.lines_per_set;
+        flushing_ = false;
+        for (uint32_t bank_id = 0, n = config_.num_banks; bank_id < n; ++bank_id) {
+            auto& cursor = flush_cursors_.at(bank_id);
+            if (pipeline_reqs_.at(bank_id).type == bank_req_t::None) {
+                auto& bank = banks_.at(bank_id);
+                while (cursor < lines_per_bank) {
+                    uint32_t set_id = cursor / params_.lines_per_set;
+                    auto& line = bank.sets.at(set_id).lines.at(cursor % params_.lines_per_set);
+                    ++cursor;
+                    if (line.valid && line.dirty) {
+                        this->writeback(bank_id, set_id, line, 0);
+                        break;
+                    }
+                }
+            }
+            flushing_ |= (cursor < lines_per_bank);
+        }
+    }
+
     void processBankRequests() {
         for (uint32_t bank_id = 0, n = config_.num_banks; bank_id < n; ++bank_id) {
             auto& bank = banks_.at(bank_id);
@@ -529,11 +1128,27 @@ private:
                 auto& entry = bank.mshr.replay(pipeline_req.tag);
                 auto& set   = bank.sets.at(entry.bank_req.set_id);
                 auto& line  = set.lines.at(entry.line_id);
+                if (line.valid && line.dirty) {
+                    // the victim may have been written since the miss
+                    this->writeback(bank_id, entry.bank_req.set_id, line, entry.bank_req.cid);
+                }
                 line.valid  = true;
+                line.dirty  = false;
                 line.tag    = entry.bank_req.tag;
+                line.prefetched = entry.bank_req.prefetch;
+                repl_policy_->insert(this->set_index(bank_id, entry.bank_req.set_id), entry.line_id);
                 --pending_fill_reqs_;
             } break;
             case bank_req_t::Replay: {
+                if (pipeline_req.write && !config_.write_through) {
+                    // write-allocate: the write lands in the filled line
+                    for (auto& line : bank.sets.at(pipeline_req.set_id).lines) {
+                        if (line.valid && line.tag == pipeline_req.tag) {
+                            line.dirty = true;
+                            break;
+                        }
+                    }
+                }
                 // send core response
                 if (!pipeline_req.write || config_.write_reponse) {
                     for (auto& info : pipeline_req.ports) {
@@ -546,32 +1161,52 @@ private:
                 }
             } break;
             case bank_req_t::Core: {        
-                bool hit = false;
-                bool found_free_line = false;            
-                uint32_t hit_line_id = 0;
-                uint32_t repl_line_id = 0;            
-                uint32_t max_cnt = 0;
+                bool found_free_line;
+                uint32_t hit_line_id;
+                uint32_t repl_line_id;
 
                 auto& set = bank.sets.at(pipeline_req.set_id);
 
                 // tag lookup                
-                for (uint32_t i = 0, n = set.lines.size(); i < n; ++i) {
-                    auto& line = set.lines.at(i);
-                    if (line.valid) {
-                        if (line.tag == pipeline_req.tag) {
-                            line.lru_ctr = 0;                        
-                            hit_line_id = i;
-                            hit = true;
-                        } else {
-                            ++line.lru_ctr;
-                        }
-                        if (max_cnt < line.lru_ctr) {
-                            max_cnt = line.lru_ctr;
-                            repl_line_id = i;
-                        }
-                    } else {                    
-                        found_free_line = true;
-                        repl_line_id = i;
+                bool hit = this->tag_lookup(bank_id, pipeline_req.set_id, pipeline_req.tag, &hit_line_id, &repl_line_id, &found_free_line);
+
+                if (pipeline_req.prefetch) {
+                    // prefetches only fetch missing lines
+                    if (!hit && !bank.mshr.lookup(pipeline_req)) {
+                        repl_line_id = this->fill_line(bank_id, pipeline_req.set_id, repl_line_id, found_free_line);
+                        auto mshr_id = bank.mshr.allocate(pipeline_req, repl_line_id);
+                        MemReq mem_req;
+                        mem_req.addr  = params_.mem_addr(bank_id, pipeline_req.set_id, pipeline_req.tag);
+                        mem_req.write = false;
+                        mem_req.tag   = mshr_id;
+                        mem_req_ports_.at(bank_id).send(mem_req, 1);
+                        DT(3, simobject_->name() << "-prefetch-" << mem_req);
+                        ++pending_fill_reqs_;
+                        ++perf_stats_.prefetches;
+                    }
+                    break;
+                }
+
+                bool prefetch_hit = false;
+                if (hit) {
+                    auto& hit_line = set.lines.at(hit_line_id);
+                    repl_policy_->touch(this->set_index(bank_id, pipeline_req.set_id), hit_line_id);
+                    if (hit_line.prefetched) {
+                        hit_line.prefetched = false;
+                        prefetch_hit = true;
+                        ++perf_stats_.prefetch_hits;
+                    }
+                } else {
+                    repl_policy_->miss(this->set_index(bank_id, pipeline_req.set_id));
+                }
+
+                if (!pipeline_req.write) {
+                    for (auto& info : pipeline_req.ports) {
+                        if (!info.valid)
+                            continue;
+                        auto addr = params_.mem_addr(bank_id, pipeline_req.set_id, pipeline_req.tag);
+                        this->prefetch(info.req_id, addr, !hit, prefetch_hit);
+                        break;
                     }
                 }
 
@@ -615,20 +1250,6 @@ private:
                     else
                         ++perf_stats_.read_misses;
 
-                    if (!found_free_line && !config_.write_through) {
-                        // write back dirty line
-                        auto& repl_line = set.lines.at(repl_line_id);
-                        if (repl_line.dirty) {                       
-                            MemReq mem_req;
-                            mem_req.addr  = params_.mem_addr(bank_id, pipeline_req.set_id, repl_line.tag);
-                            mem_req.write = true;
-                            mem_req.cid = pipeline_req.cid;
-                            mem_req_ports_.at(bank_id).send(mem_req, 1);
-                            DT(3, simobject_->name() << "-dram-" << mem_req);
-                            ++perf_stats_.evictions;
-                        }
-                    }
-
                     if (pipeline_req.write && config_.write_through) {
                         // forward write request to memory
                         {
@@ -653,8 +1274,18 @@ private:
                     } else {
                         // MSHR lookup
                         auto mshr_pending = bank.mshr.lookup(pipeline_req);
+                        if (mshr_pending && mshr_pending->bank_req.prefetch) {
+                            // the line is no longer counted as an unused prefetch
+                            mshr_pending->bank_req.prefetch = false;
+                            ++perf_stats_.prefetch_late;
+                        }
 
-                        // allocate MSHR
+                        // allocate MSHR, secondary misses share the primary's line
+                        if (mshr_pending) {
+                            repl_line_id = mshr_pending->line_id;
+                        } else {
+                            repl_line_id = this->fill_line(bank_id, pipeline_req.set_id, repl_line_id, found_free_line);
+                        }
                         auto mshr_id = bank.mshr.allocate(pipeline_req, repl_line_id);
                         
                         // send fill request
@@ -698,10 +1329,34 @@ void CacheSim::reset() {
     impl_->reset();
 }
 
+bool CacheSim::warmup(uint64_t addr, bool write) {
+    return impl_->warmup(addr, write);
+}
+
+void CacheSim::flush() {
+    impl_->flush();
+}
+
+bool CacheSim::flushing() const {
+    return impl_->flushing();
+}
+
+void CacheSim::save(std::ostream& os) const {
+    impl_->save(os);
+}
+
+bool CacheSim::load(std::istream& is) {
+    return impl_->load(is);
+}
+
 void CacheSim::tick() {
     impl_->tick();
 }
 
+bool CacheSim::idle() const {
+    return impl_->idle();
+}
+
 const CacheSim::PerfStats& CacheSim::perf_stats() const {
     return impl_->perf_stats();
 }
\ No newline at end of file
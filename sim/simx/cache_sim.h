@@ -20,6 +20,22 @@ namespace vortex {
 
 class CacheSim : public SimObject<CacheSim> {
 public:
+    enum class ReplType {
+        LRU,    // least recently used (stack)
+        PLRU,   // tree pseudo-LRU
+        Random, // pseudo-random
+        SRRIP,  // static re-reference interval prediction
+        BRRIP,  // bimodal re-reference interval prediction
+        FIFO,   // first-in first-out
+        Counter // per-line age counters
+    };
+
+    enum class PrefetchType {
+        None,
+        NextLine, // next lines on a miss or on the first hit of a prefetched line
+        Stride    // constant line stride per request input
+    };
+
     struct Config {
         bool    bypass;         // cache bypass
         uint8_t C;              // log2 cache size
@@ -35,6 +51,9 @@ public:
         uint16_t victim_size;   // victim cache size
         uint16_t mshr_size;     // MSHR buffer size
         uint8_t latency;        // pipeline latency
+        ReplType repl_policy;   // replacement policy
+        PrefetchType prefetcher; // prefetcher
+        uint8_t prefetch_degree; // lines prefetched per trigger
     };
     
     struct PerfStats {
@@ -47,6 +66,9 @@ public:
         uint64_t bank_stalls;
         uint64_t mshr_stalls;
         uint64_t mem_latency;
+        uint64_t prefetches;
+        uint64_t prefetch_hits;
+        uint64_t prefetch_late;
 
         PerfStats() 
             : reads(0)
@@ -58,6 +80,9 @@ public:
             , bank_stalls(0)
             , mshr_stalls(0)
             , mem_latency(0)
+            , prefetches(0)
+            , prefetch_hits(0)
+            , prefetch_late(0)
         {}
 
         PerfStats& operator+=(const PerfStats& rhs) {
@@ -70,6 +95,9 @@ public:
             this->bank_stalls += rhs.bank_stalls;
             this->mshr_stalls += rhs.mshr_stalls;
             this->mem_latency += rhs.mem_latency;
+            this->prefetches += rhs.prefetches;
+            this->prefetch_hits += rhs.prefetch_hits;
+            this->prefetch_late += rhs.prefetch_late;
             return *this;
         }
     };
@@ -86,7 +114,24 @@ public:
     
     void tick();
 
+    bool idle() const;
+
     const PerfStats& perf_stats() const;
+
+    // functional access updating the tag state only (no timing, no perf counters),
+    // returns false if the request continues to the next level
+    bool warmup(uint64_t addr, bool write);
+
+    // write back all dirty lines to the next level, one line per idle bank
+    // per cycle, no-op on write-through caches
+    void flush();
+
+    bool flushing() const;
+
+    // tag array checkpointing, load fails if the cache geometry differs
+    void save(std::ostream& os) const;
+
+    bool load(std::istream& is);
     
 private:
     class Impl;
@@ -12,6 +12,7 @@
 // limitations under the License.
 
 #include "cluster.h"
+#include "processor_impl.h"
 
 using namespace vortex;
 
@@ -33,64 +34,19 @@ Cluster::Cluster(const SimContext& ctx,
   
   char sname[100];
   snprintf(sname, 100, "cluster%d-l2cache", cluster_id);
-  l2cache_ = CacheSim::Create(sname, CacheSim::Config{
-    !L2_ENABLED,
-    log2ceil(L2_CACHE_SIZE), // C
-    log2ceil(MEM_BLOCK_SIZE), // B
-    log2ceil(L2_NUM_WAYS),  // W
-    0,                      // A
-    XLEN,                   // address bits  
-    L2_NUM_BANKS,           // number of banks
-    1,                      // number of ports
-    5,                      // request size 
-    true,                   // write-through
-    false,                  // write response
-    0,                      // victim size
-    L2_MSHR_SIZE,           // mshr
-    2,                      // pipeline latency
-  });
+  l2cache_ = CacheSim::Create(sname, Cluster::l2cache_config(arch));
 
   l2cache_->MemReqPort.bind(&this->mem_req_port);
   this->mem_rsp_port.bind(&l2cache_->MemRspPort);
 
   snprintf(sname, 100, "cluster%d-icaches", cluster_id);
-  icaches_ = CacheCluster::Create(sname, num_cores, NUM_ICACHES, 1, CacheSim::Config{
-    !ICACHE_ENABLED,
-    log2ceil(ICACHE_SIZE),  // C
-    log2ceil(L1_LINE_SIZE), // B
-    log2ceil(sizeof(uint32_t)), // W
-    log2ceil(ICACHE_NUM_WAYS),// A
-    XLEN,                   // address bits    
-    1,                      // number of banks
-    1,                      // number of ports
-    1,                      // number of inputs
-    true,                   // write-through
-    false,                  // write response
-    0,                      // victim size
-    (uint8_t)arch.num_warps(), // mshr
-    2,                      // pipeline latency
-  });
+  icaches_ = CacheCluster::Create(sname, num_cores, NUM_ICACHES, 1, Cluster::icache_config(arch));
 
   icaches_->MemReqPort.bind(&l2cache_->CoreReqPorts.at(0));
   l2cache_->CoreRspPorts.at(0).bind(&icaches_->MemRspPort);
 
   snprintf(sname, 100, "cluster%d-dcaches", cluster_id);
-  dcaches_ = CacheCluster::Create(sname, num_cores, NUM_DCACHES, NUM_LSU_LANES, CacheSim::Config{
-    !DCACHE_ENABLED,
-    log2ceil(DCACHE_SIZE),  // C
-    log2ceil(L1_LINE_SIZE), // B
-    log2ceil(sizeof(Word)), // W
-    log2ceil(DCACHE_NUM_WAYS),// A
-    XLEN,                   // address bits    
-    DCACHE_NUM_BANKS,       // number of banks
-    1,                      // number of ports
-    DCACHE_NUM_BANKS,       // number of inputs
-    true,                   // write-through
-    false,                  // write response
-    0,                      // victim size
-    DCACHE_MSHR_SIZE,       // mshr
-    4,                      // pipeline latency
-  });
+  dcaches_ = CacheCluster::Create(sname, num_cores, NUM_DCACHES, NUM_LSU_LANES, Cluster::dcache_config(arch));
 
   dcaches_->MemReqPort.bind(&l2cache_->CoreReqPorts.at(1));
   l2cache_->CoreRspPorts.at(1).bind(&dcaches_->MemRspPort);
@@ -104,7 +60,9 @@ Cluster::Cluster(const SimContext& ctx,
       (1 << SMEM_LOG_SIZE),
       sizeof(Word),
       NUM_LSU_LANES, 
-      NUM_LSU_LANES,
+      SMEM_NUM_BANKS,
+      SMEM_NUM_PORTS,
+      SMEM_BROADCAST,
       false
     });
   }
@@ -138,6 +96,72 @@ Cluster::Cluster(const SimContext& ctx,
   }
 }
 
+CacheSim::Config Cluster::icache_config(const Arch& arch) {
+  return CacheSim::Config{
+    !ICACHE_ENABLED,
+    log2ceil(ICACHE_SIZE),  // C
+    log2ceil(L1_LINE_SIZE), // B
+    log2ceil(sizeof(uint32_t)), // W
+    log2ceil(ICACHE_NUM_WAYS),// A
+    XLEN,                   // address bits    
+    1,                      // number of banks
+    1,                      // number of ports
+    1,                      // number of inputs
+    true,                   // write-through
+    false,                  // write response
+    0,                      // victim size
+    (uint8_t)arch.num_warps(), // mshr
+    2,                      // pipeline latency
+    CacheSim::ReplType(ICACHE_REPL_POLICY), // replacement policy
+    CacheSim::PrefetchType(ICACHE_PREFETCHER), // prefetcher
+    CACHE_PREFETCH_DEGREE,  // prefetch degree
+  };
+}
+
+CacheSim::Config Cluster::dcache_config(const Arch& /*arch*/) {
+  return CacheSim::Config{
+    !DCACHE_ENABLED,
+    log2ceil(DCACHE_SIZE),  // C
+    log2ceil(L1_LINE_SIZE), // B
+    log2ceil(sizeof(Word)), // W
+    log2ceil(DCACHE_NUM_WAYS),// A
+    XLEN,                   // address bits    
+    DCACHE_NUM_BANKS,       // number of banks
+    1,                      // number of ports
+    DCACHE_NUM_BANKS,       // number of inputs
+    !DCACHE_WRITEBACK,      // write-through
+    false,                  // write response
+    0,                      // victim size
+    DCACHE_MSHR_SIZE,       // mshr
+    4,                      // pipeline latency
+    CacheSim::ReplType(DCACHE_REPL_POLICY), // replacement policy
+    CacheSim::PrefetchType(DCACHE_PREFETCHER), // prefetcher
+    CACHE_PREFETCH_DEGREE,  // prefetch degree
+  };
+}
+
+CacheSim::Config Cluster::l2cache_config(const Arch& /*arch*/) {
+  return CacheSim::Config{
+    !L2_ENABLED,
+    log2ceil(L2_CACHE_SIZE), // C
+    log2ceil(MEM_BLOCK_SIZE), // B
+    log2ceil(L2_NUM_WAYS),  // W
+    0,                      // A
+    XLEN,                   // address bits  
+    L2_NUM_BANKS,           // number of banks
+    1,                      // number of ports
+    5,                      // request size 
+    !L2_WRITEBACK,          // write-through
+    false,                  // write response
+    0,                      // victim size
+    L2_MSHR_SIZE,           // mshr
+    2,                      // pipeline latency
+    CacheSim::ReplType(L2_REPL_POLICY), // replacement policy
+    CacheSim::PrefetchType(L2_PREFETCHER), // prefetcher
+    CACHE_PREFETCH_DEGREE,  // prefetch degree
+  };
+}
+
 Cluster::~Cluster() {
   //--
 }
@@ -152,6 +176,36 @@ void Cluster::tick() {
   //--
 }
 
+void Cluster::save(std::ostream& os) const {
+  for (auto& barrier : barriers_) {
+    write_bits(os, barrier);
+  }
+  for (auto& core : cores_) {
+    core->save(os);
+  }
+}
+
+void Cluster::load(std::istream& is) {
+  for (auto& barrier : barriers_) {
+    read_bits(is, &barrier);
+  }
+  for (auto& core : cores_) {
+    core->load(is);
+  }
+}
+
+void Cluster::save_caches(std::ostream& os) const {
+  icaches_->save(os);
+  dcaches_->save(os);
+  l2cache_->save(os);
+}
+
+bool Cluster::load_caches(std::istream& is) {
+  return icaches_->load(is)
+      && dcaches_->load(is)
+      && l2cache_->load(is);
+}
+
 void Cluster::attach_ram(RAM* ram) {
   for (auto core : cores_) {
     core->attach_ram(ram);
@@ -201,6 +255,53 @@ void Cluster::barrier(uint32_t bar_id, uint32_t count, uint32_t core_id) {
     }
 }
 
+void Cluster::icache_warmup(uint32_t core_index, uint64_t addr) {
+  if (icaches_->warmup(core_index, addr, false))
+    return;
+  if (l2cache_->warmup(addr, false))
+    return;
+  processor_->l3cache_warmup(addr, false);
+}
+
+void Cluster::dcache_warmup(uint32_t core_index, uint64_t addr, bool write) {
+  if (dcaches_->warmup(core_index, addr, write))
+    return;
+  if (l2cache_->warmup(addr, write))
+    return;
+  processor_->l3cache_warmup(addr, write);
+}
+
+void Cluster::dcache_flush(uint32_t core_index) {
+  dcaches_->flush(core_index);
+}
+
+bool Cluster::dcache_flushing(uint32_t core_index) const {
+  return dcaches_->flushing(core_index);
+}
+
+void Cluster::flush_caches(uint32_t level) {
+  if (level == 1) {
+    dcaches_->flush();
+  } else if (level == 2) {
+    l2cache_->flush();
+  }
+}
+
+void Cluster::attach_mem_trace(MemTraceWriter* trace) {
+  // requests are captured where they enter the caches, after the
+  // shared memory demux, so that a replay sees the same stream
+  for (uint32_t i = 0; i < cores_.size(); ++i) {
+    icaches_->CoreReqPorts.at(i).at(0).tx_callback([this, trace, i](const MemReq& req, uint64_t cycle) {
+      trace->write(MemTraceSource::ICache, req, cycle, cluster_id_, i, 0);
+    });
+    for (uint32_t j = 0; j < NUM_LSU_LANES; ++j) {
+      dcaches_->CoreReqPorts.at(i).at(j).tx_callback([this, trace, i, j](const MemReq& req, uint64_t cycle) {
+        trace->write(MemTraceSource::DCache, req, cycle, cluster_id_, i, j);
+      });
+    }
+  }
+}
+
 ProcessorImpl* Cluster::processor() const {
   return processor_;
 }
@@ -19,6 +19,7 @@
 #include "cache_cluster.h"
 #include "shared_mem.h"
 #include "core.h"
+#include "mem_trace.h"
 #include "constants.h"
 
 namespace vortex {
@@ -53,10 +54,21 @@ public:
 
   ~Cluster();
 
+  // cache configurations, shared with the memory trace replay
+  static CacheSim::Config icache_config(const Arch& arch);
+
+  static CacheSim::Config dcache_config(const Arch& arch);
+
+  static CacheSim::Config l2cache_config(const Arch& arch);
+
   void reset();
 
   void tick();
 
+  bool idle() const {
+    return true;
+  }
+
   void attach_ram(RAM* ram);
 
   bool running() const;
@@ -65,9 +77,36 @@ public:
 
   void barrier(uint32_t bar_id, uint32_t count, uint32_t core_id);
 
+  void icache_warmup(uint32_t core_index, uint64_t addr);
+
+  void dcache_warmup(uint32_t core_index, uint64_t addr, bool write);
+
+  void dcache_flush(uint32_t core_index);
+
+  bool dcache_flushing(uint32_t core_index) const;
+
+  // write back the dirty lines of the cluster caches at the given level
+  // (1: dcaches, 2: l2cache)
+  void flush_caches(uint32_t level);
+
+  // record the requests entering the cluster L1 caches
+  void attach_mem_trace(MemTraceWriter* trace);
+
   ProcessorImpl* processor() const;
 
+  const std::vector<Core::Ptr>& cores() const {
+    return cores_;
+  }
+
   Cluster::PerfStats perf_stats() const;
+
+  void save(std::ostream& os) const;
+
+  void load(std::istream& is);
+
+  void save_caches(std::ostream& os) const;
+
+  bool load_caches(std::istream& is);
   
 private:
   uint32_t                     cluster_id_;  
@@ -17,10 +17,120 @@
 #define RAM_PAGE_SIZE 4096
 #endif
 
+// address space reserved by the memory-mapped RAM
+#ifndef RAM_MAPPED_SIZE
+#define RAM_MAPPED_SIZE (1ull << 33)
+#endif
+
 #ifndef MEM_CYCLE_RATIO
 #define MEM_CYCLE_RATIO -1
 #endif
 
 #ifndef MEMORY_BANKS
 #define MEMORY_BANKS 2
+#endif
+
+#ifndef DECODE_CACHE_SIZE
+#define DECODE_CACHE_SIZE 1024
+#endif
+
+// cache replacement policy (CacheSim::ReplType): 
+// 0=LRU, 1=tree-PLRU, 2=random, 3=SRRIP, 4=BRRIP, 5=FIFO, 6=age counters
+#ifndef CACHE_REPL_POLICY
+#define CACHE_REPL_POLICY 0
+#endif
+
+#ifndef ICACHE_REPL_POLICY
+#define ICACHE_REPL_POLICY CACHE_REPL_POLICY
+#endif
+
+#ifndef DCACHE_REPL_POLICY
+#define DCACHE_REPL_POLICY CACHE_REPL_POLICY
+#endif
+
+#ifndef L2_REPL_POLICY
+#define L2_REPL_POLICY CACHE_REPL_POLICY
+#endif
+
+#ifndef L3_REPL_POLICY
+#define L3_REPL_POLICY CACHE_REPL_POLICY
+#endif
+
+// cache prefetcher (CacheSim::PrefetchType): 0=none, 1=next-line, 2=stride
+#ifndef ICACHE_PREFETCHER
+#define ICACHE_PREFETCHER 0
+#endif
+
+#ifndef DCACHE_PREFETCHER
+#define DCACHE_PREFETCHER 0
+#endif
+
+#ifndef L2_PREFETCHER
+#define L2_PREFETCHER 0
+#endif
+
+#ifndef L3_PREFETCHER
+#define L3_PREFETCHER 0
+#endif
+
+// lines prefetched per trigger
+#ifndef CACHE_PREFETCH_DEGREE
+#define CACHE_PREFETCH_DEGREE 2
+#endif
+
+// write-back, write-allocate data caches (write-through otherwise),
+// dirty lines are flushed on fences and at kernel end
+#ifndef CACHE_WRITEBACK
+#define CACHE_WRITEBACK 0
+#endif
+
+#ifndef DCACHE_WRITEBACK
+#define DCACHE_WRITEBACK CACHE_WRITEBACK
+#endif
+
+#ifndef L2_WRITEBACK
+#define L2_WRITEBACK CACHE_WRITEBACK
+#endif
+
+#ifndef L3_WRITEBACK
+#define L3_WRITEBACK CACHE_WRITEBACK
+#endif
+
+// group global LSU lane accesses into one request per L1 cache line
+#ifndef LSU_COALESCE
+#define LSU_COALESCE 0
+#endif
+
+// shared memory bank ports (the RTL banks are single-ported)
+#ifndef SMEM_NUM_PORTS
+#define SMEM_NUM_PORTS 1
+#endif
+
+// shared memory reads of the same word are served by a single bank access
+#ifndef SMEM_BROADCAST
+#define SMEM_BROADCAST 0
+#endif
+
+// software TLB in front of the page-table walker (active when satp enables
+// translation): direct-mapped L0 entries, set-associative L1 sets and ways
+#ifndef VM_TLB0_SIZE
+#define VM_TLB0_SIZE 16
+#endif
+
+#ifndef VM_TLB1_SETS
+#define VM_TLB1_SETS 16
+#endif
+
+#ifndef VM_TLB1_WAYS
+#define VM_TLB1_WAYS 4
+#endif
+
+// LSU issue delay per L1 TLB miss
+#ifndef VM_TLB_MISS_LATENCY
+#define VM_TLB_MISS_LATENCY 32
+#endif
+
+// register file rows are padded to a multiple of the SIMD block
+#ifndef SIMD_LANES
+#define SIMD_LANES 8
 #endif
\ No newline at end of file
@@ -16,6 +16,7 @@
 #include <string.h>
 #include <assert.h>
 #include <util.h>
+#include <serialize.h>
 #include "types.h"
 #include "arch.h"
 #include "mem.h"
@@ -42,6 +43,7 @@ Core::Core(const SimContext& ctx,
     , arch_(arch)
     , dcrs_(dcrs)
     , decoder_(arch)
+    , decode_cache_(cluster->processor()->code_region(), DECODE_CACHE_SIZE)
     , warps_(arch.num_warps())
     , barriers_(arch.num_barriers(), 0)
     , fcsrs_(arch.num_warps(), 0)
@@ -66,6 +68,8 @@ Core::Core(const SimContext& ctx,
     warps_.at(i) = std::make_shared<Warp>(this, i);
   }
 
+  mmu_.setTLB(VM_TLB0_SIZE, VM_TLB1_SETS, VM_TLB1_WAYS);
+
   for (uint32_t i = 0; i < ISSUE_WIDTH; ++i) {
     operands_.at(i) = SimPlatform::instance().create_object<Operand>();
   }
@@ -115,6 +119,7 @@ void Core::reset() {
   commit_exe_= 0;
 
   scoreboard_.clear();
+  decode_cache_.clear();
   fetch_latch_.clear();
   decode_latch_.clear();
   pending_icache_.clear();
@@ -122,6 +127,9 @@ void Core::reset() {
   issued_instrs_ = 0;
   committed_instrs_ = 0;
   exited_ = false;
+  sim_marker_ = false;
+  satp_ = 0;
+  mmu_.setVM(MemoryUnit::VMMode::Bare, 0);
   perf_stats_ = PerfStats();
   pending_ifetches_ = 0;
 }
@@ -138,6 +146,63 @@ void Core::tick() {
   DPN(2, std::flush);  
 }
 
+bool Core::idle() const {
+  // warps ready to schedule
+  if ((active_warps_ & ~stalled_warps_).any())
+    return false;
+
+  // fetch
+  if (!fetch_latch_.empty() || !icache_rsp_ports.at(0).empty())
+    return false;
+
+  // decode
+  if (!decode_latch_.empty()) {
+    auto trace = decode_latch_.front();
+    if (!ibuffers_.at(trace->wid % ISSUE_WIDTH).full())
+      return false;
+  }
+
+  // issue
+  for (uint32_t i = 0; i < ISSUE_WIDTH; ++i) {
+    if (!operands_.at(i)->Output.empty())
+      return false;
+    auto& ibuffer = ibuffers_.at(i);
+    if (!ibuffer.empty() && !scoreboard_.in_use(ibuffer.top()))
+      return false;
+  }
+
+  // execute and commit
+  for (uint32_t i = 0; i < (uint32_t)ExeType::MAX; ++i) {
+    for (uint32_t j = 0; j < ISSUE_WIDTH; ++j) {
+      if (!dispatchers_.at(i)->Outputs.at(j).empty()
+       || !exe_units_.at(i)->Outputs.at(j).empty())
+        return false;
+    }
+  }
+  for (auto trace : committed_traces_) {
+    if (trace)
+      return false;
+  }
+
+  return true;
+}
+
+void Core::skip(uint64_t cycles) {
+  // decode and issue stalls are unchanged since the core went idle
+  uint64_t ibuf_stalls = 0, scrb_stalls = 0;
+  if (!decode_latch_.empty())
+    ibuf_stalls = 1;
+  for (auto& ibuffer : ibuffers_) {
+    if (!ibuffer.empty())
+      ++scrb_stalls;
+  }
+  perf_stats_.cycles += cycles;
+  perf_stats_.ifetch_latency += pending_ifetches_ * cycles;
+  perf_stats_.ibuf_stalls += ibuf_stalls * cycles;
+  perf_stats_.scrb_stalls += scrb_stalls * cycles;
+  commit_exe_ += cycles;
+}
+
 void Core::schedule() {
   int scheduled_warp = -1;
 
@@ -167,6 +232,94 @@ void Core::schedule() {
   ++issued_instrs_;
 }
 
+bool Core::fast_forward(uint64_t stop_pc, bool warmup, uint32_t* executed) {
+  uint32_t core_index = core_id_ % arch_.num_cores();
+  *executed = 0;
+  sim_marker_ = false;
+
+  for (uint32_t wid = 0, nw = arch_.num_warps(); wid < nw; ++wid) {
+    if (!active_warps_.test(wid) || stalled_warps_.test(wid))
+      continue;
+
+    auto& warp = warps_.at(wid);
+    if (stop_pc != 0 && warp->getPC() == stop_pc)
+      return true;
+
+    if (warmup) {
+      cluster_->icache_warmup(core_index, mmu_.peekPhyAddr(warp->getPC()));
+    }
+
+    auto trace = this->step(wid);
+    ++(*executed);
+    perf_stats_.ff_instrs += trace->tmask.count();
+
+    if (warmup && trace->exe_type == ExeType::LSU && trace->lsu_type != LsuType::FENCE) {
+      auto trace_data = &trace->data.lsu;
+      for (uint32_t t = 0, nt = arch_.num_threads(); t < nt; ++t) {
+        if (!trace->tmask.test(t))
+          continue;
+        auto addr = trace_data->mem_addrs[t].addr;
+        if (this->get_addr_type(addr) != AddrType::Global)
+          continue;
+        cluster_->dcache_warmup(core_index, mmu_.peekPhyAddr(addr), trace->lsu_type == LsuType::STORE);
+      }
+    }
+
+    delete trace;
+
+    if (sim_marker_)
+      return true;
+  }
+
+  return false;
+}
+
+pipeline_trace_t* Core::step(uint32_t wid) {
+  if (!active_warps_.test(wid) || stalled_warps_.test(wid))
+    return nullptr;
+
+  auto trace = warps_.at(wid)->eval();
+
+  // barriers suspend the warp until released by the last arriving warp
+  if (trace->exe_type == ExeType::SFU && trace->sfu_type == SfuType::BAR) {
+    auto trace_data = &trace->data.sfu;
+    stalled_warps_.set(wid);
+    this->barrier(trace_data->bar.id, trace_data->bar.count, wid);
+  }
+
+  return trace;
+}
+
+void Core::save(std::ostream& os) const {
+  write_bits(os, active_warps_);
+  write_bits(os, stalled_warps_);
+  for (auto& barrier : barriers_) {
+    write_bits(os, barrier);
+  }
+  write_vector(os, fcsrs_);
+  write_pod(os, exited_);
+  write_pod(os, satp_);
+  for (auto& warp : warps_) {
+    warp->save(os);
+  }
+}
+
+void Core::load(std::istream& is) {
+  read_bits(is, &active_warps_);
+  read_bits(is, &stalled_warps_);
+  for (auto& barrier : barriers_) {
+    read_bits(is, &barrier);
+  }
+  read_vector(is, &fcsrs_);
+  read_pod(is, &exited_);
+  uint32_t satp;
+  read_pod(is, &satp);
+  this->set_satp(satp);
+  for (auto& warp : warps_) {
+    warp->load(is);
+  }
+}
+
 void Core::fetch() {
   perf_stats_.ifetch_latency += pending_ifetches_;
 
@@ -187,7 +340,7 @@ void Core::fetch() {
     return;
   auto trace = fetch_latch_.front();
   MemReq mem_req;
-  mem_req.addr  = trace->PC;
+  mem_req.addr  = mmu_.peekPhyAddr(trace->PC);
   mem_req.write = false;
   mem_req.tag   = pending_icache_.allocate(trace);    
   mem_req.cid   = trace->cid;
@@ -397,8 +550,12 @@ void Core::barrier(uint32_t bar_id, uint32_t count, uint32_t warp_id) {
   }
 }
 
+// Accesses to the memory shared by the clusters are made in the sequential
+// cluster order when the clusters are ticked in parallel (see wait_turn).
+
 void Core::icache_read(void *data, uint64_t addr, uint32_t size) {
-  mmu_.read(data, addr, size, 0);
+  SimPlatform::instance().wait_turn();
+  mmu_.read(data, addr, size, 0, true);
 }
 
 AddrType Core::get_addr_type(uint64_t addr) {
@@ -418,6 +575,7 @@ void Core::dcache_read(void *data, uint64_t addr, uint32_t size) {
   if (type == AddrType::Shared) {
     sharedmem_->read(data, addr, size);
   } else {  
+    SimPlatform::instance().wait_turn();
     mmu_.read(data, addr, size, 0);
   }
 
@@ -426,6 +584,9 @@ void Core::dcache_read(void *data, uint64_t addr, uint32_t size) {
 
 void Core::dcache_write(const void* data, uint64_t addr, uint32_t size) {  
   auto type = this->get_addr_type(addr);
+  if (type != AddrType::Shared) {
+    SimPlatform::instance().wait_turn();
+  }
   if (addr >= uint64_t(IO_COUT_ADDR)
    && addr < (uint64_t(IO_COUT_ADDR) + IO_COUT_SIZE)) {
      this->writeToStdOut(data, addr, size);
@@ -434,6 +595,7 @@ void Core::dcache_write(const void* data, uint64_t addr, uint32_t size) {
       sharedmem_->write(data, addr, size);
     } else {
       mmu_.write(data, addr, size, 0);
+      cluster_->processor()->code_region().write(addr, size);
     }
   }
   DPH(2, "Mem Write: addr=0x" << std::hex << addr << ", data=0x" << ByteStream(data, size) << " (size=" << size << ", type=" << type << ")" << std::endl);  
@@ -442,6 +604,7 @@ void Core::dcache_write(const void* data, uint64_t addr, uint32_t size) {
 void Core::dcache_amo_reserve(uint64_t addr) {
   auto type = this->get_addr_type(addr);
   if (type == AddrType::Global) {
+    SimPlatform::instance().wait_turn();
     mmu_.amo_reserve(addr);
   }
 }
@@ -449,6 +612,7 @@ void Core::dcache_amo_reserve(uint64_t addr) {
 bool Core::dcache_amo_check(uint64_t addr) {
   auto type = this->get_addr_type(addr);
   if (type == AddrType::Global) {
+    SimPlatform::instance().wait_turn();
     return mmu_.amo_check(addr);
   }
   return false;
@@ -479,6 +643,7 @@ void Core::cout_flush() {
 uint32_t Core::get_csr(uint32_t addr, uint32_t tid, uint32_t wid) {
   switch (addr) {
   case VX_CSR_SATP:
+    return satp_;
   case VX_CSR_PMPCFG0:
   case VX_CSR_PMPADDR0:
   case VX_CSR_MSTATUS:
@@ -642,6 +807,8 @@ void Core::set_csr(uint32_t addr, uint32_t value, uint32_t tid, uint32_t wid) {
     fcsrs_.at(wid) = value & 0xff;
     break;
   case VX_CSR_SATP:
+    this->set_satp(value);
+    break;
   case VX_CSR_MSTATUS:
   case VX_CSR_MEDELEG:
   case VX_CSR_MIDELEG:
@@ -652,6 +819,9 @@ void Core::set_csr(uint32_t addr, uint32_t value, uint32_t tid, uint32_t wid) {
   case VX_CSR_PMPADDR0:
   case VX_CSR_MNSTATUS:
     break;
+  case VX_CSR_SIM_MARKER:
+    sim_marker_ = true;
+    break;
   default:
     {
       std::cout << std::hex << "Error: invalid CSR write addr=0x" << addr << ", value=0x" << value << std::endl;
@@ -691,6 +861,29 @@ void Core::resume() {
   stalled_warps_.reset();
 }
 
+void Core::dcache_flush() {
+  cluster_->dcache_flush(core_id_ % arch_.num_cores());
+}
+
+bool Core::dcache_flushing() const {
+  return cluster_->dcache_flushing(core_id_ % arch_.num_cores());
+}
+
+void Core::set_satp(uint32_t value) {
+  // CSRs are 32-bit: bit 31 enables the native Sv32 (XLEN=32) or Sv39 (XLEN=64)
+  // page tables, the low 22 bits hold the root table PPN
+  if (value == satp_)
+    return;
+  satp_ = value;
+  auto mode = MemoryUnit::VMMode::Bare;
+  if (value >> 31) {
+    mode = (XLEN == 64) ? MemoryUnit::VMMode::Sv39 : MemoryUnit::VMMode::Sv32;
+  }
+  mmu_.setVM(mode, value & ((1u << 22) - 1));
+  // the decoded instructions are keyed by virtual PC
+  decode_cache_.invalidate();
+}
+
 void Core::attach_ram(RAM* ram) {
   // bind RAM to memory unit
 #if (XLEN == 64)
@@ -26,6 +26,7 @@
 #include "types.h"
 #include "arch.h"
 #include "decode.h"
+#include "decode_cache.h"
 #include "mem.h"
 #include "warp.h"
 #include "pipeline.h"
@@ -58,6 +59,11 @@ public:
     uint64_t stores;
     uint64_t ifetch_latency;
     uint64_t load_latency;
+    uint64_t lsu_accesses;
+    uint64_t lsu_requests;
+    uint64_t decode_hits;
+    uint64_t decode_misses;
+    uint64_t ff_instrs;
 
     PerfStats() 
       : cycles(0)
@@ -73,6 +79,11 @@ public:
       , stores(0)
       , ifetch_latency(0)
       , load_latency(0)
+      , lsu_accesses(0)
+      , lsu_requests(0)
+      , decode_hits(0)
+      , decode_misses(0)
+      , ff_instrs(0)
     {}
   };
 
@@ -95,12 +106,21 @@ public:
 
   void tick();
 
+  bool idle() const;
+
+  void skip(uint64_t cycles);
+
   void attach_ram(RAM* ram);
 
   bool running() const;
 
   void resume();
 
+  // write back the dirty lines of the core's data cache
+  void dcache_flush();
+
+  bool dcache_flushing() const;
+
   uint32_t id() const {
     return core_id_;
   }
@@ -139,6 +159,32 @@ public:
 
   bool check_exit(Word* exitcode, bool riscv_test) const;
 
+  // Executes one instruction on every ready warp without timing.
+  // Returns true when a fast-forward marker is reached: a warp at 'stop_pc'
+  // (0 to disable) or a write to VX_CSR_SIM_MARKER.
+  bool fast_forward(uint64_t stop_pc, bool warmup, uint32_t* executed);
+
+  // Executes the next instruction of a warp without timing (the caller owns
+  // the returned trace), nullptr if the warp is inactive or at a barrier.
+  pipeline_trace_t* step(uint32_t wid);
+
+  Warp& warp(uint32_t wid) {
+    return *warps_.at(wid);
+  }
+
+  const PerfStats& perf_stats() const {
+    return perf_stats_;
+  }
+
+  const MemoryUnit::TLBStats& tlb_stats() const {
+    return mmu_.tlbStats();
+  }
+
+  // architectural state checkpointing (pipelines must be empty)
+  void save(std::ostream& os) const;
+
+  void load(std::istream& is);
+
 private:
 
   void schedule();
@@ -152,11 +198,14 @@ private:
 
   void cout_flush();
 
+  void set_satp(uint32_t value);
+
   uint32_t core_id_;
   const Arch& arch_;
   const DCRS &dcrs_;
   
   const Decoder decoder_;
+  DecodeCache decode_cache_;
   MemoryUnit mmu_;
 
   std::vector<std::shared_ptr<Warp>> warps_;  
@@ -179,6 +228,8 @@ private:
   uint64_t issued_instrs_;
   uint64_t committed_instrs_;
   bool exited_;
+  bool sim_marker_;
+  uint32_t satp_;
 
   uint64_t pending_ifetches_;
 
@@ -15,6 +15,7 @@
 
 #include <util.h>
 #include <VX_types.h>
+#include <serialize.h>
 #include <array>
 
 namespace vortex {
@@ -31,6 +32,14 @@ public:
         states_.at(state) = value;
     }
 
+    void save(std::ostream& os) const {
+        write_pod(os, states_);
+    }
+
+    void load(std::istream& is) {
+        read_pod(is, &states_);
+    }
+
 private:    
     std::array<uint32_t, VX_DCR_BASE_STATE_COUNT> states_;
 };
@@ -0,0 +1,129 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <assert.h>
+#include "instr.h"
+
+namespace vortex {
+
+// Page range holding the code fetched by the cores of a processor.
+// Writes overlapping the range bump its version, which invalidates all
+// decoded instructions cached under an older version. The version is read
+// by clusters ticked in parallel, it is only updated in their sequential turn.
+class CodeRegion {
+public:
+  CodeRegion(uint32_t page_size)
+    : page_size_(page_size)
+    , version_(0) {
+    this->reset();
+  }
+
+  void reset() {
+    start_ = ~uint64_t(0);
+    end_ = 0;
+    version_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void fetch(uint64_t addr) {
+    uint64_t page = addr & ~uint64_t(page_size_ - 1);
+    start_ = std::min(start_, page);
+    end_ = std::max(end_, page + page_size_);
+  }
+
+  void write(uint64_t addr, uint64_t size) {
+    if (addr < end_ && (addr + size) > start_) {
+      this->reset();
+    }
+  }
+
+  uint64_t version() const {
+    return version_.load(std::memory_order_relaxed);
+  }
+
+private:
+  uint64_t page_size_;
+  uint64_t start_;
+  uint64_t end_;
+  std::atomic<uint64_t> version_;
+};
+
+// Direct-mapped cache of decoded instructions indexed by PC.
+// Entries are dropped lazily on the next lookup after a code write or an
+// invalidation, so that the instruction causing it remains valid while it
+// executes.
+class DecodeCache {
+public:
+  DecodeCache(CodeRegion& region, uint32_t size)
+    : region_(region)
+    , entries_(size)
+    , mask_(size - 1)
+    , version_(region.version())
+    , stale_(false) {
+    assert(size != 0 && 0 == (size & (size - 1)));
+  }
+
+  void clear() {
+    for (auto& entry : entries_) {
+      entry.instr = nullptr;
+    }
+    version_ = region_.version();
+    stale_ = false;
+  }
+
+  // the PCs no longer map to the same code, e.g. after an address space switch
+  void invalidate() {
+    stale_ = true;
+  }
+
+  const Instr* lookup(uint64_t PC, uint32_t* code) {
+    if (stale_ || version_ != region_.version()) {
+      this->clear();
+    }
+    auto& entry = entries_.at((PC >> 2) & mask_);
+    if (entry.instr && entry.PC == PC) {
+      *code = entry.code;
+      return entry.instr.get();
+    }
+    return nullptr;
+  }
+
+  const Instr* insert(uint64_t PC, uint32_t code, const std::shared_ptr<const Instr>& instr) {
+    auto& entry = entries_.at((PC >> 2) & mask_);
+    entry.PC = PC;
+    entry.code = code;
+    entry.instr = instr;
+    region_.fetch(PC);
+    return instr.get();
+  }
+
+private:
+  struct entry_t {
+    uint64_t PC;
+    uint32_t code;
+    std::shared_ptr<const Instr> instr;
+  };
+
+  CodeRegion& region_;
+  std::vector<entry_t> entries_;
+  uint64_t mask_;
+  uint64_t version_;
+  bool stale_;
+};
+
+}
@@ -117,6 +117,22 @@ public:
         }
     };
 
+    virtual bool idle() const {
+        for (uint32_t i = 0; i < ISSUE_WIDTH; ++i) {
+            if (!queues_.at(i).empty() || !Inputs_.at(i).empty())
+                return false;
+        }
+        return true;
+    }
+
+    virtual void skip(uint64_t cycles) {
+        // empty batches complete every cycle
+        batch_idx_ = (batch_idx_ + cycles) % batch_count_;
+        for (uint32_t b = 0; b < block_size_; ++b) {
+            start_p_.at(b) = 0;
+        }
+    }
+
     bool push(uint32_t issue_index, pipeline_trace_t* trace) {
         auto& queue = queues_.at(issue_index);
         if (queue.size() >= buf_size_)
@@ -100,6 +100,8 @@ LsuUnit::LsuUnit(const SimContext& ctx, Core* core)
     , num_lanes_(NUM_LSU_LANES)     
     , pending_loads_(0)
     , fence_lock_(false)
+    , fence_flush_(false)
+    , tlb_stalls_(ISSUE_WIDTH, 0)
     , input_idx_(0)
 {}
 
@@ -107,6 +109,8 @@ void LsuUnit::reset() {
     pending_rd_reqs_.clear();
     pending_loads_ = 0;
     fence_lock_ = false;
+    fence_flush_ = false;
+    std::fill(tlb_stalls_.begin(), tlb_stalls_.end(), 0);
 }
 
 void LsuUnit::tick() {    
@@ -159,10 +163,18 @@ void LsuUnit::tick() {
         // wait for all pending memory operations to complete
         if (!pending_rd_reqs_.empty())
             return;
+        // then for a write-back dcache to release its dirty lines
+        if (!fence_flush_) {
+            core_->dcache_flush();
+            fence_flush_ = true;
+        }
+        if (core_->dcache_flushing())
+            return;
         int iw = fence_state_->wid % ISSUE_WIDTH;
         auto& output = Outputs.at(iw);
         output.send(fence_state_, 1);
         fence_lock_ = false;
+        fence_flush_ = false;
         DT(3, "fence-unlock: " << fence_state_);
     }    
 
@@ -174,7 +186,7 @@ void LsuUnit::tick() {
             continue;
         auto& output = Outputs.at(iw);
         auto trace = input.front();
-        auto trace_data = std::dynamic_pointer_cast<LsuTraceData>(trace->data);
+        auto trace_data = &trace->data.lsu;
 
         auto t0 = trace->pid * num_lanes_;
 
@@ -189,6 +201,20 @@ void LsuUnit::tick() {
             break;
         }
 
+        // TLB misses delay the requests of the instruction, they are charged
+        // on its first block and the next blocks queue behind it
+        if (trace->sop && trace_data->tlb_misses != 0) {
+            auto cycles = SimPlatform::instance().cycles();
+            auto& tlb_stall = tlb_stalls_.at(iw);
+            if (0 == tlb_stall) {
+                tlb_stall = cycles + trace_data->tlb_misses * VM_TLB_MISS_LATENCY;
+            }
+            if (cycles < tlb_stall)
+                continue;
+            trace_data->tlb_misses = 0;
+            tlb_stall = 0;
+        }
+
         // check pending queue capacity    
         if (pending_rd_reqs_.full()) {
             if (!trace->log_once(true)) {
@@ -201,56 +227,83 @@ void LsuUnit::tick() {
         
         bool is_write = (trace->lsu_type == LsuType::STORE);
 
+        uint32_t active_lanes = 0;
+        for (uint32_t t = 0; t < num_lanes_; ++t) {
+            active_lanes += trace->tmask.test(t0 + t);
+        }
+
         // duplicates detection
         bool is_dup = false;
         if (trace->tmask.test(t0)) {
             uint64_t addr_mask = sizeof(uint32_t)-1;
-            uint32_t addr0 = trace_data->mem_addrs.at(0).addr & ~addr_mask;
+            uint32_t addr0 = trace_data->mem_addrs[t0].addr & ~addr_mask;
             uint32_t matches = 1;
             for (uint32_t t = 1; t < num_lanes_; ++t) {
                 if (!trace->tmask.test(t0 + t))
                     continue;
-                auto mem_addr = trace_data->mem_addrs.at(t).addr & ~addr_mask;
+                auto mem_addr = trace_data->mem_addrs[t0 + t].addr & ~addr_mask;
                 matches += (addr0 == mem_addr);
             }
-            is_dup = (matches == trace->tmask.count());
+            is_dup = (matches == active_lanes);
         }
 
-        uint32_t addr_count;
-        if (is_dup) {
-            addr_count = 1;
-        } else {
-            addr_count = trace->tmask.count();
+        // select the lanes issuing requests: duplicates collapse to the first
+        // lane and, when coalescing, global accesses are grouped by cache line
+        uint32_t req_lanes[NUM_LSU_LANES];
+        uint32_t addr_count = 0;
+        for (uint32_t t = 0; t < num_lanes_; ++t) {
+            if (!trace->tmask.test(t0 + t))
+                continue;
+            bool merged = false;
+        #if LSU_COALESCE
+            auto mem_addr = trace_data->mem_addrs[t0 + t].addr;
+            if (core_->get_addr_type(mem_addr) == AddrType::Global) {
+                uint64_t line_addr = mem_addr / L1_LINE_SIZE;
+                for (uint32_t i = 0; i < addr_count; ++i) {
+                    auto req_addr = trace_data->mem_addrs[t0 + req_lanes[i]].addr;
+                    if ((req_addr / L1_LINE_SIZE) == line_addr
+                     && core_->get_addr_type(req_addr) == AddrType::Global) {
+                        merged = true;
+                        break;
+                    }
+                }
+            }
+        #endif
+            if (!merged) {
+                req_lanes[addr_count++] = t;
+            }
+            if (is_dup)
+                break;
         }
 
         auto tag = pending_rd_reqs_.allocate({trace, addr_count});
 
-        for (uint32_t t = 0; t < num_lanes_; ++t) {
-            if (!trace->tmask.test(t0 + t))
-                continue;
-            
+        for (uint32_t i = 0; i < addr_count; ++i) {
+            uint32_t t = req_lanes[i];
             auto& dcache_req_port = core_->dcache_req_ports.at(t);
-            auto mem_addr = trace_data->mem_addrs.at(t);
+            auto mem_addr = trace_data->mem_addrs[t0 + t];
             auto type = core_->get_addr_type(mem_addr.addr);
 
             MemReq mem_req;
-            mem_req.addr  = mem_addr.addr;
+            mem_req.addr  = (type == AddrType::Global) ? core_->mmu_.peekPhyAddr(mem_addr.addr) : mem_addr.addr;
             mem_req.write = is_write;
             mem_req.type  = type; 
             mem_req.tag   = tag;
             mem_req.cid   = trace->cid;
             mem_req.uuid  = trace->uuid;        
+            mem_req.size  = mem_addr.size;
                 
             dcache_req_port.send(mem_req, 2);
             DT(3, "dcache-req: addr=0x" << std::hex << mem_req.addr << ", tag=" << tag 
                 << ", lsu_type=" << trace->lsu_type << ", tid=" << t << ", addr_type=" << mem_req.type << ", " << *trace);
 
             ++pending_loads_;
-            ++core_->perf_stats_.loads;        
-            if (is_dup)
-                break;
+            ++core_->perf_stats_.loads;
         }
 
+        core_->perf_stats_.lsu_accesses += active_lanes;
+        core_->perf_stats_.lsu_requests += addr_count;
+
         // do not wait on writes
         if (is_write) {
             pending_rd_reqs_.release(tag);
@@ -267,6 +320,24 @@ void LsuUnit::tick() {
     ++input_idx_;
 }
 
+bool LsuUnit::idle() const {
+    // stores are counted in pending_loads_ but never respond, the elided
+    // latency is accounted in skip()
+    if (!pending_rd_reqs_.empty() || fence_lock_)
+        return false;
+    for (uint32_t t = 0; t < num_lanes_; ++t) {
+        if (!core_->dcache_rsp_ports.at(t).empty()
+         || !core_->sharedmem_->Outputs.at(t).empty())
+            return false;
+    }
+    return ExeUnit::idle();
+}
+
+void LsuUnit::skip(uint64_t cycles) {
+    core_->perf_stats_.load_latency += pending_loads_ * cycles;
+    input_idx_ += cycles;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 SfuUnit::SfuUnit(const SimContext& ctx, Core* core) 
@@ -299,7 +370,7 @@ void SfuUnit::tick() {
             break;
         case SfuType::BAR: {
             output.send(trace, 1);
-            auto trace_data = std::dynamic_pointer_cast<SFUTraceData>(trace->data);
+            auto trace_data = &trace->data.sfu;
             if (trace->eop) {
                 core_->barrier(trace_data->bar.id, trace_data->bar.count, trace->wid);
             }
@@ -326,4 +397,8 @@ void SfuUnit::tick() {
         break; // single block
     }
     ++input_idx_;
-}
\ No newline at end of file
+}
+
+void SfuUnit::skip(uint64_t cycles) {
+    input_idx_ += cycles;
+}
@@ -39,6 +39,16 @@ public:
 
     virtual void tick() = 0;
 
+    virtual bool idle() const {
+        for (auto& input : Inputs) {
+            if (!input.empty())
+                return false;
+        }
+        return true;
+    }
+
+    virtual void skip(uint64_t /*cycles*/) {}
+
 protected:
     Core* core_;
 };
@@ -71,6 +81,10 @@ public:
 
     void tick();
 
+    bool idle() const;
+
+    void skip(uint64_t cycles);
+
 private:    
     struct pending_req_t {
       pipeline_trace_t* trace;
@@ -81,6 +95,8 @@ private:
     pipeline_trace_t* fence_state_;
     uint64_t pending_loads_;
     bool fence_lock_;
+    bool fence_flush_;
+    std::vector<uint64_t> tlb_stalls_;
     uint32_t input_idx_;
 };
 
@@ -92,6 +108,8 @@ public:
     
     void tick();
 
+    void skip(uint64_t cycles);
+
 private:
   uint32_t input_idx_;
 };
@@ -16,6 +16,7 @@
 #include <unistd.h>
 #include <math.h>
 #include <bitset>
+#include <algorithm>
 #include <climits>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -25,6 +26,7 @@
 #include "warp.h"
 #include "instr.h"
 #include "core.h"
+#include "constants.h"
 
 using namespace vortex;
 
@@ -66,6 +68,57 @@ inline int64_t check_boxing(int64_t a) {
   return nan_box(0x7fc00000); // NaN
 }
 
+// Lane-parallel integer ALU over [thread] register rows.
+// Whole SIMD blocks are computed without control flow so that the loops get
+// vectorized, inactive lanes are masked on write-back.
+template <typename Op>
+inline void alu_lanes(Word* __restrict rd, const Word* __restrict rs1, const Word* __restrict rs2, uint32_t num_lanes, const Op& op) {
+  for (size_t t = 0; t < num_lanes; t += SIMD_LANES) {
+    for (size_t j = 0; j < SIMD_LANES; ++j) {
+      rd[t + j] = op(rs1[t + j], rs2[t + j]);
+    }
+  }
+}
+
+template <typename Op>
+inline void alu_lanes(Word* __restrict rd, const Word* __restrict rs1, uint32_t num_lanes, const Op& op) {
+  for (size_t t = 0; t < num_lanes; t += SIMD_LANES) {
+    for (size_t j = 0; j < SIMD_LANES; ++j) {
+      rd[t + j] = op(rs1[t + j]);
+    }
+  }
+}
+
+// Single-precision arithmetic on the host FPU, see rv_fop_s_lanes().
+// Returns the active lanes left for SoftFloat evaluation.
+inline ThreadMask fop_s_lanes(uint32_t op, const reg_data_t rsdata[][MAX_NUM_THREADS], reg_data_t* rddata, 
+                              const ThreadMask& tmask, uint32_t num_threads, uint32_t* fflags) {
+  uint32_t srcs[3][MAX_NUM_THREADS];
+  uint32_t result[MAX_NUM_THREADS];
+  uint32_t num_srcs = (op >= RV_FOP_MADD) ? 3 : 2;
+  for (uint32_t i = 0; i < num_srcs; ++i) {
+    for (uint32_t t = 0; t < num_threads; ++t) {
+      srcs[i][t] = tmask.test(t) ? check_boxing(rsdata[i][t].u64) : 0;
+    }
+  }
+  uint32_t mask = tmask.to_ulong();
+  uint32_t soft_mask = rv_fop_s_lanes(op, srcs[0], srcs[1], srcs[2], result, num_threads, mask, fflags);
+  for (uint32_t t = 0; t < num_threads; ++t) {
+    if ((mask & ~soft_mask) & (1u << t)) {
+      rddata[t].u64 = nan_box(result[t]);
+    }
+  }
+  return ThreadMask(soft_mask);
+}
+
+inline void write_lanes(Word* __restrict row, const Word* __restrict rd, const Word* __restrict mask, uint32_t num_lanes) {
+  for (size_t t = 0; t < num_lanes; t += SIMD_LANES) {
+    for (size_t j = 0; j < SIMD_LANES; ++j) {
+      row[t + j] = (rd[t + j] & mask[t + j]) | (row[t + j] & ~mask[t + j]);
+    }
+  }
+}
+
 void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
   assert(tmask_.any());
 
@@ -93,10 +146,24 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         break;
   }
 
-  std::vector<reg_data_t[3]> rsdata(num_threads);
-  std::vector<reg_data_t> rddata(num_threads);
+  // operands are laid out [src][thread] like the register files
+  reg_data_t rsdata[3][MAX_NUM_THREADS];
+  reg_data_t rddata[MAX_NUM_THREADS];
 
+  // base integer ALU instructions run lane-parallel on the register rows
+  auto num_lanes = reg_stride_;
+  Word rd_lanes[MAX_NUM_THREADS];
+  bool lane_alu = (opcode == LUI_INST) 
+               || (opcode == AUIPC_INST)
+               || (opcode == I_INST)
+               || (opcode == R_INST && !(func7 & 0x1));
+
+#ifdef NDEBUG
+  // lane-parallel instructions read the register rows directly
+  auto num_rsrcs = lane_alu ? 0 : instr.getNRSrc();
+#else
   auto num_rsrcs = instr.getNRSrc();
+#endif
   if (num_rsrcs) {              
     for (uint32_t i = 0; i < num_rsrcs; ++i) {          
       auto type = instr.getRSType(i);
@@ -110,8 +177,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
             DPN(2, "-");
             continue;            
           }
-          rsdata[t][i].u = ireg_file_.at(t)[reg];          
-          DPN(2, "0x" << std::hex << rsdata[t][i].i);
+          rsdata[i][t].u = ireg_file_[reg * reg_stride_ + t];          
+          DPN(2, "0x" << std::hex << rsdata[i][t].i);
         }
         DPN(2, "}" << std::endl);
         break;
@@ -123,8 +190,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
             DPN(2, "-");
             continue;            
           }
-          rsdata[t][i].u64 = freg_file_.at(t)[reg];
-          DPN(2, "0x" << std::hex << rsdata[t][i].f);
+          rsdata[i][t].u64 = freg_file_[reg * reg_stride_ + t];
+          DPN(2, "0x" << std::hex << rsdata[i][t].f);
         }
         DPN(2, "}" << std::endl);
         break;
@@ -144,11 +211,7 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
     // RV32I: LUI
     trace->exe_type = ExeType::ALU;
     trace->alu_type = AluType::ARITH;
-    for (uint32_t t = thread_start; t < num_threads; ++t) {
-      if (!tmask_.test(t))
-        continue;
-      rddata[t].i = immsrc << 12;
-    }    
+    std::fill_n(rd_lanes, num_lanes, immsrc << 12);
     rd_write = true;
     break;
   }  
@@ -156,11 +219,7 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
     // RV32I: AUIPC
     trace->exe_type = ExeType::ALU;
     trace->alu_type = AluType::ARITH;
-    for (uint32_t t = thread_start; t < num_threads; ++t) {
-      if (!tmask_.test(t))
-        continue;
-      rddata[t].i = (immsrc << 12) + PC_;
-    }    
+    std::fill_n(rd_lanes, num_lanes, (immsrc << 12) + PC_);
     rd_write = true;
     break;
   }
@@ -169,45 +228,45 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
     trace->alu_type = AluType::ARITH;
     trace->used_iregs.set(rsrc0);
     trace->used_iregs.set(rsrc1);
-    for (uint32_t t = thread_start; t < num_threads; ++t) {
-      if (!tmask_.test(t))
-        continue;
-      if (func7 & 0x1) {
+    if (func7 & 0x1) {
+      for (uint32_t t = thread_start; t < num_threads; ++t) {
+        if (!tmask_.test(t))
+          continue;
         switch (func3) {
         case 0: {
           // RV32M: MUL
-          rddata[t].i = rsdata[t][0].i * rsdata[t][1].i;
+          rddata[t].i = rsdata[0][t].i * rsdata[1][t].i;
           trace->alu_type = AluType::IMUL;
           break;
         }
         case 1: {
           // RV32M: MULH
-          auto first = static_cast<DWordI>(rsdata[t][0].i);
-          auto second = static_cast<DWordI>(rsdata[t][1].i);
+          auto first = static_cast<DWordI>(rsdata[0][t].i);
+          auto second = static_cast<DWordI>(rsdata[1][t].i);
           rddata[t].i = (first * second) >> XLEN;
           trace->alu_type = AluType::IMUL;
           break;
         }
         case 2: {
           // RV32M: MULHSU       
-          auto first = static_cast<DWordI>(rsdata[t][0].i);
-          auto second = static_cast<DWord>(rsdata[t][1].u);
+          auto first = static_cast<DWordI>(rsdata[0][t].i);
+          auto second = static_cast<DWord>(rsdata[1][t].u);
           rddata[t].i = (first * second) >> XLEN;
           trace->alu_type = AluType::IMUL;
           break;
         } 
         case 3: {
           // RV32M: MULHU
-          auto first = static_cast<DWord>(rsdata[t][0].u);
-          auto second = static_cast<DWord>(rsdata[t][1].u);
+          auto first = static_cast<DWord>(rsdata[0][t].u);
+          auto second = static_cast<DWord>(rsdata[1][t].u);
           rddata[t].i = (first * second) >> XLEN;
           trace->alu_type = AluType::IMUL;
           break;
         } 
         case 4: {
           // RV32M: DIV
-          auto dividen = rsdata[t][0].i;
-          auto divisor = rsdata[t][1].i; 
+          auto dividen = rsdata[0][t].i;
+          auto divisor = rsdata[1][t].i; 
           auto largest_negative = WordI(1) << (XLEN-1);  
           if (divisor == 0) {
             rddata[t].i = -1;
@@ -221,8 +280,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         } 
         case 5: {
           // RV32M: DIVU
-          auto dividen = rsdata[t][0].u;
-          auto divisor = rsdata[t][1].u;
+          auto dividen = rsdata[0][t].u;
+          auto divisor = rsdata[1][t].u;
           if (divisor == 0) {
             rddata[t].i = -1;
           } else {
@@ -233,10 +292,10 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         } 
         case 6: {
           // RV32M: REM
-          auto dividen = rsdata[t][0].i;
-          auto divisor = rsdata[t][1].i;
+          auto dividen = rsdata[0][t].i;
+          auto divisor = rsdata[1][t].i;
           auto largest_negative = WordI(1) << (XLEN-1);
-          if (rsdata[t][1].i == 0) {
+          if (rsdata[1][t].i == 0) {
             rddata[t].i = dividen;
           } else if (dividen == largest_negative && divisor == -1) {
             rddata[t].i = 0;
@@ -248,9 +307,9 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         } 
         case 7: {
           // RV32M: REMU
-          auto dividen = rsdata[t][0].u;
-          auto divisor = rsdata[t][1].u;
-          if (rsdata[t][1].i == 0) {
+          auto dividen = rsdata[0][t].u;
+          auto divisor = rsdata[1][t].u;
+          if (rsdata[1][t].i == 0) {
             rddata[t].i = dividen;
           } else {
             rddata[t].i = dividen % divisor;
@@ -261,130 +320,132 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         default:
           std::abort();
         }
-      } else {
-        switch (func3) {
-        case 0: {
-          if (func7) {
-            // RV32I: SUB
-            rddata[t].i = rsdata[t][0].i - rsdata[t][1].i;
-          } else {
-            // RV32I: ADD
-            rddata[t].i = rsdata[t][0].i + rsdata[t][1].i;
-          }
-          break;
-        }
-        case 1: {
-          // RV32I: SLL
-          Word shamt_mask = (Word(1) << log2up(XLEN)) - 1;
-          Word shamt = rsdata[t][1].i & shamt_mask;
-          rddata[t].i = rsdata[t][0].i << shamt;
-          break;
-        }
-        case 2: {
-          // RV32I: SLT
-          rddata[t].i = rsdata[t][0].i < rsdata[t][1].i;
-          break;
-        }
-        case 3: {
-          // RV32I: SLTU
-          rddata[t].i = rsdata[t][0].u < rsdata[t][1].u;
-          break;
-        }
-        case 4: {
-          // RV32I: XOR
-          rddata[t].i = rsdata[t][0].i ^ rsdata[t][1].i;
-          break;
-        }
-        case 5: {
-          Word shamt_mask = ((Word)1 << log2up(XLEN)) - 1;
-          Word shamt = rsdata[t][1].i & shamt_mask;
-          if (func7) {
-            // RV32I: SRA
-            rddata[t].i = rsdata[t][0].i >> shamt;
-          } else {
-            // RV32I: SRL
-            rddata[t].i = rsdata[t][0].u >> shamt;
-          }
-          break;
-        }
-        case 6: {
-          // RV32I: OR
-          rddata[t].i = rsdata[t][0].i | rsdata[t][1].i;
-          break;
-        }
-        case 7: {
-          // RV32I: AND
-          rddata[t].i = rsdata[t][0].i & rsdata[t][1].i;
-          break;
-        }
-        default:
-          std::abort();
-        }
       }
-    }    
-    rd_write = true;
-    break;
-  }
-  case I_INST: {
-    trace->exe_type = ExeType::ALU;    
-    trace->alu_type = AluType::ARITH;    
-    trace->used_iregs.set(rsrc0);
-    for (uint32_t t = thread_start; t < num_threads; ++t) {
-      if (!tmask_.test(t))
-        continue;
+    } else {
+      auto rs1 = &ireg_file_[rsrc0 * reg_stride_];
+      auto rs2 = &ireg_file_[rsrc1 * reg_stride_];
       switch (func3) {
       case 0: {
-        // RV32I: ADDI
-        rddata[t].i = rsdata[t][0].i + immsrc;
+        if (func7) {
+          // RV32I: SUB
+          alu_lanes(rd_lanes, rs1, rs2, num_lanes, [](Word a, Word b) { return a - b; });
+        } else {
+          // RV32I: ADD
+          alu_lanes(rd_lanes, rs1, rs2, num_lanes, [](Word a, Word b) { return a + b; });
+        }
         break;
       }
       case 1: {
-        // RV64I: SLLI
-        rddata[t].i = rsdata[t][0].i << immsrc;
+        // RV32I: SLL
+        alu_lanes(rd_lanes, rs1, rs2, num_lanes, [](Word a, Word b) { 
+          Word shamt_mask = (Word(1) << log2up(XLEN)) - 1;
+          return a << (b & shamt_mask); 
+        });
         break;
       }
       case 2: {
-        // RV32I: SLTI
-        rddata[t].i = rsdata[t][0].i < WordI(immsrc);
+        // RV32I: SLT
+        alu_lanes(rd_lanes, rs1, rs2, num_lanes, [](Word a, Word b) { return Word(WordI(a) < WordI(b)); });
         break;
       }
       case 3: {
-        // RV32I: SLTIU
-        rddata[t].i = rsdata[t][0].u < immsrc;
+        // RV32I: SLTU
+        alu_lanes(rd_lanes, rs1, rs2, num_lanes, [](Word a, Word b) { return Word(a < b); });
         break;
-      } 
+      }
       case 4: {
-        // RV32I: XORI
-        rddata[t].i = rsdata[t][0].i ^ immsrc;
+        // RV32I: XOR
+        alu_lanes(rd_lanes, rs1, rs2, num_lanes, [](Word a, Word b) { return a ^ b; });
         break;
       }
       case 5: {
         if (func7) {
-          // RV64I: SRAI
-          Word result = rsdata[t][0].i >> immsrc;
-          rddata[t].i = result;
+          // RV32I: SRA
+          alu_lanes(rd_lanes, rs1, rs2, num_lanes, [](Word a, Word b) { 
+            Word shamt_mask = (Word(1) << log2up(XLEN)) - 1;
+            return Word(WordI(a) >> (b & shamt_mask)); 
+          });
         } else {
-          // RV64I: SRLI
-          Word result = rsdata[t][0].u >> immsrc;
-          rddata[t].i = result;
+          // RV32I: SRL
+          alu_lanes(rd_lanes, rs1, rs2, num_lanes, [](Word a, Word b) { 
+            Word shamt_mask = (Word(1) << log2up(XLEN)) - 1;
+            return a >> (b & shamt_mask); 
+          });
         }
         break;
       }
       case 6: {
-        // RV32I: ORI
-        rddata[t].i = rsdata[t][0].i | immsrc;
+        // RV32I: OR
+        alu_lanes(rd_lanes, rs1, rs2, num_lanes, [](Word a, Word b) { return a | b; });
         break;
       }
       case 7: {
-        // RV32I: ANDI
-        rddata[t].i = rsdata[t][0].i & immsrc;
+        // RV32I: AND
+        alu_lanes(rd_lanes, rs1, rs2, num_lanes, [](Word a, Word b) { return a & b; });
         break;
       }
+      default:
+        std::abort();
       }
     }
     rd_write = true;
     break;
   }
+  case I_INST: {
+    trace->exe_type = ExeType::ALU;    
+    trace->alu_type = AluType::ARITH;    
+    trace->used_iregs.set(rsrc0);
+    auto rs1 = &ireg_file_[rsrc0 * reg_stride_];
+    switch (func3) {
+    case 0: {
+      // RV32I: ADDI
+      alu_lanes(rd_lanes, rs1, num_lanes, [&](Word a) { return a + immsrc; });
+      break;
+    }
+    case 1: {
+      // RV64I: SLLI
+      alu_lanes(rd_lanes, rs1, num_lanes, [&](Word a) { return a << immsrc; });
+      break;
+    }
+    case 2: {
+      // RV32I: SLTI
+      alu_lanes(rd_lanes, rs1, num_lanes, [&](Word a) { return Word(WordI(a) < WordI(immsrc)); });
+      break;
+    }
+    case 3: {
+      // RV32I: SLTIU
+      alu_lanes(rd_lanes, rs1, num_lanes, [&](Word a) { return Word(a < immsrc); });
+      break;
+    } 
+    case 4: {
+      // RV32I: XORI
+      alu_lanes(rd_lanes, rs1, num_lanes, [&](Word a) { return a ^ immsrc; });
+      break;
+    }
+    case 5: {
+      if (func7) {
+        // RV64I: SRAI
+        alu_lanes(rd_lanes, rs1, num_lanes, [&](Word a) { return Word(WordI(a) >> immsrc); });
+      } else {
+        // RV64I: SRLI
+        alu_lanes(rd_lanes, rs1, num_lanes, [&](Word a) { return a >> immsrc; });
+      }
+      break;
+    }
+    case 6: {
+      // RV32I: ORI
+      alu_lanes(rd_lanes, rs1, num_lanes, [&](Word a) { return a | immsrc; });
+      break;
+    }
+    case 7: {
+      // RV32I: ANDI
+      alu_lanes(rd_lanes, rs1, num_lanes, [&](Word a) { return a & immsrc; });
+      break;
+    }
+    }
+    rd_write = true;
+    break;
+  }
   case R_INST_W: {
     trace->exe_type = ExeType::ALU;    
     trace->alu_type = AluType::ARITH;
@@ -397,15 +458,15 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         switch (func3) {
           case 0: {
             // RV64M: MULW
-            int32_t product = (int32_t)rsdata[t][0].i * (int32_t)rsdata[t][1].i;
+            int32_t product = (int32_t)rsdata[0][t].i * (int32_t)rsdata[1][t].i;
             rddata[t].i = sext((uint64_t)product, 32);
             trace->alu_type = AluType::IMUL;
             break;
           }
           case 4: {
             // RV64M: DIVW
-            int32_t dividen = (int32_t)rsdata[t][0].i;
-            int32_t divisor = (int32_t)rsdata[t][1].i;
+            int32_t dividen = (int32_t)rsdata[0][t].i;
+            int32_t divisor = (int32_t)rsdata[1][t].i;
             int32_t quotient;
             int32_t largest_negative = 0x80000000;
             if (divisor == 0){
@@ -421,8 +482,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
           }      
           case 5: {
             // RV64M: DIVUW
-            uint32_t dividen = (uint32_t)rsdata[t][0].i;
-            uint32_t divisor = (uint32_t)rsdata[t][1].i;
+            uint32_t dividen = (uint32_t)rsdata[0][t].i;
+            uint32_t divisor = (uint32_t)rsdata[1][t].i;
             uint32_t quotient;
             if (divisor == 0){
               quotient = -1;
@@ -435,8 +496,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
           } 
           case 6: {
             // RV64M: REMW
-            int32_t dividen = (uint32_t)rsdata[t][0].i;
-            int32_t divisor = (uint32_t)rsdata[t][1].i;
+            int32_t dividen = (uint32_t)rsdata[0][t].i;
+            int32_t divisor = (uint32_t)rsdata[1][t].i;
             int32_t remainder;
             int32_t largest_negative = 0x80000000;
             if (divisor == 0){
@@ -452,8 +513,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
           }  
           case 7: {
             // RV64M: REMUW
-            uint32_t dividen = (uint32_t)rsdata[t][0].i;
-            uint32_t divisor = (uint32_t)rsdata[t][1].i;
+            uint32_t dividen = (uint32_t)rsdata[0][t].i;
+            uint32_t divisor = (uint32_t)rsdata[1][t].i;
             uint32_t remainder;
             if (divisor == 0){
               remainder = dividen;
@@ -472,12 +533,12 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         case 0: {
           if (func7){
             // RV64I: SUBW
-            uint32_t result = (uint32_t)rsdata[t][0].i - (uint32_t)rsdata[t][1].i;
+            uint32_t result = (uint32_t)rsdata[0][t].i - (uint32_t)rsdata[1][t].i;
             rddata[t].i = sext((uint64_t)result, 32);
           }
           else{
             // RV64I: ADDW
-            uint32_t result = (uint32_t)rsdata[t][0].i + (uint32_t)rsdata[t][1].i;
+            uint32_t result = (uint32_t)rsdata[0][t].i + (uint32_t)rsdata[1][t].i;
             rddata[t].i = sext((uint64_t)result, 32);
           }    
           break;
@@ -485,21 +546,21 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         case 1: {
           // RV64I: SLLW
           uint32_t shamt_mask = 0x1F;
-          uint32_t shamt = rsdata[t][1].i & shamt_mask;
-          uint32_t result = (uint32_t)rsdata[t][0].i << shamt;
+          uint32_t shamt = rsdata[1][t].i & shamt_mask;
+          uint32_t result = (uint32_t)rsdata[0][t].i << shamt;
           rddata[t].i = sext((uint64_t)result, 32);
           break;
         }
         case 5: {
           uint32_t shamt_mask = 0x1F;
-          uint32_t shamt = rsdata[t][1].i & shamt_mask;
+          uint32_t shamt = rsdata[1][t].i & shamt_mask;
           uint32_t result;
           if (func7) {
             // RV64I: SRAW
-            result = (int32_t)rsdata[t][0].i >> shamt;
+            result = (int32_t)rsdata[0][t].i >> shamt;
           } else {
             // RV64I: SRLW
-            result = (uint32_t)rsdata[t][0].i >> shamt;
+            result = (uint32_t)rsdata[0][t].i >> shamt;
           }
           rddata[t].i = sext((uint64_t)result, 32);
           break;
@@ -522,7 +583,7 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
       switch (func3) {
         case 0: {
           // RV64I: ADDIW
-          uint32_t result = (uint32_t)rsdata[t][0].i + (uint32_t)immsrc;
+          uint32_t result = (uint32_t)rsdata[0][t].i + (uint32_t)immsrc;
           rddata[t].i = sext((uint64_t)result, 32);
           break;
         }
@@ -530,7 +591,7 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
           // RV64I: SLLIW
           uint32_t shamt_mask = 0x1F;
           uint32_t shamt = immsrc & shamt_mask;
-          uint32_t result = rsdata[t][0].i << shamt;
+          uint32_t result = rsdata[0][t].i << shamt;
           rddata[t].i = sext((uint64_t)result, 32);
           break;
         }  
@@ -540,10 +601,10 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
           uint32_t result;
           if (func7) {
             // RV64I: SRAIW
-            result = (int32_t)rsdata[t][0].i >> shamt;
+            result = (int32_t)rsdata[0][t].i >> shamt;
           } else {
             // RV64I: SRLIW
-            result = (uint32_t)rsdata[t][0].i >> shamt;
+            result = (uint32_t)rsdata[0][t].i >> shamt;
           }
           rddata[t].i = sext((uint64_t)result, 32);
           break;
@@ -566,42 +627,42 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
       switch (func3) {
       case 0: {
         // RV32I: BEQ
-        if (rsdata[t][0].i == rsdata[t][1].i) {
+        if (rsdata[0][t].i == rsdata[1][t].i) {
           next_pc = PC_ + immsrc;
         }
         break;
       }
       case 1: {
         // RV32I: BNE
-        if (rsdata[t][0].i != rsdata[t][1].i) {
+        if (rsdata[0][t].i != rsdata[1][t].i) {
           next_pc = PC_ + immsrc;
         }
         break;
       }
       case 4: {
         // RV32I: BLT
-        if (rsdata[t][0].i < rsdata[t][1].i) {
+        if (rsdata[0][t].i < rsdata[1][t].i) {
           next_pc = PC_ + immsrc;
         }
         break;
       }
       case 5: {
         // RV32I: BGE
-        if (rsdata[t][0].i >= rsdata[t][1].i) {
+        if (rsdata[0][t].i >= rsdata[1][t].i) {
           next_pc = PC_ + immsrc;
         }
         break;
       }
       case 6: {
         // RV32I: BLTU
-        if (rsdata[t][0].u < rsdata[t][1].u) {
+        if (rsdata[0][t].u < rsdata[1][t].u) {
           next_pc = PC_ + immsrc;
         }
         break;
       }
       case 7: {
         // RV32I: BGEU
-        if (rsdata[t][0].u >= rsdata[t][1].u) {
+        if (rsdata[0][t].u >= rsdata[1][t].u) {
           next_pc = PC_ + immsrc;
         }
         break;
@@ -638,7 +699,7 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         continue;
       rddata[t].i = next_pc;
     }
-    next_pc = rsdata[thread_start][0].i + immsrc;
+    next_pc = rsdata[0][thread_start].i + immsrc;
     trace->fetch_stall = true;
     rd_write = true;
     break;
@@ -648,8 +709,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
     trace->exe_type = ExeType::LSU;    
     trace->lsu_type = LsuType::LOAD;
     trace->used_iregs.set(rsrc0);
-    auto trace_data = std::make_shared<LsuTraceData>(num_threads);
-    trace->data = trace_data;
+    auto trace_data = &trace->data.lsu;
+    std::fill_n(trace_data->mem_addrs, num_threads, mem_addr_size_t{0, 0});
     if ((opcode == L_INST )
      || (opcode == FL && func3 == 2)
      || (opcode == FL && func3 == 3)) {
@@ -658,10 +719,10 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
       for (uint32_t t = thread_start; t < num_threads; ++t) {
         if (!tmask_.test(t))
           continue;
-        uint64_t mem_addr = rsdata[t][0].i + immsrc;         
+        uint64_t mem_addr = rsdata[0][t].i + immsrc;         
         uint64_t read_data = 0;
         core_->dcache_read(&read_data, mem_addr, data_bytes);
-        trace_data->mem_addrs.at(t) = {mem_addr, data_bytes};
+        trace_data->mem_addrs[t] = {mem_addr, data_bytes};
         switch (func3) {
         case 0: // RV32I: LB
         case 1: // RV32I: LH
@@ -692,7 +753,7 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
       switch (instr.getVlsWidth()) {
       case 6: {
         for (uint32_t i = 0; i < vl_; i++) {
-          Word mem_addr = ((rsdata[i][0].i) & 0xFFFFFFFC) + (i * vtype_.vsew / 8);
+          Word mem_addr = ((rsdata[0][i].i) & 0xFFFFFFFC) + (i * vtype_.vsew / 8);
           Word mem_data = 0;
           core_->dcache_read(&mem_data, mem_addr, 4);
           Word *result_ptr = (Word *)(vd.data() + i);
@@ -713,8 +774,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
     trace->lsu_type = LsuType::STORE;
     trace->used_iregs.set(rsrc0);
     trace->used_iregs.set(rsrc1);    
-    auto trace_data = std::make_shared<LsuTraceData>(num_threads);
-    trace->data = trace_data;
+    auto trace_data = &trace->data.lsu;
+    std::fill_n(trace_data->mem_addrs, num_threads, mem_addr_size_t{0, 0});
     if ((opcode == S_INST)
      || (opcode == FS && func3 == 2)
      || (opcode == FS && func3 == 3)) {
@@ -722,9 +783,9 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
       for (uint32_t t = thread_start; t < num_threads; ++t) {
         if (!tmask_.test(t))
           continue;
-        uint64_t mem_addr = rsdata[t][0].i + immsrc;
-        uint64_t write_data = rsdata[t][1].u64;
-        trace_data->mem_addrs.at(t) = {mem_addr, data_bytes};
+        uint64_t mem_addr = rsdata[0][t].i + immsrc;
+        uint64_t write_data = rsdata[1][t].u64;
+        trace_data->mem_addrs[t] = {mem_addr, data_bytes};
         switch (func3) {
         case 0:
         case 1:
@@ -738,7 +799,7 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
       }
     } else {
       for (uint32_t i = 0; i < vl_; i++) {
-        uint64_t mem_addr = rsdata[i][0].i + (i * vtype_.vsew / 8);        
+        uint64_t mem_addr = rsdata[0][i].i + (i * vtype_.vsew / 8);        
         switch (instr.getVlsWidth()) {
         case 6: {
           // store word and unit strided (not checking for unit stride)          
@@ -758,16 +819,16 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
     trace->lsu_type = LsuType::LOAD;
     trace->used_iregs.set(rsrc0);
     trace->used_iregs.set(rsrc1);
-    auto trace_data = std::make_shared<LsuTraceData>(num_threads);
-    trace->data = trace_data;
+    auto trace_data = &trace->data.lsu;
+    std::fill_n(trace_data->mem_addrs, num_threads, mem_addr_size_t{0, 0});
     auto amo_type = func7 >> 2;
     uint32_t data_bytes = 1 << (func3 & 0x3);
     uint32_t data_width = 8 * data_bytes;
     for (uint32_t t = thread_start; t < num_threads; ++t) {
       if (!tmask_.test(t))
         continue;
-      uint64_t mem_addr = rsdata[t][0].u;
-      trace_data->mem_addrs.at(t) = {mem_addr, data_bytes};
+      uint64_t mem_addr = rsdata[0][t].u;
+      trace_data->mem_addrs[t] = {mem_addr, data_bytes};
       if (amo_type == 0x02) { // LR
         uint64_t read_data = 0;
         core_->dcache_read(&read_data, mem_addr, data_bytes);        
@@ -776,7 +837,7 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
       } else 
       if (amo_type == 0x03) { // SC
         if (core_->dcache_amo_check(mem_addr)) {
-          core_->dcache_write(&rsdata[t][1].u64, mem_addr, data_bytes);
+          core_->dcache_write(&rsdata[1][t].u64, mem_addr, data_bytes);
           rddata[t].i = 0;
         } else {
           rddata[t].i = 1;
@@ -785,9 +846,9 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         uint64_t read_data = 0;
         core_->dcache_read(&read_data, mem_addr, data_bytes);
         auto read_data_i = sext((WordI)read_data, data_width);        
-        auto rs1_data_i  = sext((WordI)rsdata[t][1].u64, data_width);
+        auto rs1_data_i  = sext((WordI)rsdata[1][t].u64, data_width);
         auto read_data_u = zext((Word)read_data, data_width);
-        auto rs1_data_u  = zext((Word)rsdata[t][1].u64, data_width);
+        auto rs1_data_u  = zext((Word)rsdata[1][t].u64, data_width);
         uint64_t result;
         switch (amo_type) {
         case 0x00:  // AMOADD
@@ -861,7 +922,7 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         case 1: {
           // RV32I: CSRRW
           rddata[t].i = csr_value;
-          core_->set_csr(csr_addr, rsdata[t][0].i, t, warp_id_);      
+          core_->set_csr(csr_addr, rsdata[0][t].i, t, warp_id_);      
           trace->used_iregs.set(rsrc0);
           trace->sfu_type = SfuType::CSRRW;
           rd_write = true;
@@ -870,8 +931,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         case 2: {
           // RV32I: CSRRS
           rddata[t].i = csr_value;
-          if (rsdata[t][0].i != 0) {
-            core_->set_csr(csr_addr, csr_value | rsdata[t][0].i, t, warp_id_);
+          if (rsdata[0][t].i != 0) {
+            core_->set_csr(csr_addr, csr_value | rsdata[0][t].i, t, warp_id_);
           }
           trace->used_iregs.set(rsrc0);
           trace->sfu_type = SfuType::CSRRS;
@@ -881,8 +942,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         case 3: {
           // RV32I: CSRRC
           rddata[t].i = csr_value;
-          if (rsdata[t][0].i != 0) {
-            core_->set_csr(csr_addr, csr_value & ~rsdata[t][0].i, t, warp_id_);
+          if (rsdata[0][t].i != 0) {
+            core_->set_csr(csr_addr, csr_value & ~rsdata[0][t].i, t, warp_id_);
           }
           trace->used_iregs.set(rsrc0);
           trace->sfu_type = SfuType::CSRRC;
@@ -932,63 +993,77 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
   }
   case FCI: {     
     trace->exe_type = ExeType::FPU;     
+    // RNE single-precision arithmetic runs on the host FPU where exact;
+    // narrow warps do not amortize the lane classification
+    ThreadMask soft_lanes = tmask_;
+    if (num_threads >= SIMD_LANES
+     && (func7 == 0x00 || func7 == 0x04 || func7 == 0x08 || func7 == 0x0c)
+     && get_fpu_rm(func3, core_, thread_start, warp_id_) == 0) {
+      static const uint32_t fops[] = {RV_FOP_ADD, RV_FOP_SUB, RV_FOP_MUL, RV_FOP_DIV};
+      uint32_t fflags = 0;
+      soft_lanes = fop_s_lanes(fops[func7 >> 2], rsdata, rddata, tmask_, num_threads, &fflags);
+      update_fcrs(fflags, core_, thread_start, warp_id_);
+      trace->fpu_type = (func7 == 0x0c) ? FpuType::FDIV : FpuType::FMA;
+      trace->used_fregs.set(rsrc0);
+      trace->used_fregs.set(rsrc1);
+    }
     for (uint32_t t = thread_start; t < num_threads; ++t) {
-      if (!tmask_.test(t))
+      if (!soft_lanes.test(t))
         continue; 
       uint32_t frm = get_fpu_rm(func3, core_, t, warp_id_);
       uint32_t fflags = 0;
       switch (func7) {
       case 0x00: { // RV32F: FADD.S
-        rddata[t].u64 = nan_box(rv_fadd_s(check_boxing(rsdata[t][0].u64), check_boxing(rsdata[t][1].u64), frm, &fflags));
+        rddata[t].u64 = nan_box(rv_fadd_s(check_boxing(rsdata[0][t].u64), check_boxing(rsdata[1][t].u64), frm, &fflags));
         trace->fpu_type = FpuType::FMA;
         trace->used_fregs.set(rsrc0);
         trace->used_fregs.set(rsrc1);
         break;
       }
       case 0x01: { // RV32D: FADD.D
-        rddata[t].u64 = rv_fadd_d(rsdata[t][0].u64, rsdata[t][1].u64, frm, &fflags);
+        rddata[t].u64 = rv_fadd_d(rsdata[0][t].u64, rsdata[1][t].u64, frm, &fflags);
         trace->fpu_type = FpuType::FMA;
         trace->used_fregs.set(rsrc0);
         trace->used_fregs.set(rsrc1);
         break;
       }
       case 0x04: { // RV32F: FSUB.S
-        rddata[t].u64 = nan_box(rv_fsub_s(check_boxing(rsdata[t][0].u64), check_boxing(rsdata[t][1].u64), frm, &fflags));
+        rddata[t].u64 = nan_box(rv_fsub_s(check_boxing(rsdata[0][t].u64), check_boxing(rsdata[1][t].u64), frm, &fflags));
         trace->fpu_type = FpuType::FMA;
         trace->used_fregs.set(rsrc0);
         trace->used_fregs.set(rsrc1);
         break;
       }
       case 0x05: { // RV32D: FSUB.D
-        rddata[t].u64 = rv_fsub_d(rsdata[t][0].u64, rsdata[t][1].u64, frm, &fflags);
+        rddata[t].u64 = rv_fsub_d(rsdata[0][t].u64, rsdata[1][t].u64, frm, &fflags);
         trace->fpu_type = FpuType::FMA;
         trace->used_fregs.set(rsrc0);
         trace->used_fregs.set(rsrc1);
         break;
       }
       case 0x08: { // RV32F: FMUL.S
-        rddata[t].u64 = nan_box(rv_fmul_s(check_boxing(rsdata[t][0].u64), check_boxing(rsdata[t][1].u64), frm, &fflags));
+        rddata[t].u64 = nan_box(rv_fmul_s(check_boxing(rsdata[0][t].u64), check_boxing(rsdata[1][t].u64), frm, &fflags));
         trace->fpu_type = FpuType::FMA;
         trace->used_fregs.set(rsrc0);
         trace->used_fregs.set(rsrc1);
         break;
       }
       case 0x09: { // RV32D: FMUL.D
-        rddata[t].u64 = rv_fmul_d(rsdata[t][0].u64, rsdata[t][1].u64, frm, &fflags);
+        rddata[t].u64 = rv_fmul_d(rsdata[0][t].u64, rsdata[1][t].u64, frm, &fflags);
         trace->fpu_type = FpuType::FMA;
         trace->used_fregs.set(rsrc0);
         trace->used_fregs.set(rsrc1);
         break;
       }
       case 0x0c: { // RV32F: FDIV.S
-        rddata[t].u64 = nan_box(rv_fdiv_s(check_boxing(rsdata[t][0].u64), check_boxing(rsdata[t][1].u64), frm, &fflags));
+        rddata[t].u64 = nan_box(rv_fdiv_s(check_boxing(rsdata[0][t].u64), check_boxing(rsdata[1][t].u64), frm, &fflags));
         trace->fpu_type = FpuType::FDIV;
         trace->used_fregs.set(rsrc0);
         trace->used_fregs.set(rsrc1);
         break;
       }
       case 0x0d: { // RV32D: FDIV.D
-        rddata[t].u64 = rv_fdiv_d(rsdata[t][0].u64, rsdata[t][1].u64, frm, &fflags);
+        rddata[t].u64 = rv_fdiv_d(rsdata[0][t].u64, rsdata[1][t].u64, frm, &fflags);
         trace->fpu_type = FpuType::FDIV;
         trace->used_fregs.set(rsrc0);
         trace->used_fregs.set(rsrc1);
@@ -997,13 +1072,13 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
       case 0x10: {
         switch (func3) {            
         case 0: // RV32F: FSGNJ.S
-          rddata[t].u64 = nan_box(rv_fsgnj_s(check_boxing(rsdata[t][0].u64), check_boxing(rsdata[t][1].u64)));
+          rddata[t].u64 = nan_box(rv_fsgnj_s(check_boxing(rsdata[0][t].u64), check_boxing(rsdata[1][t].u64)));
           break;          
         case 1: // RV32F: FSGNJN.S
-          rddata[t].u64 = nan_box(rv_fsgnjn_s(check_boxing(rsdata[t][0].u64), check_boxing(rsdata[t][1].u64)));
+          rddata[t].u64 = nan_box(rv_fsgnjn_s(check_boxing(rsdata[0][t].u64), check_boxing(rsdata[1][t].u64)));
           break;          
         case 2: // RV32F: FSGNJX.S
-          rddata[t].u64 = nan_box(rv_fsgnjx_s(check_boxing(rsdata[t][0].u64), check_boxing(rsdata[t][1].u64)));
+          rddata[t].u64 = nan_box(rv_fsgnjx_s(check_boxing(rsdata[0][t].u64), check_boxing(rsdata[1][t].u64)));
           break;
         }
         trace->fpu_type = FpuType::FNCP;
@@ -1014,13 +1089,13 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
       case 0x11: {
         switch (func3) {            
         case 0: // RV32D: FSGNJ.D
-          rddata[t].u64 = rv_fsgnj_d(rsdata[t][0].u64, rsdata[t][1].u64);
+          rddata[t].u64 = rv_fsgnj_d(rsdata[0][t].u64, rsdata[1][t].u64);
           break;          
         case 1: // RV32D: FSGNJN.D
-          rddata[t].u64 = rv_fsgnjn_d(rsdata[t][0].u64, rsdata[t][1].u64);
+          rddata[t].u64 = rv_fsgnjn_d(rsdata[0][t].u64, rsdata[1][t].u64);
           break;          
         case 2: // RV32D: FSGNJX.D
-          rddata[t].u64 = rv_fsgnjx_d(rsdata[t][0].u64, rsdata[t][1].u64);
+          rddata[t].u64 = rv_fsgnjx_d(rsdata[0][t].u64, rsdata[1][t].u64);
           break;
         }
         trace->fpu_type = FpuType::FNCP;
@@ -1031,10 +1106,10 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
       case 0x14: {   
         if (func3) {
           // RV32F: FMAX.S
-          rddata[t].u64 = nan_box(rv_fmax_s(check_boxing(rsdata[t][0].u64), check_boxing(rsdata[t][1].u64), &fflags));
+          rddata[t].u64 = nan_box(rv_fmax_s(check_boxing(rsdata[0][t].u64), check_boxing(rsdata[1][t].u64), &fflags));
         } else {
           // RV32F: FMIN.S
-          rddata[t].u64 = nan_box(rv_fmin_s(check_boxing(rsdata[t][0].u64), check_boxing(rsdata[t][1].u64), &fflags));
+          rddata[t].u64 = nan_box(rv_fmin_s(check_boxing(rsdata[0][t].u64), check_boxing(rsdata[1][t].u64), &fflags));
         }
         trace->fpu_type = FpuType::FNCP;
         trace->used_fregs.set(rsrc0);
@@ -1044,10 +1119,10 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
       case 0x15: {            
         if (func3) {
           // RV32D: FMAX.D
-          rddata[t].u64 = rv_fmax_d(rsdata[t][0].u64, rsdata[t][1].u64, &fflags);
+          rddata[t].u64 = rv_fmax_d(rsdata[0][t].u64, rsdata[1][t].u64, &fflags);
         } else {
           // RV32D: FMIN.D
-          rddata[t].u64 = rv_fmin_d(rsdata[t][0].u64, rsdata[t][1].u64, &fflags);
+          rddata[t].u64 = rv_fmin_d(rsdata[0][t].u64, rsdata[1][t].u64, &fflags);
         }
         trace->fpu_type = FpuType::FNCP;
         trace->used_fregs.set(rsrc0);
@@ -1056,7 +1131,7 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
       }
       case 0x20: {
         // RV32D: FCVT.S.D
-        rddata[t].u64 = nan_box(rv_dtof(rsdata[t][0].u64));
+        rddata[t].u64 = nan_box(rv_dtof(rsdata[0][t].u64));
         trace->fpu_type = FpuType::FNCP;
         trace->used_fregs.set(rsrc0);
         trace->used_fregs.set(rsrc1);        
@@ -1064,20 +1139,20 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
       }
       case 0x21: {
         // RV32D: FCVT.D.S
-        rddata[t].u64 = rv_ftod(check_boxing(rsdata[t][0].u64));
+        rddata[t].u64 = rv_ftod(check_boxing(rsdata[0][t].u64));
         trace->fpu_type = FpuType::FNCP;
         trace->used_fregs.set(rsrc0);
         trace->used_fregs.set(rsrc1);        
         break;
       }
       case 0x2c: { // RV32F: FSQRT.S
-        rddata[t].u64 = nan_box(rv_fsqrt_s(check_boxing(rsdata[t][0].u64), frm, &fflags));
+        rddata[t].u64 = nan_box(rv_fsqrt_s(check_boxing(rsdata[0][t].u64), frm, &fflags));
         trace->fpu_type = FpuType::FSQRT;
         trace->used_fregs.set(rsrc0);
         break;
       }
       case 0x2d: { // RV32D: FSQRT.D
-        rddata[t].u64 = rv_fsqrt_d(rsdata[t][0].u64, frm, &fflags);
+        rddata[t].u64 = rv_fsqrt_d(rsdata[0][t].u64, frm, &fflags);
         trace->fpu_type = FpuType::FSQRT;
         trace->used_fregs.set(rsrc0);
         break;  
@@ -1086,15 +1161,15 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         switch (func3) {              
         case 0:
           // RV32F: FLE.S
-          rddata[t].i = rv_fle_s(check_boxing(rsdata[t][0].u64), check_boxing(rsdata[t][1].u64), &fflags);    
+          rddata[t].i = rv_fle_s(check_boxing(rsdata[0][t].u64), check_boxing(rsdata[1][t].u64), &fflags);    
           break;              
         case 1:
           // RV32F: FLT.S
-          rddata[t].i = rv_flt_s(check_boxing(rsdata[t][0].u64), check_boxing(rsdata[t][1].u64), &fflags);
+          rddata[t].i = rv_flt_s(check_boxing(rsdata[0][t].u64), check_boxing(rsdata[1][t].u64), &fflags);
           break;              
         case 2:
           // RV32F: FEQ.S
-          rddata[t].i = rv_feq_s(check_boxing(rsdata[t][0].u64), check_boxing(rsdata[t][1].u64), &fflags);
+          rddata[t].i = rv_feq_s(check_boxing(rsdata[0][t].u64), check_boxing(rsdata[1][t].u64), &fflags);
           break;
         } 
         trace->fpu_type = FpuType::FNCP;
@@ -1106,15 +1181,15 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         switch (func3) {              
         case 0:
           // RV32D: FLE.D
-          rddata[t].i = rv_fle_d(rsdata[t][0].u64, rsdata[t][1].u64, &fflags);    
+          rddata[t].i = rv_fle_d(rsdata[0][t].u64, rsdata[1][t].u64, &fflags);    
           break;              
         case 1:
           // RV32D: FLT.D
-          rddata[t].i = rv_flt_d(rsdata[t][0].u64, rsdata[t][1].u64, &fflags);
+          rddata[t].i = rv_flt_d(rsdata[0][t].u64, rsdata[1][t].u64, &fflags);
           break;              
         case 2:
           // RV32D: FEQ.D
-          rddata[t].i = rv_feq_d(rsdata[t][0].u64, rsdata[t][1].u64, &fflags);
+          rddata[t].i = rv_feq_d(rsdata[0][t].u64, rsdata[1][t].u64, &fflags);
           break;
         } 
         trace->fpu_type = FpuType::FNCP;
@@ -1126,19 +1201,19 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         switch (rsrc1) {
         case 0: 
           // RV32F: FCVT.W.S
-          rddata[t].i = sext((uint64_t)rv_ftoi_s(check_boxing(rsdata[t][0].u64), frm, &fflags), 32);
+          rddata[t].i = sext((uint64_t)rv_ftoi_s(check_boxing(rsdata[0][t].u64), frm, &fflags), 32);
           break;
         case 1:
           // RV32F: FCVT.WU.S
-          rddata[t].i = sext((uint64_t)rv_ftou_s(check_boxing(rsdata[t][0].u64), frm, &fflags), 32);
+          rddata[t].i = sext((uint64_t)rv_ftou_s(check_boxing(rsdata[0][t].u64), frm, &fflags), 32);
           break;
         case 2:
           // RV64F: FCVT.L.S
-          rddata[t].i = rv_ftol_s(check_boxing(rsdata[t][0].u64), frm, &fflags);
+          rddata[t].i = rv_ftol_s(check_boxing(rsdata[0][t].u64), frm, &fflags);
           break;
         case 3:
           // RV64F: FCVT.LU.S
-          rddata[t].i = rv_ftolu_s(check_boxing(rsdata[t][0].u64), frm, &fflags);
+          rddata[t].i = rv_ftolu_s(check_boxing(rsdata[0][t].u64), frm, &fflags);
           break;
         }
         trace->fpu_type = FpuType::FCVT;
@@ -1149,19 +1224,19 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         switch (rsrc1) {
         case 0: 
           // RV32D: FCVT.W.D
-          rddata[t].i = sext((uint64_t)rv_ftoi_d(rsdata[t][0].u64, frm, &fflags), 32);
+          rddata[t].i = sext((uint64_t)rv_ftoi_d(rsdata[0][t].u64, frm, &fflags), 32);
           break;
         case 1:
           // RV32D: FCVT.WU.D
-          rddata[t].i = sext((uint64_t)rv_ftou_d(rsdata[t][0].u64, frm, &fflags), 32);
+          rddata[t].i = sext((uint64_t)rv_ftou_d(rsdata[0][t].u64, frm, &fflags), 32);
           break;
         case 2:
           // RV64D: FCVT.L.D
-          rddata[t].i = rv_ftol_d(rsdata[t][0].u64, frm, &fflags);
+          rddata[t].i = rv_ftol_d(rsdata[0][t].u64, frm, &fflags);
           break;
         case 3:
           // RV64D: FCVT.LU.D
-          rddata[t].i = rv_ftolu_d(rsdata[t][0].u64, frm, &fflags);
+          rddata[t].i = rv_ftolu_d(rsdata[0][t].u64, frm, &fflags);
           break;
         }
         trace->fpu_type = FpuType::FCVT;
@@ -1172,19 +1247,19 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         switch (rsrc1) {
         case 0: 
           // RV32F: FCVT.S.W
-          rddata[t].u64 = nan_box(rv_itof_s(rsdata[t][0].i, frm, &fflags));
+          rddata[t].u64 = nan_box(rv_itof_s(rsdata[0][t].i, frm, &fflags));
           break;
         case 1:
           // RV32F: FCVT.S.WU
-          rddata[t].u64 = nan_box(rv_utof_s(rsdata[t][0].i, frm, &fflags));
+          rddata[t].u64 = nan_box(rv_utof_s(rsdata[0][t].i, frm, &fflags));
           break;
         case 2:
           // RV64F: FCVT.S.L
-          rddata[t].u64 = nan_box(rv_ltof_s(rsdata[t][0].i, frm, &fflags));
+          rddata[t].u64 = nan_box(rv_ltof_s(rsdata[0][t].i, frm, &fflags));
           break;
         case 3:
           // RV64F: FCVT.S.LU
-          rddata[t].u64 = nan_box(rv_lutof_s(rsdata[t][0].i, frm, &fflags));
+          rddata[t].u64 = nan_box(rv_lutof_s(rsdata[0][t].i, frm, &fflags));
           break;
         }
         trace->fpu_type = FpuType::FCVT;
@@ -1195,19 +1270,19 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         switch (rsrc1) {
         case 0: 
           // RV32D: FCVT.D.W
-          rddata[t].u64 = rv_itof_d(rsdata[t][0].i, frm, &fflags);
+          rddata[t].u64 = rv_itof_d(rsdata[0][t].i, frm, &fflags);
           break;
         case 1:
           // RV32D: FCVT.D.WU
-          rddata[t].u64 = rv_utof_d(rsdata[t][0].i, frm, &fflags);
+          rddata[t].u64 = rv_utof_d(rsdata[0][t].i, frm, &fflags);
           break;
         case 2:
           // RV64D: FCVT.D.L
-          rddata[t].u64 = rv_ltof_d(rsdata[t][0].i, frm, &fflags);
+          rddata[t].u64 = rv_ltof_d(rsdata[0][t].i, frm, &fflags);
           break;
         case 3:
           // RV64D: FCVT.D.LU
-          rddata[t].u64 = rv_lutof_d(rsdata[t][0].i, frm, &fflags);
+          rddata[t].u64 = rv_lutof_d(rsdata[0][t].i, frm, &fflags);
           break;
         }
         trace->fpu_type = FpuType::FCVT;
@@ -1217,10 +1292,10 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
       case 0x70: {     
         if (func3) {
           // RV32F: FCLASS.S
-          rddata[t].i = rv_fclss_s(check_boxing(rsdata[t][0].u64));
+          rddata[t].i = rv_fclss_s(check_boxing(rsdata[0][t].u64));
         } else {          
           // RV32F: FMV.X.S
-          uint32_t result = (uint32_t)rsdata[t][0].u64;
+          uint32_t result = (uint32_t)rsdata[0][t].u64;
           rddata[t].i = sext((uint64_t)result, 32);
         }        
         trace->fpu_type = FpuType::FNCP;
@@ -1230,23 +1305,23 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
       case 0x71: {    
         if (func3) {
           // RV32D: FCLASS.D
-          rddata[t].i = rv_fclss_d(rsdata[t][0].u64);
+          rddata[t].i = rv_fclss_d(rsdata[0][t].u64);
         } else {          
           // RV64D: FMV.X.D
-          rddata[t].i = rsdata[t][0].u64;
+          rddata[t].i = rsdata[0][t].u64;
         }        
         trace->fpu_type = FpuType::FNCP;
         trace->used_fregs.set(rsrc0);
         break;
       }
       case 0x78: { // RV32F: FMV.S.X
-        rddata[t].u64 = nan_box((uint32_t)rsdata[t][0].i);
+        rddata[t].u64 = nan_box((uint32_t)rsdata[0][t].i);
         trace->fpu_type = FpuType::FNCP;
         trace->used_iregs.set(rsrc0);
         break;
       }
       case 0x79: { // RV64D: FMV.D.X
-        rddata[t].u64 = rsdata[t][0].i;
+        rddata[t].u64 = rsdata[0][t].i;
         trace->fpu_type = FpuType::FNCP;
         trace->used_iregs.set(rsrc0);
         break;
@@ -1265,8 +1340,18 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
     trace->used_fregs.set(rsrc0);
     trace->used_fregs.set(rsrc1);
     trace->used_fregs.set(rsrc2);
+    ThreadMask soft_lanes = tmask_;
+    if (num_threads >= SIMD_LANES && !func2 
+     && get_fpu_rm(func3, core_, thread_start, warp_id_) == 0) {
+      uint32_t fop = (opcode == FMADD) ? RV_FOP_MADD :
+                     (opcode == FMSUB) ? RV_FOP_MSUB :
+                     (opcode == FMNMADD) ? RV_FOP_NMADD : RV_FOP_NMSUB;
+      uint32_t fflags = 0;
+      soft_lanes = fop_s_lanes(fop, rsdata, rddata, tmask_, num_threads, &fflags);
+      update_fcrs(fflags, core_, thread_start, warp_id_);
+    }
     for (uint32_t t = thread_start; t < num_threads; ++t) {
-      if (!tmask_.test(t))
+      if (!soft_lanes.test(t))
         continue;
       uint32_t frm = get_fpu_rm(func3, core_, t, warp_id_);
       uint32_t fflags = 0;
@@ -1274,34 +1359,34 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
       case FMADD:
         if (func2)
           // RV32D: FMADD.D
-          rddata[t].u64 = rv_fmadd_d(rsdata[t][0].u64, rsdata[t][1].u64, rsdata[t][2].u64, frm, &fflags);
+          rddata[t].u64 = rv_fmadd_d(rsdata[0][t].u64, rsdata[1][t].u64, rsdata[2][t].u64, frm, &fflags);
         else
           // RV32F: FMADD.S
-          rddata[t].u64 = nan_box(rv_fmadd_s(check_boxing(rsdata[t][0].u64), check_boxing(rsdata[t][1].u64), check_boxing(rsdata[t][2].u64), frm, &fflags));
+          rddata[t].u64 = nan_box(rv_fmadd_s(check_boxing(rsdata[0][t].u64), check_boxing(rsdata[1][t].u64), check_boxing(rsdata[2][t].u64), frm, &fflags));
         break;
       case FMSUB:
         if (func2)
           // RV32D: FMSUB.D
-          rddata[t].u64 = rv_fmsub_d(rsdata[t][0].u64, rsdata[t][1].u64, rsdata[t][2].u64, frm, &fflags);
+          rddata[t].u64 = rv_fmsub_d(rsdata[0][t].u64, rsdata[1][t].u64, rsdata[2][t].u64, frm, &fflags);
         else 
           // RV32F: FMSUB.S
-          rddata[t].u64 = nan_box(rv_fmsub_s(check_boxing(rsdata[t][0].u64), check_boxing(rsdata[t][1].u64), check_boxing(rsdata[t][2].u64), frm, &fflags));
+          rddata[t].u64 = nan_box(rv_fmsub_s(check_boxing(rsdata[0][t].u64), check_boxing(rsdata[1][t].u64), check_boxing(rsdata[2][t].u64), frm, &fflags));
         break;
       case FMNMADD:
         if (func2)
           // RV32D: FNMADD.D
-          rddata[t].u64 = rv_fnmadd_d(rsdata[t][0].u64, rsdata[t][1].u64, rsdata[t][2].u64, frm, &fflags);
+          rddata[t].u64 = rv_fnmadd_d(rsdata[0][t].u64, rsdata[1][t].u64, rsdata[2][t].u64, frm, &fflags);
         else
           // RV32F: FNMADD.S
-          rddata[t].u64 = nan_box(rv_fnmadd_s(check_boxing(rsdata[t][0].u64), check_boxing(rsdata[t][1].u64), check_boxing(rsdata[t][2].u64), frm, &fflags));
+          rddata[t].u64 = nan_box(rv_fnmadd_s(check_boxing(rsdata[0][t].u64), check_boxing(rsdata[1][t].u64), check_boxing(rsdata[2][t].u64), frm, &fflags));
         break; 
       case FMNMSUB:
         if (func2)
           // RV32D: FNMSUB.D
-          rddata[t].u64 = rv_fnmsub_d(rsdata[t][0].u64, rsdata[t][1].u64, rsdata[t][2].u64, frm, &fflags);
+          rddata[t].u64 = rv_fnmsub_d(rsdata[0][t].u64, rsdata[1][t].u64, rsdata[2][t].u64, frm, &fflags);
         else
           // RV32F: FNMSUB.S
-          rddata[t].u64 = nan_box(rv_fnmsub_s(check_boxing(rsdata[t][0].u64), check_boxing(rsdata[t][1].u64), check_boxing(rsdata[t][2].u64), frm, &fflags));
+          rddata[t].u64 = nan_box(rv_fnmsub_s(check_boxing(rsdata[0][t].u64), check_boxing(rsdata[1][t].u64), check_boxing(rsdata[2][t].u64), frm, &fflags));
         break;
       default:
         break;
@@ -1323,7 +1408,7 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         trace->fetch_stall = true;
         next_tmask.reset();
         for (uint32_t t = 0; t < num_threads; ++t) {
-          next_tmask.set(t, rsdata.at(thread_start)[0].i & (1 << t));
+          next_tmask.set(t, rsdata[0][thread_start].i & (1 << t));
         }
       } break;
       case 1: {
@@ -1333,7 +1418,7 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         trace->used_iregs.set(rsrc0);
         trace->used_iregs.set(rsrc1);
         trace->fetch_stall = true;
-        core_->wspawn(rsdata.at(thread_start)[0].i, rsdata.at(thread_start)[1].i);
+        core_->wspawn(rsdata[0][thread_start].i, rsdata[1][thread_start].i);
       } break;
       case 2: {
         // SPLIT
@@ -1344,7 +1429,7 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
 
         ThreadMask then_tmask, else_tmask;
         for (uint32_t t = 0; t < num_threads; ++t) {
-          auto cond = ireg_file_.at(t).at(rsrc0);
+          auto cond = ireg_file_.at(rsrc0 * reg_stride_ + t);
           then_tmask[t] = tmask_.test(t) && cond;
           else_tmask[t] = tmask_.test(t) && !cond;
         }
@@ -1375,7 +1460,7 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         trace->used_iregs.set(rsrc0);
         trace->fetch_stall = true;
 
-        int is_divergent = ireg_file_.at(thread_start).at(rsrc0);
+        int is_divergent = ireg_file_.at(rsrc0 * reg_stride_ + thread_start);
         if (is_divergent != 0) {
           if (ipdom_stack_.empty()) {
             std::cout << "IPDOM stack is empty!\n" << std::flush;
@@ -1395,7 +1480,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         trace->used_iregs.set(rsrc0);
         trace->used_iregs.set(rsrc1);
         trace->fetch_stall = true;
-        trace->data = std::make_shared<SFUTraceData>(rsdata[thread_start][0].i, rsdata[thread_start][1].i);
+        trace->data.sfu.bar.id = rsdata[0][thread_start].i;
+        trace->data.sfu.bar.count = rsdata[1][thread_start].i;
       } break;
       case 5: {
         // PRED  
@@ -1406,12 +1492,12 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         trace->fetch_stall = true;
         ThreadMask pred;
         for (uint32_t t = 0; t < num_threads; ++t) {
-          pred[t] = tmask_.test(t) && (ireg_file_.at(t).at(rsrc0) & 0x1);
+          pred[t] = tmask_.test(t) && (ireg_file_.at(rsrc0 * reg_stride_ + t) & 0x1);
         }
         if (pred.any()) {
           next_tmask &= pred;
         } else {
-          next_tmask = ireg_file_.at(thread_start).at(rsrc1);
+          next_tmask = ireg_file_.at(rsrc1 * reg_stride_ + thread_start);
         }      
       } break;
       default:
@@ -1435,7 +1521,7 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         for (uint32_t t = thread_start; t < num_threads; ++t) {
           if (!tmask_.test(t))
             continue;     
-          rddata[t].i = rsdata[t][0].i ? rsdata[t][1].i : rsdata[t][2].i;
+          rddata[t].i = rsdata[0][t].i ? rsdata[1][t].i : rsdata[2][t].i;
         }
         rd_write = true;
       } break;
@@ -2206,8 +2292,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         if (vtype_.vsew == 8) {
           for (uint32_t i = 0; i < vl_; i++) {
             uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t result = (rsdata[i][0].i + second);
-            DP(3, "Comparing " << rsdata[i][0].i << " + " << second << " = " << result);
+            uint8_t result = (rsdata[0][i].i + second);
+            DP(3, "Comparing " << rsdata[0][i].i << " + " << second << " = " << result);
             *(uint8_t *)(vd.data() + i) = result;
           }
           for (uint32_t i = vl_; i < VLMAX; i++) {
@@ -2216,8 +2302,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         } else if (vtype_.vsew == 16) {
           for (uint32_t i = 0; i < vl_; i++) {
             uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t result = (rsdata[i][0].i + second);
-            DP(3, "Comparing " << rsdata[i][0].i << " + " << second << " = " << result);
+            uint16_t result = (rsdata[0][i].i + second);
+            DP(3, "Comparing " << rsdata[0][i].i << " + " << second << " = " << result);
             *(uint16_t *)(vd.data() + i) = result;
           }
           for (uint32_t i = vl_; i < VLMAX; i++) {
@@ -2226,8 +2312,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         } else if (vtype_.vsew == 32) {
           for (uint32_t i = 0; i < vl_; i++) {
             uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t result = (rsdata[i][0].i + second);
-            DP(3, "Comparing " << rsdata[i][0].i << " + " << second << " = " << result);
+            uint32_t result = (rsdata[0][i].i + second);
+            DP(3, "Comparing " << rsdata[0][i].i << " + " << second << " = " << result);
             *(uint32_t *)(vd.data() + i) = result;
           }
           for (uint32_t i = vl_; i < VLMAX; i++) {
@@ -2242,8 +2328,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         if (vtype_.vsew == 8) {
           for (uint32_t i = 0; i < vl_; i++) {
             uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t result = (rsdata[i][0].i * second);
-            DP(3, "Comparing " << rsdata[i][0].i << " + " << second << " = " << result);
+            uint8_t result = (rsdata[0][i].i * second);
+            DP(3, "Comparing " << rsdata[0][i].i << " + " << second << " = " << result);
             *(uint8_t *)(vd.data() + i) = result;
           }
           for (uint32_t i = vl_; i < VLMAX; i++) {
@@ -2252,8 +2338,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         } else if (vtype_.vsew == 16) {
           for (uint32_t i = 0; i < vl_; i++) {
             uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t result = (rsdata[i][0].i * second);
-            DP(3, "Comparing " << rsdata[i][0].i << " + " << second << " = " << result);
+            uint16_t result = (rsdata[0][i].i * second);
+            DP(3, "Comparing " << rsdata[0][i].i << " + " << second << " = " << result);
             *(uint16_t *)(vd.data() + i) = result;
           }
           for (uint32_t i = vl_; i < VLMAX; i++) {
@@ -2262,8 +2348,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         } else if (vtype_.vsew == 32) {
           for (uint32_t i = 0; i < vl_; i++) {
             uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t result = (rsdata[i][0].i * second);
-            DP(3, "Comparing " << rsdata[i][0].i << " + " << second << " = " << result);
+            uint32_t result = (rsdata[0][i].i * second);
+            DP(3, "Comparing " << rsdata[0][i].i << " + " << second << " = " << result);
             *(uint32_t *)(vd.data() + i) = result;
           }
           for (uint32_t i = vl_; i < VLMAX; i++) {
@@ -2305,6 +2391,14 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
     switch (type) {
     case RegType::Integer:      
       if (rdest) {   
+        auto rd_row = &ireg_file_[rdest * reg_stride_];
+        if (lane_alu) {
+          Word lane_mask[MAX_NUM_THREADS];
+          for (uint32_t t = 0; t < num_lanes; ++t) {
+            lane_mask[t] = tmask_.test(t) ? ~Word(0) : 0;
+          }
+          write_lanes(rd_row, rd_lanes, lane_mask, num_lanes);
+        }
         DPH(2, "Dest Reg: " << type << std::dec << rdest << "={");    
         for (uint32_t t = 0; t < num_threads; ++t) {
           if (t) DPN(2, ", ");
@@ -2312,8 +2406,10 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
             DPN(2, "-");
             continue;            
           }
-          ireg_file_.at(t)[rdest] = rddata[t].i;
-          DPN(2, "0x" << std::hex << rddata[t].i);         
+          if (!lane_alu) {
+            rd_row[t] = rddata[t].i;
+          }
+          DPN(2, "0x" << std::hex << rd_row[t]);         
         }
         DPN(2, "}" << std::endl);
         trace->used_iregs[rdest] = 1;
@@ -2331,7 +2427,7 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
           DPN(2, "-");
           continue;            
         }
-        freg_file_.at(t)[rdest] = rddata[t].u64;        
+        freg_file_[rdest * reg_stride_ + t] = rddata[t].u64;        
         DPN(2, "0x" << std::hex << rddata[t].f);         
       }
       DPN(2, "}" << std::endl);
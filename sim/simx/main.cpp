@@ -16,6 +16,9 @@
 #include <string>
 #include <sstream>
 #include <fstream>
+#include <iterator>
+#include <memory>
+#include <vector>
 #include <stdlib.h>
 #include <unistd.h>
 #include <sys/stat.h>
@@ -28,20 +31,29 @@
 using namespace vortex;
 
 static void show_usage() {
-   std::cout << "Usage: [-c <cores>] [-w <warps>] [-t <threads>] [-r: riscv-test] [-s: stats] [-h: help] <program>" << std::endl;
+   std::cout << "Usage: [-c <cores>] [-w <warps>] [-t <threads>] [-g <clusters>] [-j <sim threads>] [-f <fast-forward: pc=<addr>,cycle=<count>,marker,warmup,stop>] [-S <save checkpoint>] [-L <load checkpoint>] [-M: memory-mapped RAM] [-d <dram: standard=<name>,speed=<name>,org=<name>,channels=<n>,ranks=<n>,latency=<cycles>,bandwidth=<bytes/cycle>>] [-T <memory trace>] [-I <load memory image>] [-O <save memory image>] [-r: riscv-test] [-s: stats] [-h: help] <program>" << std::endl;
 }
 
 uint32_t num_threads = NUM_THREADS;
 uint32_t num_warps = NUM_WARPS;
 uint32_t num_cores = NUM_CORES;
 uint32_t num_clusters = NUM_CLUSTERS;
+uint32_t sim_threads = 1;
+Processor::FastForward fast_forward;
+DramSim::Config dram_config;
 bool showStats = false;;
+const char* save_checkpoint = nullptr;
+const char* load_checkpoint = nullptr;
+const char* mem_trace = nullptr;
+bool mapped_ram = false;
+const char* load_image = nullptr;
+const char* save_image = nullptr;
 bool riscv_test = false;
 const char* program = nullptr;
 
 static void parse_args(int argc, char **argv) {
   	int c;
-  	while ((c = getopt(argc, argv, "t:w:c:g:rsh?")) != -1) {
+  	while ((c = getopt(argc, argv, "t:w:c:g:j:f:S:L:MI:O:d:T:rsh?")) != -1) {
     	switch (c) {
       case 't':
         num_threads = atoi(optarg);
@@ -55,6 +67,41 @@ static void parse_args(int argc, char **argv) {
 		  case 'g':
         num_clusters = atoi(optarg);
         break;
+      case 'j':
+        sim_threads = atoi(optarg);
+        break;
+      case 'f':
+        if (!Processor::FastForward::parse(optarg, &fast_forward)) {
+          show_usage();
+          exit(-1);
+        }
+        break;
+      case 'S':
+        save_checkpoint = optarg;
+        break;
+      case 'L':
+        load_checkpoint = optarg;
+        break;
+      case 'M':
+        mapped_ram = true;
+        break;
+      case 'I':
+        load_image = optarg;
+        mapped_ram = true;
+        break;
+      case 'O':
+        save_image = optarg;
+        mapped_ram = true;
+        break;
+      case 'd':
+        if (!DramSim::Config::parse(optarg, &dram_config)) {
+          show_usage();
+          exit(-1);
+        }
+        break;
+      case 'T':
+        mem_trace = optarg;
+        break;
       case 'r':
         riscv_test = true;
         break;
@@ -75,7 +122,11 @@ static void parse_args(int argc, char **argv) {
 	if (optind < argc) {
 		program = argv[optind];
     std::cout << "Running " << program << "..." << std::endl;
-	} else {
+	} else if (load_checkpoint) {
+    std::cout << "Resuming " << load_checkpoint << "..." << std::endl;
+  } else if (load_image) {
+    std::cout << "Running " << load_image << "..." << std::endl;
+  } else {
 		show_usage();
     exit(-1);
 	}
@@ -91,13 +142,34 @@ int main(int argc, char **argv) {
     Arch arch(num_threads, num_warps, num_cores, num_clusters);
 
     // create memory module
-    RAM ram(RAM_PAGE_SIZE);
+    std::unique_ptr<RAM> ram_ptr;
+    if (mapped_ram) {
+      ram_ptr.reset(new MappedRAM(RAM_PAGE_SIZE, RAM_MAPPED_SIZE));
+    } else {
+      ram_ptr.reset(new RAM(RAM_PAGE_SIZE));
+    }
+    auto& ram = *ram_ptr;
 
     // create processor
-    Processor processor(arch);
+    Processor processor(arch, dram_config);
+    processor.set_num_threads(sim_threads);
+
+    // saving a checkpoint fast-forwards to the switch point and stops there
+    if (save_checkpoint) {
+      if (!fast_forward.enabled) {
+        Processor::FastForward::parse("marker", &fast_forward);
+      }
+      fast_forward.stop = true;
+    }
+    processor.set_fast_forward(fast_forward);
+
+    if (mem_trace) {
+      if (!processor.set_mem_trace(mem_trace))
+        return -1;
+    }
   
     // attach memory module
-    processor.attach_ram(&ram); 
+    processor.attach_ram(&ram);
 
 	  // setup base DCRs
     const uint64_t startup_addr(STARTUP_ADDR);
@@ -107,12 +179,27 @@ int main(int argc, char **argv) {
   #endif
 	  processor.write_dcr(VX_DCR_BASE_MPM_CLASS, 0);
 
+    // load memory image
+    if (load_image) {
+      if (!static_cast<MappedRAM&>(ram).loadImage(load_image))
+        return -1;
+    }
+
     // load program
-    {      
+    if (program) {      
       std::string program_ext(fileExtension(program));
-      if (program_ext == "bin") {
+      if (program_ext == "bin" && load_image) {
+        // place the program over the memory image without clearing it
+        std::ifstream ifs(program, std::ios::binary);
+        if (!ifs) {
+          std::cout << "*** error: " << program << " not found" << std::endl;
+          return -1;
+        }
+        std::vector<char> content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        ram.write(content.data(), startup_addr, content.size());
+      } else if (program_ext == "bin") {
         ram.loadBinImage(program, startup_addr);
-      } else if (program_ext == "hex") {
+      } else if (program_ext == "hex" && !load_image) {
         ram.loadHexImage(program);
       } else {
         std::cout << "*** error: only *.bin or *.hex images supported." << std::endl;
@@ -120,8 +207,29 @@ int main(int argc, char **argv) {
       }
     }
 
+    if (load_checkpoint) {
+      if (!processor.load_checkpoint(load_checkpoint))
+        return -1;
+    }
+
     // run simulation
     exitcode = processor.run(riscv_test);
+
+    if (save_checkpoint) {
+      if (!processor.save_checkpoint(save_checkpoint, fast_forward.warmup))
+        return -1;
+      std::cout << "Saved checkpoint " << save_checkpoint << std::endl;
+    }
+
+    if (save_image) {
+      if (!static_cast<MappedRAM&>(ram).saveImage(save_image))
+        return -1;
+      std::cout << "Saved memory image " << save_image << std::endl;
+    }
+
+    if (showStats) {
+      processor.show_stats();
+    }
   }   
 
   if (exitcode != 0) {
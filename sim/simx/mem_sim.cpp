@@ -16,14 +16,6 @@
 #include <queue>
 #include <stdlib.h>
 
-DISABLE_WARNING_PUSH
-DISABLE_WARNING_UNUSED_PARAMETER
-#define RAMULATOR
-#include <ramulator/src/Gem5Wrapper.h>
-#include <ramulator/src/Request.h>
-#include <ramulator/src/Statistics.h>
-DISABLE_WARNING_POP
-
 #include "constants.h"
 #include "types.h"
 #include "debug.h"
@@ -35,40 +27,25 @@ private:
     MemSim* simobject_;
     Config config_;
     PerfStats perf_stats_;
-    ramulator::Gem5Wrapper* dram_;
+    DramSim dram_;
+    uint64_t pending_reads_;
 
 public:
 
     Impl(MemSim* simobject, const Config& config) 
         : simobject_(simobject)
         , config_(config)
-    {
-        ramulator::Config ram_config;
-        ram_config.add("standard", "DDR4");
-        ram_config.add("channels", std::to_string(config.channels));
-        ram_config.add("ranks", "1");
-        ram_config.add("speed", "DDR4_2400R");
-        ram_config.add("org", "DDR4_4Gb_x8");
-        ram_config.add("mapping", "defaultmapping");
-        ram_config.set_core_num(config.num_cores);
-        dram_ = new ramulator::Gem5Wrapper(ram_config, MEM_BLOCK_SIZE);
-        Stats::statlist.output("ramulator.ddr4.log");
-    }
-
-    ~Impl() {
-        dram_->finish();
-        Stats::statlist.printall();
-        delete dram_;
-    }
+        , dram_(config.dram, MEM_BLOCK_SIZE, config.num_cores)
+        , pending_reads_(0)
+    {}
 
     const PerfStats& perf_stats() const {
         return perf_stats_;
     }
 
-    void dram_callback(ramulator::Request& req, uint32_t tag, uint64_t uuid) {
-        if (req.type == ramulator::Request::Type::WRITE)
-            return;
-        MemRsp mem_rsp{tag, (uint32_t)req.coreid, uuid};
+    void dram_callback(uint32_t tag, uint32_t cid, uint64_t uuid) {
+        --pending_reads_;
+        MemRsp mem_rsp{tag, cid, uuid};
         simobject_->MemRspPort.send(mem_rsp, 1);
         DT(3, simobject_->name() << "-" << mem_rsp);
     }
@@ -77,35 +54,46 @@ public:
         perf_stats_ = PerfStats();
     }
 
-    void tick() {
+    bool idle() const {
+        // only reads complete through callbacks
+        return (0 == pending_reads_) && simobject_->MemReqPort.empty();
+    }
+
+    void skip(uint64_t cycles) {
+        // replay the elided DRAM clocks so that refresh timing is preserved
+        auto end = SimPlatform::instance().cycles();
+        for (auto cycle = end - cycles; cycle < end; ++cycle) {
+            this->tick_dram(cycle);
+        }
+    }
+
+    void tick_dram(uint64_t cycle) {
         if (MEM_CYCLE_RATIO > 0) { 
-            auto cycle = SimPlatform::instance().cycles();
             if ((cycle % MEM_CYCLE_RATIO) == 0)
-                dram_->tick();
+                dram_.tick();
         } else {
             for (int i = MEM_CYCLE_RATIO; i <= 0; ++i)
-                dram_->tick();            
+                dram_.tick();            
         }
+    }
+
+    void tick() {
+        this->tick_dram(SimPlatform::instance().cycles());
               
         if (simobject_->MemReqPort.empty())
             return;
         
         auto& mem_req = simobject_->MemReqPort.front();
 
-        ramulator::Request dram_req( 
-            mem_req.addr,
-            mem_req.write ? ramulator::Request::Type::WRITE : ramulator::Request::Type::READ,
-            std::bind(&Impl::dram_callback, this, placeholders::_1, mem_req.tag, mem_req.uuid),
-            mem_req.cid
-        );
-
-        if (!dram_->send(dram_req))
+        if (!dram_.send(mem_req.addr, mem_req.write, mem_req.cid,
+                        std::bind(&Impl::dram_callback, this, mem_req.tag, mem_req.cid, mem_req.uuid)))
             return;
         
         if (mem_req.write) {
             ++perf_stats_.writes;
         } else {
             ++perf_stats_.reads;
+            ++pending_reads_;
         }
         
         DT(3, simobject_->name() << "-" << mem_req);
@@ -133,4 +121,16 @@ void MemSim::reset() {
 
 void MemSim::tick() {
     impl_->tick();
+}
+
+bool MemSim::idle() const {
+    return impl_->idle();
+}
+
+void MemSim::skip(uint64_t cycles) {
+    impl_->skip(cycles);
+}
+
+const MemSim::PerfStats& MemSim::perf_stats() const {
+    return impl_->perf_stats();
 }
\ No newline at end of file
@@ -14,6 +14,7 @@
 #pragma once
 
 #include <simobject.h>
+#include <dram_sim.h>
 #include "types.h"
 
 namespace vortex {
@@ -21,7 +22,7 @@ namespace vortex {
 class MemSim : public SimObject<MemSim>{
 public:
     struct Config {        
-        uint32_t channels;      
+        DramSim::Config dram;
         uint32_t num_cores;
     };
 
@@ -45,6 +46,10 @@ public:
 
     void tick();
 
+    bool idle() const;
+
+    void skip(uint64_t cycles);
+
     const PerfStats& perf_stats() const;
     
 private:
@@ -0,0 +1,112 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mem_trace.h"
+#include <serialize.h>
+#include <iostream>
+
+using namespace vortex;
+
+namespace {
+const uint32_t MEM_TRACE_MAGIC   = 0x544d5856; // "VXMT"
+const uint32_t MEM_TRACE_VERSION = 1;
+}
+
+MemTraceWriter::MemTraceWriter()
+  : base_cycle_(0)
+  , count_(0)
+{}
+
+MemTraceWriter::~MemTraceWriter() {
+  this->close();
+}
+
+bool MemTraceWriter::open(const char* filename, const MemTraceHeader& header) {
+  ofs_.open(filename, std::ios::binary);
+  if (!ofs_) {
+    std::cout << "Error: cannot create memory trace file: " << filename << std::endl;
+    return false;
+  }
+  MemTraceHeader hdr(header);
+  hdr.magic = MEM_TRACE_MAGIC;
+  hdr.version = MEM_TRACE_VERSION;
+  hdr.reserved = 0;
+  write_pod(ofs_, hdr);
+  base_cycle_ = 0;
+  count_ = 0;
+  return true;
+}
+
+void MemTraceWriter::close() {
+  if (ofs_.is_open()) {
+    ofs_.close();
+  }
+}
+
+void MemTraceWriter::write(MemTraceSource source,
+                           const MemReq& req,
+                           uint64_t cycle,
+                           uint32_t cluster,
+                           uint32_t core,
+                           uint32_t lane) {
+  MemTraceRecord record;
+  record.cycle   = base_cycle_ + cycle;
+  record.addr    = req.addr;
+  record.uuid    = req.uuid;
+  record.tag     = req.tag;
+  record.cid     = req.cid;
+  record.cluster = cluster;
+  record.core    = core;
+  record.lane    = lane;
+  record.source  = uint8_t(source);
+  record.write   = req.write;
+  record.type    = uint8_t(req.type);
+  write_pod(ofs_, record);
+  ++count_;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MemTraceReader::MemTraceReader() {}
+
+MemTraceReader::~MemTraceReader() {}
+
+bool MemTraceReader::open(const char* filename) {
+  ifs_.open(filename, std::ios::binary);
+  if (!ifs_) {
+    std::cout << "Error: cannot open memory trace file: " << filename << std::endl;
+    return false;
+  }
+  read_pod(ifs_, &header_);
+  if (!ifs_
+   || header_.magic != MEM_TRACE_MAGIC
+   || header_.version != MEM_TRACE_VERSION) {
+    std::cout << "Error: invalid memory trace file: " << filename << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool MemTraceReader::read(MemTraceRecord* record) {
+  read_pod(ifs_, record);
+  return bool(ifs_);
+}
+
+MemReq vortex::to_mem_req(const MemTraceRecord& record) {
+  return MemReq(record.addr,
+                record.write != 0,
+                AddrType(record.type),
+                record.tag,
+                record.cid,
+                record.uuid);
+}
@@ -0,0 +1,115 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include "types.h"
+
+namespace vortex {
+
+enum class MemTraceSource : uint8_t {
+  ICache,
+  DCache,
+  Dram,
+};
+
+// fixed-size trace record, one per request entering a cache cluster or the
+// memory simulator, 'cycle' is the arrival cycle at that port
+struct MemTraceRecord {
+  uint64_t cycle;
+  uint64_t addr;
+  uint64_t uuid;
+  uint32_t tag;
+  uint32_t cid;
+  uint16_t cluster;
+  uint16_t core;    // core index within the cluster
+  uint8_t  lane;
+  uint8_t  source;  // MemTraceSource
+  uint8_t  write;
+  uint8_t  type;    // AddrType
+};
+
+static_assert(sizeof(MemTraceRecord) == 40, "invalid trace record size");
+
+struct MemTraceHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t xlen;
+  uint32_t num_clusters;
+  uint32_t num_cores;
+  uint32_t num_warps;
+  uint32_t num_threads;
+  uint32_t num_lsu_lanes;
+  uint32_t block_size;
+  uint32_t reserved;
+};
+
+class MemTraceWriter {
+public:
+  MemTraceWriter();
+  ~MemTraceWriter();
+
+  bool open(const char* filename, const MemTraceHeader& header);
+
+  void close();
+
+  bool is_open() const {
+    return ofs_.is_open();
+  }
+
+  void write(MemTraceSource source,
+             const MemReq& req,
+             uint64_t cycle,
+             uint32_t cluster = 0,
+             uint32_t core = 0,
+             uint32_t lane = 0);
+
+  // the simulation clock restarts on every run, later records are offset
+  void advance(uint64_t cycles) {
+    base_cycle_ += cycles;
+  }
+
+  uint64_t count() const {
+    return count_;
+  }
+
+private:
+  std::ofstream ofs_;
+  uint64_t base_cycle_;
+  uint64_t count_;
+};
+
+class MemTraceReader {
+public:
+  MemTraceReader();
+  ~MemTraceReader();
+
+  bool open(const char* filename);
+
+  const MemTraceHeader& header() const {
+    return header_;
+  }
+
+  // returns false at the end of the trace
+  bool read(MemTraceRecord* record);
+
+private:
+  std::ifstream ifs_;
+  MemTraceHeader header_;
+};
+
+MemReq to_mem_req(const MemTraceRecord& record);
+
+}
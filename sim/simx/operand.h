@@ -33,6 +33,10 @@ public:
 
     virtual void reset() {}
 
+    virtual bool idle() const {
+        return Input.empty();
+    }
+
     virtual void tick() {
         if (Input.empty())
             return;
@@ -17,32 +17,23 @@
 #include <memory>
 #include <iostream>
 #include <util.h>
+#include <mempool.h>
 #include "types.h"
 #include "arch.h"
 #include "debug.h"
 
 namespace vortex {
 
-class ITraceData {
-public:
-    using Ptr = std::shared_ptr<ITraceData>;
-    ITraceData() {}
-    virtual ~ITraceData() {}
-};
-
-struct LsuTraceData : public ITraceData {
-  using Ptr = std::shared_ptr<LsuTraceData>;
-  std::vector<mem_addr_size_t> mem_addrs;
-  LsuTraceData(uint32_t num_threads) : mem_addrs(num_threads) {}
+struct LsuTraceData {
+  mem_addr_size_t mem_addrs[MAX_NUM_THREADS];
+  uint32_t tlb_misses;
 };
 
-struct SFUTraceData : public ITraceData {
-  using Ptr = std::shared_ptr<SFUTraceData>;
+struct SFUTraceData {
   struct {
     uint32_t id;
     uint32_t count;
   } bar;
-  SFUTraceData(uint32_t bar_id, uint32_t bar_count) : bar{bar_id, bar_count} {}
 };
 
 struct pipeline_trace_t {
@@ -79,7 +70,11 @@ public:
     SfuType  sfu_type;
   };
 
-  ITraceData::Ptr data;
+  // unit-specific payload, selected by exe_type
+  union {
+    LsuTraceData lsu;
+    SFUTraceData sfu;
+  } data;
 
   int pid;
   bool sop;
@@ -102,7 +97,6 @@ public:
     , used_vregs(0)
     , exe_type(ExeType::ALU)
     , unit_type(0)
-    , data(nullptr)
     , pid(-1)
     , sop(true)
     , eop(true)
@@ -135,6 +129,14 @@ public:
   
   ~pipeline_trace_t() {}
 
+  void* operator new(size_t /*size*/) {
+    return allocator().allocate();
+  }
+
+  void operator delete(void* ptr) {
+    allocator().deallocate(ptr);
+  }
+
   bool log_once(bool enable) {
     bool old = log_once_;
     log_once_ = enable;
@@ -143,6 +145,12 @@ public:
 
 private:
   bool log_once_;
+
+  // traces are created and retired by the thread ticking their core, so a
+  // pool per thread recycles them without locking.
+  static MemoryPool<pipeline_trace_t>& allocator() {
+    return ThreadMemoryPool<pipeline_trace_t>::get();
+  }
 };
 
 inline std::ostream &operator<<(std::ostream &os, const pipeline_trace_t& state) {
@@ -177,7 +185,7 @@ public:
     return queue_.empty();
   }
 
-  pipeline_trace_t* front() {
+  pipeline_trace_t* front() const {
     return queue_.front();
   }
 
@@ -11,145 +11,80 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+
+#include <iostream>
+#include <sstream>
+#include <stdlib.h>
 #include "processor.h"
 #include "processor_impl.h"
 
 using namespace vortex;
 
-ProcessorImpl::ProcessorImpl(const Arch& arch) 
-  : arch_(arch)
-  , clusters_(arch.num_clusters())
-{
-  SimPlatform::instance().initialize();
-
-  // create memory simulator
-  memsim_ = MemSim::Create("dram", MemSim::Config{
-    MEMORY_BANKS,
-    uint32_t(arch.num_cores()) * arch.num_clusters()
-  });
-
-  // create L3 cache
-  l3cache_ = CacheSim::Create("l3cache", CacheSim::Config{
-    !L3_ENABLED,
-    log2ceil(L3_CACHE_SIZE),  // C
-    log2ceil(MEM_BLOCK_SIZE), // B
-    log2ceil(L3_NUM_WAYS),  // W
-    0,                      // A
-    XLEN,                   // address bits  
-    L3_NUM_BANKS,           // number of banks
-    1,                      // number of ports
-    uint8_t(arch.num_clusters()), // request size 
-    true,                   // write-through
-    false,                  // write response
-    0,                      // victim size
-    L3_MSHR_SIZE,           // mshr
-    2,                      // pipeline latency
-    }
-  );        
-  
-  // connect L3 memory ports
-  l3cache_->MemReqPort.bind(&memsim_->MemReqPort);
-  memsim_->MemRspPort.bind(&l3cache_->MemRspPort);
-
-  // create clusters
-  for (uint32_t i = 0; i < arch.num_clusters(); ++i) {
-    clusters_.at(i) = Cluster::Create(i, this, arch, dcrs_);
-    // connect L3 core ports
-    clusters_.at(i)->mem_req_port.bind(&l3cache_->CoreReqPorts.at(i));
-    l3cache_->CoreRspPorts.at(i).bind(&clusters_.at(i)->mem_rsp_port);
-  }
-
-  // set up memory perf recording
-  memsim_->MemReqPort.tx_callback([&](const MemReq& req, uint64_t cycle){
-    __unused (cycle);
-    perf_mem_reads_   += !req.write;
-    perf_mem_writes_  += req.write;
-    perf_mem_pending_reads_ += !req.write;
-  });
-  memsim_->MemRspPort.tx_callback([&](const MemRsp&, uint64_t cycle){
-    __unused (cycle);
-    --perf_mem_pending_reads_;
-  });
+Processor::Processor(const Arch& arch, const DramSim::Config& dram_config) 
+  : impl_(new ProcessorImpl(arch, dram_config))
+{}
 
-  this->reset();
+Processor::~Processor() {
+  delete impl_;
 }
 
-ProcessorImpl::~ProcessorImpl() {
-  SimPlatform::instance().finalize();
+void Processor::attach_ram(RAM* mem) {
+  impl_->attach_ram(mem);
 }
 
-void ProcessorImpl::attach_ram(RAM* ram) {
-  for (auto cluster : clusters_) {
-    cluster->attach_ram(ram);
-  }
+int Processor::run(bool riscv_test) {
+  return impl_->run(riscv_test);
 }
 
-int ProcessorImpl::run(bool riscv_test) {
-  SimPlatform::instance().reset();
-  this->reset();
-  
-  bool done;
-  Word exitcode = 0;
-  do {
-    SimPlatform::instance().tick();
-    done = true;
-    for (auto cluster : clusters_) {
-      if (cluster->running()) {
-        Word ec;   
-        if (cluster->check_exit(&ec, riscv_test)) {
-          exitcode |= ec;
-        } else {
-          done = false;
-        }
-      }
-    }
-    perf_mem_latency_ += perf_mem_pending_reads_;
-  } while (!done);
-
-  return exitcode;
-}
- 
-void ProcessorImpl::reset() {
-  perf_mem_reads_ = 0;
-  perf_mem_writes_ = 0;
-  perf_mem_latency_ = 0;
-  perf_mem_pending_reads_ = 0;
+void Processor::write_dcr(uint32_t addr, uint32_t value) {
+  return impl_->write_dcr(addr, value);
 }
 
-void ProcessorImpl::write_dcr(uint32_t addr, uint32_t value) {
-  dcrs_.write(addr, value);
+void Processor::set_num_threads(uint32_t num_threads) {
+  impl_->set_num_threads(num_threads);
 }
 
-ProcessorImpl::PerfStats ProcessorImpl::perf_stats() const {
-  ProcessorImpl::PerfStats perf;
-  perf.mem_reads   = perf_mem_reads_;
-  perf.mem_writes  = perf_mem_writes_;
-  perf.mem_latency = perf_mem_latency_;
-  perf.l3cache     = l3cache_->perf_stats();
-  for (auto cluster : clusters_) {
-    perf.clusters += cluster->perf_stats();
-  }   
-  return perf;
+void Processor::set_fast_forward(const FastForward& ff) {
+  impl_->set_fast_forward(ff);
 }
 
-///////////////////////////////////////////////////////////////////////////////
-
-Processor::Processor(const Arch& arch) 
-  : impl_(new ProcessorImpl(arch))
-{}
+bool Processor::set_mem_trace(const char* filename) {
+  return impl_->set_mem_trace(filename);
+}
 
-Processor::~Processor() {
-  delete impl_;
+bool Processor::save_checkpoint(const char* filename, bool caches) const {
+  return impl_->save_checkpoint(filename, caches);
 }
 
-void Processor::attach_ram(RAM* mem) {
-  impl_->attach_ram(mem);
+bool Processor::load_checkpoint(const char* filename) {
+  return impl_->load_checkpoint(filename);
 }
 
-int Processor::run(bool riscv_test) {
-  return impl_->run(riscv_test);
+bool Processor::FastForward::parse(const char* spec, FastForward* out) {
+  FastForward ff;
+  ff.enabled = true;
+  std::stringstream ss(spec);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (item.compare(0, 3, "pc=") == 0) {
+      ff.pc = std::strtoull(item.c_str() + 3, nullptr, 0);
+    } else if (item.compare(0, 6, "cycle=") == 0) {
+      ff.cycles = std::strtoull(item.c_str() + 6, nullptr, 0);
+    } else if (item == "marker") {
+      // always enabled
+    } else if (item == "warmup") {
+      ff.warmup = true;
+    } else if (item == "stop") {
+      ff.stop = true;
+    } else {
+      std::cout << "Error: invalid fast-forward option: " << item << std::endl;
+      return false;
+    }
+  }
+  *out = ff;
+  return true;
 }
 
-void Processor::write_dcr(uint32_t addr, uint32_t value) {
-  return impl_->write_dcr(addr, value);
+void Processor::show_stats() const {
+  impl_->show_stats();
 }
\ No newline at end of file
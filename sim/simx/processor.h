@@ -14,6 +14,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <dram_sim.h>
 
 namespace vortex {
 
@@ -23,7 +24,28 @@ class ProcessorImpl;
 
 class Processor {
 public:
-  Processor(const Arch& arch);
+  // Functional fast-forward: execute without timing until a warp reaches 'pc',
+  // 'cycles' functional steps have elapsed, or the kernel calls vx_sim_marker().
+  struct FastForward {
+    bool     enabled;
+    uint64_t pc;      // 0: disabled
+    uint64_t cycles;  // 0: disabled
+    bool     warmup;  // warm up the caches while fast-forwarding
+    bool     stop;    // return at the switch point instead of running timing mode
+
+    FastForward() 
+      : enabled(false)
+      , pc(0)
+      , cycles(0)
+      , warmup(false) 
+      , stop(false)
+    {}
+
+    // parse a comma-separated list of "pc=<addr>", "cycle=<count>", "marker", "warmup", "stop"
+    static bool parse(const char* spec, FastForward* out);
+  };
+
+  Processor(const Arch& arch, const DramSim::Config& dram_config = DramSim::Config());
   ~Processor();
 
   void attach_ram(RAM* mem);
@@ -32,6 +54,23 @@ public:
 
   void write_dcr(uint32_t addr, uint32_t value);
 
+  void set_num_threads(uint32_t num_threads);
+
+  void set_fast_forward(const FastForward& ff);
+
+  void show_stats() const;
+
+  // Stream the requests entering the L1 caches and the memory simulator to
+  // a binary trace that the memreplay tool can replay without the cores.
+  bool set_mem_trace(const char* filename);
+
+  // Save the architectural state (memory, DCRs, warps, CSRs and optionally
+  // the cache tags) between runs, e.g. after a run stopped by fast-forward.
+  bool save_checkpoint(const char* filename, bool caches) const;
+
+  // Load a checkpoint, the next run() resumes from it.
+  bool load_checkpoint(const char* filename);
+
 private:
   ProcessorImpl* impl_;
 };
@@ -0,0 +1,492 @@
+// Copyright © 2019-2023
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sstream>
+#include <fstream>
+#include <serialize.h>
+#include "processor.h"
+#include "processor_impl.h"
+
+using namespace vortex;
+
+ProcessorImpl::ProcessorImpl(const Arch& arch, const DramSim::Config& dram_config) 
+  : arch_(arch)
+  , clusters_(arch.num_clusters())
+  , code_region_(RAM_PAGE_SIZE)
+  , num_threads_(1)
+  , ram_(nullptr)
+{
+  SimPlatform::instance().initialize();
+
+  // create memory simulator
+  DramSim::Config memsim_dram(dram_config);
+  if (0 == memsim_dram.channels) {
+    memsim_dram.channels = MEMORY_BANKS;
+  }
+  memsim_ = MemSim::Create("dram", MemSim::Config{
+    memsim_dram,
+    uint32_t(arch.num_cores()) * arch.num_clusters()
+  });
+
+  // create L3 cache
+  l3cache_ = CacheSim::Create("l3cache", ProcessorImpl::l3cache_config(arch));        
+  
+  // connect L3 memory ports
+  l3cache_->MemReqPort.bind(&memsim_->MemReqPort);
+  memsim_->MemRspPort.bind(&l3cache_->MemRspPort);
+
+  // create clusters
+  // (each cluster gets its own partition so that clusters can be ticked in parallel)
+  for (uint32_t i = 0; i < arch.num_clusters(); ++i) {
+    SimPlatform::instance().set_partition(1 + i);
+    clusters_.at(i) = Cluster::Create(i, this, arch, dcrs_);
+    SimPlatform::instance().set_partition(0);
+    // connect L3 core ports
+    clusters_.at(i)->mem_req_port.bind(&l3cache_->CoreReqPorts.at(i));
+    l3cache_->CoreRspPorts.at(i).bind(&clusters_.at(i)->mem_rsp_port);
+  }
+
+  // set up memory perf recording
+  memsim_->MemReqPort.tx_callback([&](const MemReq& req, uint64_t cycle){
+    perf_mem_reads_   += !req.write;
+    perf_mem_writes_  += req.write;
+    perf_mem_pending_reads_ += !req.write;
+    if (mem_trace_) {
+      mem_trace_->write(MemTraceSource::Dram, req, cycle);
+    }
+  });
+  memsim_->MemRspPort.tx_callback([&](const MemRsp&, uint64_t cycle){
+    __unused (cycle);
+    --perf_mem_pending_reads_;
+  });
+
+  this->reset();
+}
+
+ProcessorImpl::~ProcessorImpl() {
+  SimPlatform::instance().finalize();
+}
+
+CacheSim::Config ProcessorImpl::l3cache_config(const Arch& arch) {
+  return CacheSim::Config{
+    !L3_ENABLED,
+    log2ceil(L3_CACHE_SIZE),  // C
+    log2ceil(MEM_BLOCK_SIZE), // B
+    log2ceil(L3_NUM_WAYS),  // W
+    0,                      // A
+    XLEN,                   // address bits  
+    L3_NUM_BANKS,           // number of banks
+    1,                      // number of ports
+    uint8_t(arch.num_clusters()), // request size 
+    !L3_WRITEBACK,          // write-through
+    false,                  // write response
+    0,                      // victim size
+    L3_MSHR_SIZE,           // mshr
+    2,                      // pipeline latency
+    CacheSim::ReplType(L3_REPL_POLICY), // replacement policy
+    CacheSim::PrefetchType(L3_PREFETCHER), // prefetcher
+    CACHE_PREFETCH_DEGREE,  // prefetch degree
+  };
+}
+
+void ProcessorImpl::attach_ram(RAM* ram) {
+  ram_ = ram;
+  for (auto cluster : clusters_) {
+    cluster->attach_ram(ram);
+  }
+}
+
+void ProcessorImpl::start() {
+  // the host may have updated the code since the last run
+  code_region_.reset();
+
+  SimPlatform::instance().reset();
+  this->reset();
+}
+
+Core::Ptr ProcessorImpl::core(uint32_t index) const {
+  return clusters_.at(index / arch_.num_cores())->cores().at(index % arch_.num_cores());
+}
+
+int ProcessorImpl::run(bool riscv_test) {
+  this->start();
+
+  if (!checkpoint_.empty()) {
+    this->restore_checkpoint();
+  }
+
+  // memory perf counters sample all clusters mid-cycle, tick them sequentially
+  auto perf_class = dcrs_.base_dcrs.read(VX_DCR_BASE_MPM_CLASS);
+  SimPlatform::instance().set_num_threads((perf_class == VX_DCR_MPM_CLASS_MEM) ? 1 : num_threads_);
+  
+  bool done;
+  Word exitcode = 0;
+
+  if (fast_forward_.enabled) {
+    if (this->fast_forward(riscv_test, &exitcode))
+      return exitcode;
+    if (fast_forward_.stop)
+      return 0;
+  }
+
+  do {
+    auto cycles = SimPlatform::instance().cycles();
+    SimPlatform::instance().tick();
+    done = true;
+    for (auto cluster : clusters_) {
+      if (cluster->running()) {
+        Word ec;   
+        if (cluster->check_exit(&ec, riscv_test)) {
+          exitcode |= ec;
+        } else {
+          done = false;
+        }
+      }
+    }
+    // the platform may have skipped idle cycles
+    perf_mem_latency_ += perf_mem_pending_reads_ * (SimPlatform::instance().cycles() - cycles);
+  } while (!done);
+
+  if (DCACHE_WRITEBACK || L2_WRITEBACK || L3_WRITEBACK) {
+    this->flush_caches();
+  }
+
+  SimPlatform::instance().sync();
+
+  if (mem_trace_) {
+    mem_trace_->advance(SimPlatform::instance().cycles());
+  }
+
+  return exitcode;
+}
+ 
+void ProcessorImpl::flush_caches() {
+  // each level settles into the next one before being flushed
+  for (uint32_t level = 1; level <= 3; ++level) {
+    this->drain();
+    if (level == 3) {
+      l3cache_->flush();
+    } else {
+      for (auto cluster : clusters_) {
+        cluster->flush_caches(level);
+      }
+    }
+  }
+  this->drain();
+}
+
+void ProcessorImpl::drain() {
+  bool busy;
+  do {
+    auto cycles = SimPlatform::instance().cycles();
+    busy = SimPlatform::instance().tick();
+    perf_mem_latency_ += perf_mem_pending_reads_ * (SimPlatform::instance().cycles() - cycles);
+  } while (busy);
+}
+
+bool ProcessorImpl::fast_forward(bool riscv_test, Word* exitcode) {
+  uint64_t cycles = 0;
+  for (;;) {
+    if (fast_forward_.cycles != 0 && cycles >= fast_forward_.cycles)
+      break;
+    bool marker = false;
+    uint32_t executed = 0;
+    for (auto cluster : clusters_) {
+      for (auto core : cluster->cores()) {
+        uint32_t count;
+        marker |= core->fast_forward(fast_forward_.pc, fast_forward_.warmup, &count);
+        executed += count;
+      }
+    }
+    ++cycles;
+    if (marker)
+      break;
+    if (0 == executed) {
+      // the program has completed
+      for (auto cluster : clusters_) {
+        Word ec;
+        if (cluster->check_exit(&ec, riscv_test)) {
+          *exitcode |= ec;
+        }
+      }
+      return true;
+    }
+  }
+  DP(1, "*** Switch to cycle-accurate mode after " << cycles << " functional cycles");
+  return false;
+}
+
+namespace {
+const uint32_t CHECKPOINT_MAGIC   = 0x50435856; // "VXCP"
+const uint32_t CHECKPOINT_VERSION = 4;
+}
+
+bool ProcessorImpl::save_checkpoint(const char* filename, bool caches) const {
+  if (nullptr == ram_) {
+    std::cout << "Error: no memory attached" << std::endl;
+    return false;
+  }
+  std::ofstream ofs(filename, std::ios::binary);
+  if (!ofs) {
+    std::cout << "Error: cannot create checkpoint file: " << filename << std::endl;
+    return false;
+  }
+
+  write_pod(ofs, CHECKPOINT_MAGIC);
+  write_pod(ofs, CHECKPOINT_VERSION);
+  write_pod(ofs, uint32_t(XLEN));
+  write_pod(ofs, uint32_t(arch_.num_clusters()));
+  write_pod(ofs, uint32_t(arch_.num_cores()));
+  write_pod(ofs, uint32_t(arch_.num_warps()));
+  write_pod(ofs, uint32_t(arch_.num_threads()));
+
+  dcrs_.base_dcrs.save(ofs);
+  ram_->save(ofs);
+
+  // cache tags are stored as a sized block so that a variant with a
+  // different cache geometry can skip them
+  std::stringstream ss;
+  if (caches) {
+    for (auto cluster : clusters_) {
+      cluster->save_caches(ss);
+    }
+    l3cache_->save(ss);
+  }
+  auto cache_state = ss.str();
+  write_pod(ofs, uint64_t(cache_state.size()));
+  ofs.write(cache_state.data(), cache_state.size());
+
+  for (auto cluster : clusters_) {
+    cluster->save(ofs);
+  }
+
+  if (!ofs) {
+    std::cout << "Error: failed writing checkpoint file: " << filename << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool ProcessorImpl::load_checkpoint(const char* filename) {
+  std::ifstream ifs(filename, std::ios::binary);
+  if (!ifs) {
+    std::cout << "Error: cannot open checkpoint file: " << filename << std::endl;
+    return false;
+  }
+
+  uint32_t magic = 0, version = 0, xlen = 0;
+  uint32_t num_clusters = 0, num_cores = 0, num_warps = 0, num_threads = 0;
+  read_pod(ifs, &magic);
+  read_pod(ifs, &version);
+  read_pod(ifs, &xlen);
+  read_pod(ifs, &num_clusters);
+  read_pod(ifs, &num_cores);
+  read_pod(ifs, &num_warps);
+  read_pod(ifs, &num_threads);
+  if (!ifs || magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION) {
+    std::cout << "Error: invalid checkpoint file: " << filename << std::endl;
+    return false;
+  }
+  if (xlen != XLEN
+   || num_clusters != arch_.num_clusters()
+   || num_cores != arch_.num_cores()
+   || num_warps != arch_.num_warps()
+   || num_threads != arch_.num_threads()) {
+    std::cout << "Error: checkpoint configuration mismatch: xlen=" << xlen 
+              << ", clusters=" << num_clusters 
+              << ", cores=" << num_cores 
+              << ", warps=" << num_warps
+              << ", threads=" << num_threads << std::endl;
+    return false;
+  }
+
+  // the state is applied at the start of the next run, after the reset
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+  checkpoint_ = ss.str();
+  return true;
+}
+
+void ProcessorImpl::restore_checkpoint() {
+  std::stringstream ss(checkpoint_);
+  checkpoint_.clear();
+
+  dcrs_.base_dcrs.load(ss);
+  if (nullptr == ram_ || !ram_->load(ss)) {
+    std::cout << "Error: failed restoring checkpoint memory" << std::endl;
+    std::abort();
+  }
+
+  uint64_t cache_size = 0;
+  read_pod(ss, &cache_size);
+  std::string cache_state(cache_size, '\0');
+  ss.read(&cache_state[0], cache_size);
+  if (cache_size != 0) {
+    std::stringstream cs(cache_state);
+    bool restored = true;
+    for (auto cluster : clusters_) {
+      restored = restored && cluster->load_caches(cs);
+    }
+    restored = restored && l3cache_->load(cs);
+    if (!restored) {
+      // nothing else has been restored on the simulator side yet
+      std::cout << "Warning: checkpoint cache geometry mismatch, caches start cold" << std::endl;
+      SimPlatform::instance().reset();
+    }
+  }
+
+  for (auto cluster : clusters_) {
+    cluster->load(ss);
+  }
+  if (!ss) {
+    std::cout << "Error: truncated checkpoint" << std::endl;
+    std::abort();
+  }
+}
+
+void ProcessorImpl::reset() {
+  perf_mem_reads_ = 0;
+  perf_mem_writes_ = 0;
+  perf_mem_latency_ = 0;
+  perf_mem_pending_reads_ = 0;
+}
+
+void ProcessorImpl::write_dcr(uint32_t addr, uint32_t value) {
+  dcrs_.write(addr, value);
+}
+
+void ProcessorImpl::set_num_threads(uint32_t num_threads) {
+  num_threads_ = std::max<uint32_t>(num_threads, 1);
+}
+
+void ProcessorImpl::set_fast_forward(const Processor::FastForward& ff) {
+  fast_forward_ = ff;
+}
+
+bool ProcessorImpl::set_mem_trace(const char* filename) {
+  MemTraceHeader header;
+  header.xlen = XLEN;
+  header.num_clusters = arch_.num_clusters();
+  header.num_cores = arch_.num_cores();
+  header.num_warps = arch_.num_warps();
+  header.num_threads = arch_.num_threads();
+  header.num_lsu_lanes = NUM_LSU_LANES;
+  header.block_size = MEM_BLOCK_SIZE;
+  mem_trace_.reset(new MemTraceWriter());
+  if (!mem_trace_->open(filename, header)) {
+    mem_trace_.reset();
+    return false;
+  }
+  for (auto cluster : clusters_) {
+    cluster->attach_mem_trace(mem_trace_.get());
+  }
+  return true;
+}
+
+void ProcessorImpl::l3cache_warmup(uint64_t addr, bool write) {
+  l3cache_->warmup(addr, write);
+}
+
+void ProcessorImpl::show_stats() const {
+  auto proc_perf = this->perf_stats();
+  auto show_prefetch = [&](const char* name, const CacheSim::PerfStats& cache) {
+    if (0 == cache.prefetches)
+      return;
+    // accuracy: useful prefetches per issued prefetch
+    // coverage: demand misses removed per would-be demand miss
+    uint64_t useful = cache.prefetch_hits + cache.prefetch_late;
+    int accuracy = int((useful * 100) / cache.prefetches);
+    uint64_t demand_misses = cache.prefetch_hits + cache.read_misses;
+    int coverage = demand_misses ? int((cache.prefetch_hits * 100) / demand_misses) : 0;
+    std::cout << "PERF: " << name << ": prefetches=" << cache.prefetches 
+              << ", hits=" << cache.prefetch_hits 
+              << ", late=" << cache.prefetch_late 
+              << ", accuracy=" << accuracy << "%"
+              << ", coverage=" << coverage << "%" << std::endl;
+  };
+  show_prefetch("icache", proc_perf.clusters.icache);
+  show_prefetch("dcache", proc_perf.clusters.dcache);
+  show_prefetch("l2cache", proc_perf.clusters.l2cache);
+  show_prefetch("l3cache", proc_perf.l3cache);
+
+  // dirty lines written back on evictions and flushes
+  auto show_writeback = [&](const char* name, const CacheSim::PerfStats& cache) {
+    if (0 == cache.evictions)
+      return;
+    std::cout << "PERF: " << name << ": writebacks=" << cache.evictions 
+              << ", writes=" << cache.writes << std::endl;
+  };
+  show_writeback("dcache", proc_perf.clusters.dcache);
+  show_writeback("l2cache", proc_perf.clusters.l2cache);
+  show_writeback("l3cache", proc_perf.l3cache);
+  {
+    auto& dram = memsim_->perf_stats();
+    auto requests = dram.reads + dram.writes;
+    int write_share = requests ? int((dram.writes * 100) / requests) : 0;
+    std::cout << "PERF: dram: reads=" << dram.reads 
+              << ", writes=" << dram.writes 
+              << ", write bytes=" << (dram.writes * MEM_BLOCK_SIZE)
+              << ", write share=" << write_share << "%" << std::endl;
+  }
+  {
+    auto& smem = proc_perf.clusters.sharedmem;
+    if (smem.reads + smem.writes != 0) {
+      std::cout << "PERF: sharedmem: reads=" << smem.reads 
+                << ", writes=" << smem.writes 
+                << ", bank stalls=" << smem.bank_stalls 
+                << ", broadcasts=" << smem.broadcasts 
+                << ", bank conflicts=";
+      for (size_t i = 0; i < smem.bank_conflicts.size(); ++i) {
+        std::cout << (i ? "," : "") << smem.bank_conflicts.at(i);
+      }
+      std::cout << std::endl;
+    }
+  }
+
+  for (auto cluster : clusters_) {
+    for (auto core : cluster->cores()) {
+      auto& perf = core->perf_stats();
+      auto decodes = perf.decode_hits + perf.decode_misses;
+      int hit_rate = decodes ? int((perf.decode_hits * 100) / decodes) : 0;
+      std::cout << "PERF: core" << core->id() << ": decode cache hits=" << perf.decode_hits 
+                << ", misses=" << perf.decode_misses 
+                << ", hit rate=" << hit_rate << "%" << std::endl;
+      // share of lane accesses merged into another lane's request
+      int coalesced = perf.lsu_accesses ? int(100 - (perf.lsu_requests * 100) / perf.lsu_accesses) : 0;
+      std::cout << "PERF: core" << core->id() << ": lsu accesses=" << perf.lsu_accesses 
+                << ", requests=" << perf.lsu_requests 
+                << ", coalesced=" << coalesced << "%" << std::endl;
+      if (fast_forward_.enabled) {
+        std::cout << "PERF: core" << core->id() << ": fast-forwarded instrs=" << perf.ff_instrs << std::endl;
+      }
+      auto& tlb = core->tlb_stats();
+      if (tlb.misses != 0) {
+        std::cout << "PERF: core" << core->id() << ": tlb hits=" << tlb.hits 
+                  << ", misses=" << tlb.misses 
+                  << ", walks=" << tlb.walks << std::endl;
+      }
+    }
+  }
+}
+
+ProcessorImpl::PerfStats ProcessorImpl::perf_stats() const {
+  ProcessorImpl::PerfStats perf;
+  perf.mem_reads   = perf_mem_reads_;
+  perf.mem_writes  = perf_mem_writes_;
+  perf.mem_latency = perf_mem_latency_;
+  perf.l3cache     = l3cache_->perf_stats();
+  for (auto cluster : clusters_) {
+    perf.clusters += cluster->perf_stats();
+  }   
+  return perf;
+}
@@ -18,6 +18,9 @@
 #include "constants.h"
 #include "dcrs.h"
 #include "cluster.h"
+#include "decode_cache.h"
+#include "processor.h"
+#include "mem_trace.h"
 
 namespace vortex {
 
@@ -37,30 +40,71 @@ public:
     {}
   };
 
-  ProcessorImpl(const Arch& arch);
+  ProcessorImpl(const Arch& arch, const DramSim::Config& dram_config);
   ~ProcessorImpl();
 
+  static CacheSim::Config l3cache_config(const Arch& arch);
+
   void attach_ram(RAM* mem);
 
   int run(bool riscv_test);
 
   void write_dcr(uint32_t addr, uint32_t value);
 
+  void set_num_threads(uint32_t num_threads);
+
+  void set_fast_forward(const Processor::FastForward& ff);
+
+  bool set_mem_trace(const char* filename);
+
+  void l3cache_warmup(uint64_t addr, bool write);
+
+  void show_stats() const;
+
+  bool save_checkpoint(const char* filename, bool caches) const;
+
+  bool load_checkpoint(const char* filename);
+
   ProcessorImpl::PerfStats perf_stats() const;
 
+  // resets the architectural state for a new run, run() and the rtlsim 
+  // co-simulation then advance it
+  void start();
+
+  // 'index' is the global core id
+  Core::Ptr core(uint32_t index) const;
+
+  CodeRegion& code_region() {
+    return code_region_;
+  }
+
 private:
  
   void reset();
 
+  bool fast_forward(bool riscv_test, Word* exitcode);
+
+  void flush_caches();
+
+  void drain();
+
+  void restore_checkpoint();
+
   const Arch& arch_;
   std::vector<std::shared_ptr<Cluster>> clusters_;
   DCRS dcrs_;
+  CodeRegion    code_region_;
   MemSim::Ptr   memsim_;
   CacheSim::Ptr l3cache_;
   uint64_t perf_mem_reads_;
   uint64_t perf_mem_writes_;
   uint64_t perf_mem_latency_;
   uint64_t perf_mem_pending_reads_;
+  uint32_t num_threads_;
+  Processor::FastForward fast_forward_;
+  RAM*          ram_;
+  std::string   checkpoint_;
+  std::unique_ptr<MemTraceWriter> mem_trace_;
 };
 
 }
@@ -0,0 +1,324 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Replays a memory trace captured with 'simx -T' (or SIMX_MEM_TRACE) through
+// the cache hierarchy and the memory simulator without simulating the cores.
+// Requests are issued open-loop at their recorded cycle, so cache and DRAM
+// configurations can be swept by rebuilding only this tool.
+
+#include <iostream>
+#include <vector>
+#include <stdlib.h>
+#include <unistd.h>
+#include <util.h>
+#include "mem_trace.h"
+#include "cache_cluster.h"
+#include "mem_sim.h"
+#include "cluster.h"
+#include "processor_impl.h"
+#include "constants.h"
+
+using namespace vortex;
+
+namespace {
+
+class TraceDriver : public SimObject<TraceDriver> {
+public:
+  std::vector<SimPort<MemReq>> ReqPorts;
+  std::vector<SimPort<MemRsp>> RspPorts;
+
+  // ports: the icaches of every core, then the dcache lanes of every core,
+  // or a single memory port when replaying the DRAM requests
+  TraceDriver(const SimContext& ctx,
+              const char* name,
+              MemTraceReader* reader,
+              bool dram_only)
+    : SimObject<TraceDriver>(ctx, name)
+    , ReqPorts(num_ports(reader->header(), dram_only), this)
+    , RspPorts(num_ports(reader->header(), dram_only), this)
+    , reader_(reader)
+    , dram_only_(dram_only)
+    , num_cores_(reader->header().num_clusters * reader->header().num_cores)
+    , num_lanes_(reader->header().num_lsu_lanes)
+  {}
+
+  void reset() {
+    requests_ = 0;
+    responses_ = 0;
+    late_ = 0;
+    pending_ = reader_->read(&next_);
+  }
+
+  bool idle() const {
+    if (pending_)
+      return false;
+    for (auto& port : RspPorts) {
+      if (!port.empty())
+        return false;
+    }
+    return true;
+  }
+
+  void tick() {
+    for (auto& port : RspPorts) {
+      while (!port.empty()) {
+        port.pop();
+        ++responses_;
+      }
+    }
+    // issue the requests arriving at the next cycle
+    auto cycle = SimPlatform::instance().cycles();
+    while (pending_ && next_.cycle <= cycle + 1) {
+      int index = this->port_index(next_);
+      if (index >= 0) {
+        late_ += (next_.cycle <= cycle);
+        ReqPorts.at(index).send(to_mem_req(next_), 1);
+        ++requests_;
+      }
+      pending_ = reader_->read(&next_);
+    }
+  }
+
+  uint64_t requests() const {
+    return requests_;
+  }
+
+  uint64_t responses() const {
+    return responses_;
+  }
+
+  uint64_t late() const {
+    return late_;
+  }
+
+private:
+
+  static uint32_t num_ports(const MemTraceHeader& header, bool dram_only) {
+    if (dram_only)
+      return 1;
+    return header.num_clusters * header.num_cores * (1 + header.num_lsu_lanes);
+  }
+
+  int port_index(const MemTraceRecord& record) const {
+    auto source = MemTraceSource(record.source);
+    if (dram_only_)
+      return (source == MemTraceSource::Dram) ? 0 : -1;
+    uint32_t core = record.cluster * reader_->header().num_cores + record.core;
+    if (source == MemTraceSource::ICache)
+      return core;
+    if (source == MemTraceSource::DCache)
+      return num_cores_ + core * num_lanes_ + record.lane;
+    return -1;
+  }
+
+  MemTraceReader* reader_;
+  bool     dram_only_;
+  uint32_t num_cores_;
+  uint32_t num_lanes_;
+  MemTraceRecord next_;
+  bool     pending_;
+  uint64_t requests_;
+  uint64_t responses_;
+  uint64_t late_;
+};
+
+}
+
+static void show_usage() {
+   std::cout << "Usage: [-d <dram: standard=<name>,speed=<name>,org=<name>,channels=<n>,ranks=<n>,latency=<cycles>,bandwidth=<bytes/cycle>>] [-m: dram requests only] [-h: help] <trace>" << std::endl;
+}
+
+DramSim::Config dram_config;
+bool dram_only = false;
+const char* trace = nullptr;
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "d:mh?")) != -1) {
+    switch (c) {
+    case 'd':
+      if (!DramSim::Config::parse(optarg, &dram_config)) {
+        show_usage();
+        exit(-1);
+      }
+      break;
+    case 'm':
+      dram_only = true;
+      break;
+    case 'h':
+    case '?':
+      show_usage();
+      exit(0);
+      break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+
+  if (optind < argc) {
+    trace = argv[optind];
+    std::cout << "Replaying " << trace << "..." << std::endl;
+  } else {
+    show_usage();
+    exit(-1);
+  }
+}
+
+static void drain() {
+  while (SimPlatform::instance().tick());
+}
+
+static void show_cache_stats(const char* name, const CacheSim::PerfStats& perf) {
+  auto accesses = perf.reads + perf.writes;
+  auto misses = perf.read_misses + perf.write_misses;
+  int hit_rate = accesses ? int(100 - (misses * 100) / accesses) : 0;
+  std::cout << "PERF: " << name << ": reads=" << perf.reads
+            << ", writes=" << perf.writes
+            << ", read misses=" << perf.read_misses
+            << ", write misses=" << perf.write_misses
+            << ", hit rate=" << hit_rate << "%"
+            << ", bank stalls=" << perf.bank_stalls
+            << ", mshr stalls=" << perf.mshr_stalls
+            << ", writebacks=" << perf.evictions << std::endl;
+}
+
+int main(int argc, char **argv) {
+  parse_args(argc, argv);
+
+  MemTraceReader reader;
+  if (!reader.open(trace))
+    return -1;
+
+  auto& header = reader.header();
+  if (header.xlen != XLEN
+   || (dram_only ? (header.block_size != MEM_BLOCK_SIZE) : (header.num_lsu_lanes != NUM_LSU_LANES))) {
+    std::cout << "Error: trace configuration mismatch: xlen=" << header.xlen
+              << ", lsu lanes=" << header.num_lsu_lanes
+              << ", block size=" << header.block_size << std::endl;
+    return -1;
+  }
+
+  Arch arch(header.num_threads, header.num_warps, header.num_cores, header.num_clusters);
+
+  SimPlatform::instance().initialize();
+
+  {
+    if (0 == dram_config.channels) {
+      dram_config.channels = MEMORY_BANKS;
+    }
+    auto memsim = MemSim::Create("dram", MemSim::Config{
+      dram_config,
+      uint32_t(arch.num_cores()) * arch.num_clusters()
+    });
+
+    auto driver = TraceDriver::Create("driver", &reader, dram_only);
+
+    CacheSim::Ptr l3cache;
+    std::vector<CacheSim::Ptr> l2caches;
+    std::vector<CacheCluster::Ptr> icaches, dcaches;
+
+    if (dram_only) {
+      driver->ReqPorts.at(0).bind(&memsim->MemReqPort);
+      memsim->MemRspPort.bind(&driver->RspPorts.at(0));
+    } else {
+      // same topology as ProcessorImpl and Cluster
+      l3cache = CacheSim::Create("l3cache", ProcessorImpl::l3cache_config(arch));
+      l3cache->MemReqPort.bind(&memsim->MemReqPort);
+      memsim->MemRspPort.bind(&l3cache->MemRspPort);
+
+      uint32_t num_cores = arch.num_cores();
+      uint32_t total_cores = num_cores * arch.num_clusters();
+
+      char sname[100];
+      for (uint32_t c = 0; c < arch.num_clusters(); ++c) {
+        snprintf(sname, 100, "cluster%d-l2cache", c);
+        auto l2cache = CacheSim::Create(sname, Cluster::l2cache_config(arch));
+        l2cache->MemReqPort.bind(&l3cache->CoreReqPorts.at(c));
+        l3cache->CoreRspPorts.at(c).bind(&l2cache->MemRspPort);
+
+        snprintf(sname, 100, "cluster%d-icaches", c);
+        auto icache = CacheCluster::Create(sname, num_cores, NUM_ICACHES, 1, Cluster::icache_config(arch));
+        icache->MemReqPort.bind(&l2cache->CoreReqPorts.at(0));
+        l2cache->CoreRspPorts.at(0).bind(&icache->MemRspPort);
+
+        snprintf(sname, 100, "cluster%d-dcaches", c);
+        auto dcache = CacheCluster::Create(sname, num_cores, NUM_DCACHES, NUM_LSU_LANES, Cluster::dcache_config(arch));
+        dcache->MemReqPort.bind(&l2cache->CoreReqPorts.at(1));
+        l2cache->CoreRspPorts.at(1).bind(&dcache->MemRspPort);
+
+        for (uint32_t i = 0; i < num_cores; ++i) {
+          uint32_t core = c * num_cores + i;
+          driver->ReqPorts.at(core).bind(&icache->CoreReqPorts.at(i).at(0));
+          icache->CoreRspPorts.at(i).at(0).bind(&driver->RspPorts.at(core));
+          for (uint32_t j = 0; j < NUM_LSU_LANES; ++j) {
+            uint32_t port = total_cores + core * NUM_LSU_LANES + j;
+            driver->ReqPorts.at(port).bind(&dcache->CoreReqPorts.at(i).at(j));
+            dcache->CoreRspPorts.at(i).at(j).bind(&driver->RspPorts.at(port));
+          }
+        }
+
+        l2caches.push_back(l2cache);
+        icaches.push_back(icache);
+        dcaches.push_back(dcache);
+      }
+    }
+
+    SimPlatform::instance().reset();
+
+    drain();
+    auto cycles = SimPlatform::instance().cycles();
+
+    // write back the dirty lines, one level at a time
+    if (!dram_only && (DCACHE_WRITEBACK || L2_WRITEBACK || L3_WRITEBACK)) {
+      for (auto& dcache : dcaches) {
+        dcache->flush();
+      }
+      drain();
+      for (auto& l2cache : l2caches) {
+        l2cache->flush();
+      }
+      drain();
+      l3cache->flush();
+      drain();
+    }
+
+    SimPlatform::instance().sync();
+
+    std::cout << "PERF: requests=" << driver->requests()
+              << ", responses=" << driver->responses()
+              << ", late=" << driver->late()
+              << ", cycles=" << cycles << std::endl;
+
+    if (!dram_only) {
+      CacheSim::PerfStats icache_perf, dcache_perf, l2cache_perf;
+      for (uint32_t c = 0; c < arch.num_clusters(); ++c) {
+        icache_perf += icaches.at(c)->perf_stats();
+        dcache_perf += dcaches.at(c)->perf_stats();
+        l2cache_perf += l2caches.at(c)->perf_stats();
+      }
+      show_cache_stats("icache", icache_perf);
+      show_cache_stats("dcache", dcache_perf);
+      show_cache_stats("l2cache", l2cache_perf);
+      show_cache_stats("l3cache", l3cache->perf_stats());
+    }
+
+    auto& dram = memsim->perf_stats();
+    std::cout << "PERF: dram: reads=" << dram.reads
+              << ", writes=" << dram.writes << std::endl;
+  }
+
+  SimPlatform::instance().finalize();
+
+  return 0;
+}
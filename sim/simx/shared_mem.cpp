@@ -15,6 +15,7 @@
 #include "core.h"
 #include <bitmanip.h>
 #include <vector>
+#include <algorithm>
 #include "types.h"
 
 using namespace vortex;
@@ -24,9 +25,11 @@ protected:
     SharedMem* simobject_;
     Config    config_;
     RAM       ram_;
-    uint32_t  bank_sel_addr_start_;
-    uint32_t  bank_sel_addr_end_;
     PerfStats perf_stats_;
+    std::vector<uint32_t> bank_grants_; // ports granted per bank this cycle
+    std::vector<uint64_t> bank_words_;  // word accessed by each granted port
+
+    static const uint64_t NO_BROADCAST = UINT64_MAX;
 
     uint64_t to_local_addr(uint64_t addr) {
         uint32_t total_lines = config_.capacity / config_.line_size;        
@@ -40,14 +43,17 @@ public:
         : simobject_(simobject)
         , config_(config)
         , ram_(config.capacity, config.capacity)
-        , bank_sel_addr_start_(0)
-        , bank_sel_addr_end_(0 + log2ceil(config.num_banks)-1)
-    {}    
+        , bank_grants_(config.num_banks)
+        , bank_words_(config.num_banks * config.num_ports)
+    {
+        this->reset();
+    }    
     
     virtual ~Impl() {}
 
     void reset() {
         perf_stats_ = PerfStats();
+        perf_stats_.bank_conflicts.resize(config_.num_banks, 0);
     }
 
     void read(void* data, uint64_t addr, uint32_t size) {
@@ -63,7 +69,7 @@ public:
     }
 
     void tick() {
-        std::vector<bool> in_used_banks(config_.num_banks);
+        std::fill(bank_grants_.begin(), bank_grants_.end(), 0);
         for (uint32_t req_id = 0; req_id < config_.num_reqs; ++req_id) {
             auto& core_req_port = simobject_->Inputs.at(req_id);            
             if (core_req_port.empty())
@@ -71,18 +77,45 @@ public:
 
             auto& core_req = core_req_port.front();
 
-            uint32_t bank_id = 0;
-            if (bank_sel_addr_start_ <= bank_sel_addr_end_) {
-                bank_id = (uint32_t)bit_getw(core_req.addr, bank_sel_addr_start_, bank_sel_addr_end_);
-            }
+            // a request accesses consecutive words, which fall in consecutive banks
+            auto s_addr = to_local_addr(core_req.addr);
+            uint32_t size = std::max<uint32_t>(core_req.size, 1);
+            uint64_t word0 = s_addr / config_.line_size;
+            uint32_t num_words = (s_addr + size - 1) / config_.line_size - word0 + 1;
+            bool can_broadcast = config_.broadcast && !core_req.write;
 
             // bank conflict check
-            if (in_used_banks.at(bank_id)) {
+            int conflict = -1;
+            bool shared = false;
+            for (uint32_t i = 0; i < num_words && conflict < 0; ++i) {
+                uint64_t word = word0 + i;
+                uint32_t bank_id = word % config_.num_banks;
+                if (can_broadcast && this->find_word(bank_id, word)) {
+                    shared = true;
+                    continue;
+                }
+                // earlier words of this request using the same bank
+                uint32_t uses = i / config_.num_banks;
+                if (bank_grants_.at(bank_id) + uses >= config_.num_ports) {
+                    conflict = bank_id;
+                }
+            }
+            if (conflict >= 0) {
                 ++perf_stats_.bank_stalls;
+                ++perf_stats_.bank_conflicts.at(conflict);
                 continue;
             }
 
-            in_used_banks.at(bank_id) = true;
+            // claim the bank ports
+            for (uint32_t i = 0; i < num_words; ++i) {
+                uint64_t word = word0 + i;
+                uint32_t bank_id = word % config_.num_banks;
+                if (can_broadcast && this->find_word(bank_id, word))
+                    continue;
+                auto& grants = bank_grants_.at(bank_id);
+                bank_words_.at(bank_id * config_.num_ports + grants) = can_broadcast ? word : NO_BROADCAST;
+                ++grants;
+            }
 
             if (!core_req.write || config_.write_reponse) {
                 // send response
@@ -93,6 +126,7 @@ public:
             // update perf counters
             perf_stats_.reads += !core_req.write;            
             perf_stats_.writes += core_req.write;
+            perf_stats_.broadcasts += shared;
 
             // remove input
             core_req_port.pop();
@@ -102,6 +136,17 @@ public:
     const PerfStats& perf_stats() const { 
         return perf_stats_; 
     }
+
+private:
+
+    bool find_word(uint32_t bank_id, uint64_t word) const {
+        auto words = bank_words_.data() + bank_id * config_.num_ports;
+        for (uint32_t p = 0, n = bank_grants_.at(bank_id); p < n; ++p) {
+            if (words[p] == word)
+                return true;
+        }
+        return false;
+    }
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -133,6 +178,14 @@ void SharedMem::tick() {
     impl_->tick();
 }
 
+bool SharedMem::idle() const {
+    for (auto& input : Inputs) {
+        if (!input.empty())
+            return false;
+    }
+    return true;
+}
+
 const SharedMem::PerfStats& SharedMem::perf_stats() const {
     return impl_->perf_stats();
 }
\ No newline at end of file
@@ -14,17 +14,21 @@
 #pragma once
 
 #include <simobject.h>
+#include <vector>
 #include "types.h"
 
 namespace vortex {
 
 class SharedMem : public SimObject<SharedMem> {
 public:
+  // banks are word-interleaved: word i lives in bank (i % num_banks)
   struct Config {
     uint32_t capacity;
-    uint32_t line_size;
+    uint32_t line_size;   // bank word size
     uint32_t num_reqs;
     uint32_t num_banks;
+    uint32_t num_ports;   // accesses per bank per cycle
+    bool broadcast;       // reads of the same word share a bank access
     bool write_reponse;
   };
 
@@ -32,17 +36,27 @@ public:
     uint64_t reads;
     uint64_t writes;
     uint64_t bank_stalls;
+    uint64_t broadcasts;
+    std::vector<uint64_t> bank_conflicts; // requests stalled, per bank
 
     PerfStats() 
       : reads(0)
       , writes(0)
       , bank_stalls(0)
+      , broadcasts(0)
     {}
 
     PerfStats& operator+=(const PerfStats& rhs) {
       this->reads += rhs.reads;
       this->writes += rhs.writes;
       this->bank_stalls += rhs.bank_stalls;
+      this->broadcasts += rhs.broadcasts;
+      if (this->bank_conflicts.size() < rhs.bank_conflicts.size()) {
+        this->bank_conflicts.resize(rhs.bank_conflicts.size(), 0);
+      }
+      for (size_t i = 0; i < rhs.bank_conflicts.size(); ++i) {
+        this->bank_conflicts.at(i) += rhs.bank_conflicts.at(i);
+      }
       return *this;
     }
   };
@@ -61,6 +75,8 @@ public:
 
   void tick();
 
+  bool idle() const;
+
   const PerfStats& perf_stats() const;
 
 protected:
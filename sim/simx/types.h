@@ -233,19 +233,22 @@ struct MemReq {
   uint32_t tag;
   uint32_t cid;    
   uint64_t uuid;
+  uint32_t size;   // access size in bytes, 0: one word
 
   MemReq(uint64_t _addr = 0, 
           bool _write = false,
           AddrType _type = AddrType::Global,
           uint64_t _tag = 0, 
           uint32_t _cid = 0,
-          uint64_t _uuid = 0
+          uint64_t _uuid = 0,
+          uint32_t _size = 0
   ) : addr(_addr)
     , write(_write)
     , type(_type)
     , tag(_tag)
     , cid(_cid)
     , uuid(_uuid)
+    , size(_size)
   {}
 };
 
@@ -445,6 +448,20 @@ public:
     }
   }
 
+  bool idle() const {
+    if (ReqIn.size() == ReqOut.size())
+      return true;
+    for (auto& req_in : ReqIn) {
+      if (!req_in.empty())
+        return false;
+    }
+    for (auto& rsp_out : RspOut) {
+      if (!rsp_out.empty())
+        return false;
+    }
+    return true;
+  }
+
   void update_cursor(uint32_t index, uint32_t grant) {
     if (type_ == ArbiterType::RoundRobin) {
       cursors_.at(index) = grant + 1;
@@ -487,6 +504,10 @@ public:
 
   void reset() {}
 
+  bool idle() const {
+    return ReqIn.empty() && RspSm.empty() && RspDc.empty();
+  }
+
   void tick() {
     // process incomming requests  
     if (!ReqIn.empty()) {
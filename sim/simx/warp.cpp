@@ -16,10 +16,13 @@
 #include <unistd.h>
 #include <math.h>
 #include <assert.h>
+#include <algorithm>
 #include <util.h>
+#include <serialize.h>
 
 #include "instr.h"
 #include "core.h"
+#include "constants.h"
 
 using namespace vortex;
 
@@ -27,8 +30,9 @@ Warp::Warp(Core *core, uint32_t warp_id)
     : warp_id_(warp_id)
     , arch_(core->arch())
     , core_(core)
-    , ireg_file_(core->arch().num_threads(), std::vector<Word>(core->arch().num_regs()))
-    , freg_file_(core->arch().num_threads(), std::vector<uint64_t>(core->arch().num_regs()))
+    , reg_stride_((core->arch().num_threads() + SIMD_LANES - 1) & ~(SIMD_LANES - 1))
+    , ireg_file_(core->arch().num_regs() * reg_stride_)
+    , freg_file_(core->arch().num_regs() * reg_stride_)
     , vreg_file_(core->arch().num_threads(), std::vector<Byte>(core->arch().vsize()))
 {
   this->reset();
@@ -41,13 +45,9 @@ void Warp::reset() {
 #endif
   tmask_.reset();  
   issued_instrs_ = 0;
+  std::fill(ireg_file_.begin(), ireg_file_.end(), 0);
+  std::fill(freg_file_.begin(), freg_file_.end(), 0);
   for (uint32_t i = 0, n = arch_.num_threads(); i < n; ++i) {
-    for (auto& reg : ireg_file_.at(i)) {
-      reg = 0;
-    }
-    for (auto& reg : freg_file_.at(i)) {
-      reg = 0;
-    }
     for (auto& reg : vreg_file_.at(i)) {
       reg = 0;
     }
@@ -55,6 +55,67 @@ void Warp::reset() {
   uui_gen_.reset();
 }
 
+void Warp::save(std::ostream& os) const {
+  write_pod(os, PC_);
+  write_bits(os, tmask_);
+  write_pod(os, issued_instrs_);
+  write_vector(os, ireg_file_);
+  write_vector(os, freg_file_);
+  for (uint32_t i = 0, n = arch_.num_threads(); i < n; ++i) {
+    write_vector(os, vreg_file_.at(i));
+  }
+
+  // IPDOM entries are stored from bottom to top
+  std::vector<DomStackEntry> entries;
+  for (auto stack = ipdom_stack_; !stack.empty(); stack.pop()) {
+    entries.push_back(stack.top());
+  }
+  write_pod(os, uint32_t(entries.size()));
+  for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+    write_bits(os, it->tmask);
+    write_pod(os, it->PC);
+    write_pod(os, it->fallthrough);
+  }
+
+  write_pod(os, vtype_);
+  write_pod(os, vl_);
+}
+
+void Warp::load(std::istream& is) {
+  read_pod(is, &PC_);
+  read_bits(is, &tmask_);
+  read_pod(is, &issued_instrs_);
+  read_vector(is, &ireg_file_);
+  read_vector(is, &freg_file_);
+  for (uint32_t i = 0, n = arch_.num_threads(); i < n; ++i) {
+    read_vector(is, &vreg_file_.at(i));
+  }
+
+  ipdom_stack_ = std::stack<DomStackEntry>();
+  uint32_t num_entries = 0;
+  read_pod(is, &num_entries);
+  for (uint32_t i = 0; i < num_entries && is; ++i) {
+    DomStackEntry entry((ThreadMask()));
+    read_bits(is, &entry.tmask);
+    read_pod(is, &entry.PC);
+    read_pod(is, &entry.fallthrough);
+    ipdom_stack_.push(entry);
+  }
+
+  read_pod(is, &vtype_);
+  read_pod(is, &vl_);
+}
+
+// the simulator does not raise exceptions to the program: a failed
+// translation ends the simulation like an invalid instruction
+void Warp::page_fault(const MemoryUnit::PageFault& fault, uint64_t uuid) const {
+  std::cout << std::hex << "Error: page fault at PC=0x" << PC_ 
+            << ", addr=0x" << fault.faultAddr 
+            << (fault.notFound ? " (not mapped)" : " (access denied)") 
+            << " (#" << std::dec << uuid << ")" << std::endl;
+  std::abort();
+}
+
 pipeline_trace_t* Warp::eval() {
   assert(tmask_.any());
 
@@ -73,16 +134,25 @@ pipeline_trace_t* Warp::eval() {
     DPN(1, tmask_.test(i));
   DPN(1, ", PC=0x" << std::hex << PC_ << " (#" << std::dec << uuid << ")" << std::endl);
 
-  // Fetch
+  // Fetch + Decode
   uint32_t instr_code = 0;
-  core_->icache_read(&instr_code, PC_, sizeof(uint32_t));
-
-  // Decode
-  auto instr = core_->decoder_.decode(instr_code);
-  if (!instr) {
-    std::cout << std::hex << "Error: invalid instruction 0x" << instr_code << ", at PC=0x" << PC_ << " (#" << std::dec << uuid << ")" << std::endl;
-    std::abort();
-  }  
+  auto instr = core_->decode_cache_.lookup(PC_, &instr_code);
+  if (instr) {
+    ++core_->perf_stats_.decode_hits;
+  } else {
+    try {
+      core_->icache_read(&instr_code, PC_, sizeof(uint32_t));
+    } catch (const MemoryUnit::PageFault& fault) {
+      this->page_fault(fault, uuid);
+    }
+    auto decoded = core_->decoder_.decode(instr_code);
+    if (!decoded) {
+      std::cout << std::hex << "Error: invalid instruction 0x" << instr_code << ", at PC=0x" << PC_ << " (#" << std::dec << uuid << ")" << std::endl;
+      std::abort();
+    }
+    instr = core_->decode_cache_.insert(PC_, instr_code, decoded);
+    ++core_->perf_stats_.decode_misses;
+  }
 
   DP(1, "Instr 0x" << std::hex << instr_code << ": " << *instr);
 
@@ -95,20 +165,43 @@ pipeline_trace_t* Warp::eval() {
   trace->rdest = instr->getRDest();
   trace->rdest_type = instr->getRDType();
     
+  // SoftFloat keeps its rounding mode and flags in globals, floating-point
+  // instructions execute in the sequential cluster order (see wait_turn)
+  switch (instr->getOpcode()) {
+  case Opcode::FCI:
+  case Opcode::FMADD:
+  case Opcode::FMSUB:
+  case Opcode::FMNMADD:
+  case Opcode::FMNMSUB:
+  case Opcode::VSET:
+    SimPlatform::instance().wait_turn();
+    break;
+  default:
+    break;
+  }
+
   // Execute
-  this->execute(*instr, trace);
+  auto tlb_misses = core_->mmu_.tlbStats().misses;
+  try {
+    this->execute(*instr, trace);
+  } catch (const MemoryUnit::PageFault& fault) {
+    this->page_fault(fault, uuid);
+  }
+  if (trace->exe_type == ExeType::LSU) {
+    trace->data.lsu.tlb_misses = core_->mmu_.tlbStats().misses - tlb_misses;
+  }
 
   DP(5, "Register state:");
   for (uint32_t i = 0; i < arch_.num_regs(); ++i) {
     DPN(5, "  %r" << std::setfill('0') << std::setw(2) << std::dec << i << ':');
     // Integer register file
     for (uint32_t j = 0; j < arch_.num_threads(); ++j) {
-      DPN(5, ' ' << std::setfill('0') << std::setw(XLEN/4) << std::hex << ireg_file_.at(j).at(i) << std::setfill(' ') << ' ');
+      DPN(5, ' ' << std::setfill('0') << std::setw(XLEN/4) << std::hex << ireg_file_.at(i * reg_stride_ + j) << std::setfill(' ') << ' ');
     }
     DPN(5, '|');
     // Floating point register file
     for (uint32_t j = 0; j < arch_.num_threads(); ++j) {
-      DPN(5, ' ' << std::setfill('0') << std::setw(16) << std::hex << freg_file_.at(j).at(i) << std::setfill(' ') << ' ');
+      DPN(5, ' ' << std::setfill('0') << std::setw(16) << std::hex << freg_file_.at(i * reg_stride_ + j) << std::setfill(' ') << ' ');
     }
     DPN(5, std::endl);
   }  
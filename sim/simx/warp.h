@@ -16,7 +16,9 @@
 
 #include <vector>
 #include <stack>
+#include <iostream>
 #include "types.h"
+#include "mem.h"
 
 namespace vortex {
 
@@ -75,8 +77,16 @@ public:
     return tmask_.to_ulong();
   }
 
-  Word getIRegValue(uint32_t reg) const {
-    return ireg_file_.at(0).at(reg);
+  Word getIRegValue(uint32_t reg, uint32_t tid = 0) const {
+    return ireg_file_.at(reg * reg_stride_ + tid);
+  }
+
+  void setIRegValue(uint32_t reg, uint32_t tid, Word value) {
+    ireg_file_.at(reg * reg_stride_ + tid) = value;
+  }
+
+  uint64_t getFRegValue(uint32_t reg, uint32_t tid) const {
+    return freg_file_.at(reg * reg_stride_ + tid);
   }
 
   uint64_t incr_instrs() {
@@ -85,10 +95,16 @@ public:
 
   pipeline_trace_t* eval();
 
+  void save(std::ostream& os) const;
+
+  void load(std::istream& is);
+
 private:
 
   void execute(const Instr &instr, pipeline_trace_t *trace);
 
+  [[noreturn]] void page_fault(const MemoryUnit::PageFault& fault, uint64_t uuid) const;
+
   UUIDGenerator uui_gen_;
   
   uint32_t warp_id_;
@@ -99,8 +115,10 @@ private:
   Word PC_;
   ThreadMask tmask_;
 
-  std::vector<std::vector<Word>>     ireg_file_;
-  std::vector<std::vector<uint64_t>> freg_file_;
+  // scalar register files are laid out [reg][thread]
+  uint32_t                           reg_stride_;
+  std::vector<Word>                  ireg_file_;
+  std::vector<uint64_t>              freg_file_;
   std::vector<std::vector<Byte>>     vreg_file_;
   std::stack<DomStackEntry>          ipdom_stack_;
 
@@ -0,0 +1,120 @@
+#include <dram_sim.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// Builds every advertised ramulator standard from its VORTEX_DRAM spec, with
+// the channel count the simulators preset, and checks that reads complete.
+// Channel and rank counts a standard does not support must be rejected.
+// ramulator keeps global statistics, each device is built in its own process.
+
+using namespace vortex;
+
+static const char* standards[] = {
+  "DDR3", "DDR4", "LPDDR3", "LPDDR4", "GDDR5", "HBM", "WideIO", "WideIO2"
+};
+
+static const char* invalid_specs[] = {
+  "standard=HBM,channels=2",
+  "standard=WideIO,channels=8",
+  "standard=WideIO2,channels=2",
+  "standard=WideIO2,channels=16",
+  "standard=LPDDR4,channels=1",
+  "standard=DDR4,channels=3",
+  "standard=GDDR5,ranks=2",
+  "standard=WideIO2,ranks=4",
+};
+
+static uint32_t num_reads  = 64;
+static uint32_t block_size = 64;
+static uint32_t channels   = 2;
+
+static void show_usage() {
+  printf("Usage: [-n reads] [-c preset channels] [-h: help]\n");
+}
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "n:c:h?")) != -1) {
+    switch (c) {
+    case 'n':
+      num_reads = atoi(optarg);
+      break;
+    case 'c':
+      channels = atoi(optarg);
+      break;
+    case 'h':
+    case '?':
+      show_usage();
+      exit(0);
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+}
+
+static bool test_standard(const char* name) {
+  std::string spec = std::string("standard=") + name;
+  DramSim::Config config;
+  config.channels = channels;
+  if (!DramSim::Config::parse(spec.c_str(), &config)) {
+    printf("Error: %s: spec rejected\n", spec.c_str());
+    return false;
+  }
+
+  DramSim dram(config, block_size, 1);
+  uint32_t sent = 0;
+  uint32_t completed = 0;
+  for (uint64_t cycle = 0; cycle < 100000 && completed < num_reads; ++cycle) {
+    if (sent < num_reads) {
+      uint64_t addr = uint64_t(sent) * block_size * 17;
+      if (dram.send(addr, false, 0, [&]() { ++completed; }))
+        ++sent;
+    }
+    dram.tick();
+  }
+  if (completed != num_reads) {
+    printf("Error: %s: %d of %d reads completed\n", name, completed, num_reads);
+    return false;
+  }
+  printf("%s: channels=%d, ranks=%d\n", name, config.channels, config.ranks);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  parse_args(argc, argv);
+
+  int errors = 0;
+
+  for (auto name : standards) {
+    fflush(stdout);
+    auto pid = fork();
+    if (pid == 0) {
+      exit(test_standard(name) ? 0 : 1);
+    }
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid 
+     || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      printf("Error: %s: test failed\n", name);
+      ++errors;
+    }
+  }
+
+  for (auto spec : invalid_specs) {
+    DramSim::Config config;
+    config.channels = channels;
+    if (DramSim::Config::parse(spec, &config)) {
+      printf("Error: %s: spec accepted\n", spec);
+      ++errors;
+    }
+  }
+
+  if (errors != 0) {
+    printf("FAILED! (%d errors)\n", errors);
+    return 1;
+  }
+  printf("PASSED!\n");
+  return 0;
+}
@@ -0,0 +1,218 @@
+#include <cache_mshr.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+#include <chrono>
+
+using namespace vortex;
+
+static uint32_t num_tests = 200000;
+static uint32_t mshr_size = 64;
+static uint32_t seed      = 0;
+
+static void show_usage() {
+  printf("Usage: [-n tests] [-m mshr size] [-s seed] [-h: help]\n");
+}
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "n:m:s:h?")) != -1) {
+    switch (c) {
+    case 'n':
+      num_tests = atoi(optarg);
+      break;
+    case 'm':
+      mshr_size = atoi(optarg);
+      break;
+    case 's':
+      seed = atoi(optarg);
+      break;
+    case 'h':
+    case '?':
+      show_usage();
+      exit(0);
+      break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+}
+
+// Reference model: linear scans over the entries
+class RefMSHR {
+public:
+  RefMSHR(uint32_t size, uint32_t num_ports)
+    : entries_(size, num_ports)
+    , size_(0) {
+    for (auto& entry : entries_) {
+      entry.clear();
+    }
+  }
+
+  bool full() const {
+    return (size_ == entries_.size());
+  }
+
+  bool lookup(const bank_req_t& bank_req) const {
+    for (auto& entry : entries_) {
+      if (entry.bank_req.type != bank_req_t::None
+       && entry.bank_req.set_id == bank_req.set_id 
+       && entry.bank_req.tag == bank_req.tag) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  int allocate(const bank_req_t& bank_req, uint32_t line_id) {
+    for (uint32_t i = 0, n = entries_.size(); i < n; ++i) {
+      auto& entry = entries_.at(i);
+      if (entry.bank_req.type == bank_req_t::None) {
+        entry.bank_req = bank_req;
+        entry.line_id = line_id;  
+        ++size_;              
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  mshr_entry_t& replay(uint32_t id) {
+    auto& root_entry = entries_.at(id);
+    for (auto& entry : entries_) {
+      if (entry.bank_req.type == bank_req_t::Core 
+       && entry.bank_req.set_id == root_entry.bank_req.set_id 
+       && entry.bank_req.tag == root_entry.bank_req.tag) {
+        entry.bank_req.type = bank_req_t::Replay;
+      }
+    }
+    return root_entry;
+  }
+
+  bool pop(bank_req_t* out) {
+    for (auto& entry : entries_) {
+      if (entry.bank_req.type == bank_req_t::Replay) {
+        *out = entry.bank_req;
+        entry.bank_req.type = bank_req_t::None;
+        --size_;
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  std::vector<mshr_entry_t> entries_;
+  uint32_t size_;
+};
+
+static uint32_t rand32(uint64_t* state) {
+  *state = *state * 6364136223846793005ull + 1442695040888963407ull;
+  return *state >> 33;
+}
+
+// drives both models with the same cache bank request sequence
+template <typename M, typename R>
+static int run(M& mshr, R* ref, uint64_t* checksum) {
+  uint64_t state = seed + 1;
+  uint32_t num_lines = mshr_size / 2;
+  std::vector<int> fills; // entries with an outstanding memory fill
+  bank_req_t bank_req(1);
+  bank_req_t out(1), ref_out(1);
+  for (uint32_t n = 0; n < num_tests; ++n) {
+    uint32_t op = rand32(&state) % 4;
+    if (op < 2 && !mshr.full()) {
+      // core miss
+      uint32_t line = rand32(&state) % num_lines;
+      bank_req.tag    = line / 4;
+      bank_req.set_id = line % 4;
+      bank_req.type   = bank_req_t::Core;
+      bank_req.ports.at(0) = bank_req_port_t{0, n, true};
+      bool pending = mshr.lookup(bank_req);
+      int id = mshr.allocate(bank_req, line % 2);
+      if (!pending) {
+        fills.push_back(id);
+      }
+      *checksum = *checksum * 31 + id + pending;
+      if (ref) {
+        bool ref_pending = ref->lookup(bank_req);
+        int ref_id = ref->allocate(bank_req, line % 2);
+        if (ref_pending != pending || ref_id != id) {
+          printf("Error: allocate mismatch at #%u: id=%d/%d, pending=%d/%d\n", 
+            n, id, ref_id, pending, ref_pending);
+          return -1;
+        }
+      }
+    } else if (op == 2 && !fills.empty()) {
+      // memory fill
+      uint32_t i = rand32(&state) % fills.size();
+      int id = fills.at(i);
+      fills.erase(fills.begin() + i);
+      auto& entry = mshr.replay(id);
+      *checksum = *checksum * 31 + entry.line_id;
+      if (ref) {
+        auto& ref_entry = ref->replay(id);
+        if (ref_entry.line_id != entry.line_id) {
+          printf("Error: replay mismatch at #%u: id=%d\n", n, id);
+          return -1;
+        }
+      }
+    } else {
+      // replay
+      bool valid = mshr.pop(&out);
+      if (valid) {
+        *checksum = *checksum * 31 + out.ports.at(0).req_tag;
+      }
+      if (ref) {
+        bool ref_valid = ref->pop(&ref_out);
+        if (ref_valid != valid
+         || (valid && ref_out.ports.at(0).req_tag != out.ports.at(0).req_tag)) {
+          printf("Error: replay order mismatch at #%u\n", n);
+          return -1;
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  parse_args(argc, argv);
+
+  {
+    MSHR mshr(mshr_size, 1);
+    RefMSHR ref(mshr_size, 1);
+    uint64_t checksum = 0;
+    if (run(mshr, &ref, &checksum))
+      return -1;
+  }
+
+  // compare against the linear scans
+  uint64_t checksums[2] = {0, 0};
+  double times[2];
+  {
+    MSHR mshr(mshr_size, 1);
+    auto start = std::chrono::high_resolution_clock::now();
+    run<MSHR, RefMSHR>(mshr, nullptr, &checksums[0]);
+    auto end = std::chrono::high_resolution_clock::now();
+    times[0] = std::chrono::duration<double>(end - start).count();
+  }
+  {
+    RefMSHR mshr(mshr_size, 1);
+    auto start = std::chrono::high_resolution_clock::now();
+    run<RefMSHR, RefMSHR>(mshr, nullptr, &checksums[1]);
+    auto end = std::chrono::high_resolution_clock::now();
+    times[1] = std::chrono::duration<double>(end - start).count();
+  }
+  if (checksums[0] != checksums[1]) {
+    printf("Error: checksum mismatch!\n");
+    return -1;
+  }
+  printf("mshr size=%u: indexed=%.3fs, linear=%.3fs\n", mshr_size, times[0], times[1]);
+
+  printf("PASSED!\n");
+
+  return 0;
+}
@@ -0,0 +1,321 @@
+#include <mem.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string.h>
+#include <map>
+#include <vector>
+#include <sstream>
+#include <chrono>
+
+using namespace vortex;
+
+static uint32_t num_tests = 10000;
+static uint32_t seed      = 0;
+static uint32_t page_size = 4096;
+
+static void show_usage() {
+  printf("Usage: [-n tests] [-s seed] [-p page_size] [-h: help]\n");
+}
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "n:s:p:h?")) != -1) {
+    switch (c) {
+    case 'n':
+      num_tests = atoi(optarg);
+      break;
+    case 's':
+      seed = atoi(optarg);
+      break;
+    case 'p':
+      page_size = atoi(optarg);
+      break;
+    case 'h':
+    case '?':
+      show_usage();
+      exit(0);
+      break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+}
+
+// Byte-level reference model: unwritten bytes read as "baadf00d".
+class RefMemory {
+public:
+  uint8_t read(uint64_t addr) const {
+    auto it = bytes_.find(addr);
+    if (it != bytes_.end())
+      return it->second;
+    return (0xbaadf00d >> ((addr & 0x3) * 8)) & 0xff;
+  }
+
+  void write(uint64_t addr, uint8_t value) {
+    bytes_[addr] = value;
+  }
+
+private:
+  std::map<uint64_t, uint8_t> bytes_;
+};
+
+static uint64_t rand64(uint64_t* state) {
+  *state = *state * 6364136223846793005ull + 1442695040888963407ull;
+  return *state >> 11;
+}
+
+static int check(RAM& ram, const RefMemory& ref, uint64_t addr, uint64_t size) {
+  std::vector<uint8_t> data(size);
+  ram.read(data.data(), addr, size);
+  for (uint64_t i = 0; i < size; ++i) {
+    if (data[i] != ref.read(addr + i)) {
+      printf("Error: mismatch at 0x%lx: actual=0x%x, expected=0x%x\n", 
+        addr + i, data[i], ref.read(addr + i));
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  parse_args(argc, argv);
+
+  // regions near page, leaf table and sparse directory boundaries
+  const uint64_t bases[] = {
+    0x0, 
+    0x80000000, 
+    0x1FF000000ull - 3 * page_size, 
+    uint64_t(page_size) << 30, 
+    0xfffffffffff00000ull
+  };
+
+  RAM ram(page_size);
+  RefMemory ref;
+  uint64_t state = seed + 1;
+
+  for (uint32_t n = 0; n < num_tests; ++n) {
+    uint64_t base = bases[rand64(&state) % (sizeof(bases) / sizeof(bases[0]))];
+    uint64_t addr = base + rand64(&state) % (8 * page_size);
+    uint64_t size = 1 + rand64(&state) % ((rand64(&state) & 1) ? 8 : 3 * page_size);
+    if (addr + size < addr) {
+      size = 0 - addr;
+    }
+    if (rand64(&state) & 1) {
+      std::vector<uint8_t> data(size);
+      for (auto& byte : data) {
+        byte = rand64(&state);
+      }
+      ram.write(data.data(), addr, size);
+      for (uint64_t i = 0; i < size; ++i) {
+        ref.write(addr + i, data[i]);
+      }
+    } else {
+      if (check(ram, ref, addr, size))
+        return -1;
+    }
+  }
+
+  // checkpoint round trip
+  {
+    std::stringstream ss;
+    ram.save(ss);
+    RAM ram2(page_size);
+    if (!ram2.load(ss) || ram2.size() != ram.size()) {
+      printf("Error: checkpoint reload failed!\n");
+      return -1;
+    }
+    for (auto base : bases) {
+      if (check(ram2, ref, base, 8 * page_size))
+        return -1;
+    }
+  }
+
+  // capacity limit
+  {
+    RAM ram3(page_size, 16 * page_size);
+    uint32_t value = 0;
+    bool caught = false;
+    try {
+      ram3.write(&value, 16 * page_size - 2, sizeof(value));
+    } catch (const OutOfRange&) {
+      caught = true;
+    }
+    if (!caught) {
+      printf("Error: out-of-range access not detected!\n");
+      return -1;
+    }
+  }
+
+  // memory-mapped RAM, with checkpoint and sparse image round trips
+  {
+    uint64_t capacity = 1ull << 33;
+    MappedRAM mram(page_size, capacity);
+    std::map<uint64_t, uint8_t> ref;
+    for (uint32_t n = 0; n < num_tests / 50; ++n) {
+      uint64_t addr = rand64(&state) % capacity;
+      uint64_t size = 1 + rand64(&state) % (2 * page_size);
+      if (addr + size > capacity) {
+        size = capacity - addr;
+      }
+      std::vector<uint8_t> data(size);
+      for (auto& byte : data) {
+        byte = rand64(&state) | 1;
+      }
+      mram.write(data.data(), addr, size);
+      for (uint64_t i = 0; i < size; ++i) {
+        ref[addr + i] = data[i];
+      }
+    }
+    auto check_mapped = [&](RAM& ram)->int {
+      for (auto& entry : ref) {
+        uint8_t value;
+        ram.read(&value, entry.first, 1);
+        if (value != entry.second) {
+          printf("Error: mapped mismatch at 0x%lx: actual=0x%x, expected=0x%x\n", 
+            entry.first, value, entry.second);
+          return -1;
+        }
+      }
+      return 0;
+    };
+    if (check_mapped(mram))
+      return -1;
+
+    std::stringstream ss;
+    mram.save(ss);
+    MappedRAM mram2(page_size, capacity);
+    if (!mram2.load(ss) || check_mapped(mram2) || mram2.size() != mram.size()) {
+      printf("Error: mapped checkpoint reload failed!\n");
+      return -1;
+    }
+
+    char image[] = "/tmp/ramXXXXXX";
+    int fd = mkstemp(image);
+    if (fd < 0) {
+      printf("Error: cannot create temporary file!\n");
+      return -1;
+    }
+    close(fd);
+    MappedRAM mram3(page_size, capacity);
+    bool success = mram.saveImage(image);
+    // evict the image from the page cache, its pages must still be saved
+    fd = open(image, O_RDONLY);
+    success &= (fd >= 0) && (0 == fsync(fd)) 
+            && (0 == posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED));
+    close(fd);
+    success = success
+           && mram3.loadImage(image) 
+           && (mram3.size() == mram.size())
+           && !check_mapped(mram3);
+    uint8_t zero = 0xff;
+    mram3.read(&zero, capacity - 1, 1);
+    success &= (zero == 0) || (ref.count(capacity - 1) != 0);
+    unlink(image);
+    if (!success) {
+      printf("Error: mapped image reload failed!\n");
+      return -1;
+    }
+    printf("mapped pages: %lu\n", mram.size() / page_size);
+  }
+
+  // Sv32 page-table walks through the TLB
+  {
+    RAM ram5(page_size);
+    MemoryUnit mmu;
+    mmu.attach(ram5, 0, 0xffffffff);
+    mmu.setTLB(4, 4, 2);
+    auto pte = [&](uint64_t table, uint32_t index, uint32_t ppn, uint32_t flags) {
+      uint32_t value = (ppn << 10) | flags;
+      ram5.write(&value, table * 4096 + index * 4, 4);
+    };
+    // 0x40000000 -> 0x200000 (4KB, RW), 0x40400000 -> 0x400000 (4MB, R),
+    // 0x40001000 -> 0x201000 (4KB, X), 0x40002000 -> 0x202000 (4KB, RW,
+    // supervisor only), user pages unless noted
+    pte(0x100, 0x100, 0x101, 0x1);
+    pte(0x101, 0x000, 0x200, 0x17);
+    pte(0x100, 0x101, 0x400, 0x13);
+    pte(0x101, 0x001, 0x201, 0x19);
+    pte(0x101, 0x002, 0x202, 0x7);
+    mmu.setVM(MemoryUnit::VMMode::Sv32, 0x100);
+
+    uint32_t value = 0x12345678, result = 0;
+    mmu.write(&value, 0x40000010, 4, false);
+    ram5.read(&result, 0x200010, 4);
+    bool success = (result == value);
+    mmu.read(&result, 0x40000010, 4, false);
+    success &= (result == value);
+    success &= (mmu.peekPhyAddr(0x40000020) == 0x200020);
+
+    value = 0xcafe;
+    ram5.write(&value, 0x4a3008, 4);
+    mmu.read(&result, 0x404a3008, 4, false);
+    success &= (result == value);
+
+    auto& stats = mmu.tlbStats();
+    success &= (stats.walks == 2 && stats.misses == 2 && stats.hits == 1);
+
+    bool denied = false;
+    try {
+      mmu.write(&value, 0x40400000, 4, false);
+    } catch (const MemoryUnit::PageFault& fault) {
+      denied = !fault.notFound;
+    }
+    bool unmapped = false;
+    try {
+      mmu.read(&result, 0x80000000, 4, false);
+    } catch (const MemoryUnit::PageFault& fault) {
+      unmapped = fault.notFound;
+    }
+
+    // loads need R, fetches need X, and PTE_U selects the privilege
+    auto faults = [&](uint64_t addr, bool sup, bool fetch) {
+      try {
+        mmu.read(&result, addr, 4, sup, fetch);
+      } catch (const MemoryUnit::PageFault& fault) {
+        return !fault.notFound;
+      }
+      return false;
+    };
+    success &= !faults(0x40001000, false, true);
+    success &= faults(0x40001000, false, false);
+    success &= faults(0x40000000, false, true);
+    success &= !faults(0x40002000, true, false);
+    success &= faults(0x40002000, false, false);
+    success &= faults(0x40000000, true, false);
+
+    // remapping takes effect after a flush
+    pte(0x101, 0x000, 0x300, 0x17);
+    mmu.tlbFlush();
+    success &= (mmu.peekPhyAddr(0x40000010) == 0x40000010);
+    value = 0x55aa;
+    mmu.write(&value, 0x40000010, 4, false);
+    ram5.read(&result, 0x300010, 4);
+    success &= (result == value);
+
+    if (!success || !denied || !unmapped) {
+      printf("Error: virtual memory translation failed!\n");
+      return -1;
+    }
+  }
+
+  // bulk upload throughput
+  {
+    uint64_t size = 64 << 20;
+    std::vector<uint8_t> data(size, 0x5a);
+    RAM ram4(page_size);
+    auto start = std::chrono::high_resolution_clock::now();
+    ram4.write(data.data(), 0x80000000, size);
+    ram4.read(data.data(), 0x80000000, size);
+    auto end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    printf("bulk copy: %lu MB in %.3fs\n", (2 * size) >> 20, seconds);
+  }
+
+  printf("allocated pages: %lu\n", ram.size() / page_size);
+  printf("PASSED!\n");
+
+  return 0;
+}
@@ -0,0 +1,129 @@
+#include <rvfloats.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <random>
+
+// Checks the host FPU path of rv_fop_s_lanes() against SoftFloat, lane by
+// lane, as used by the simulator: lanes returned in the fallback mask are
+// evaluated with SoftFloat and all flags are merged.
+
+static uint32_t num_tests = 200000;
+static uint32_t seed = 0;
+
+static void show_usage() {
+  printf("Usage: [-n tests] [-s seed] [-h: help]\n");
+}
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "n:s:h?")) != -1) {
+    switch (c) {
+    case 'n':
+      num_tests = atoi(optarg);
+      break;
+    case 's':
+      seed = atoi(optarg);
+      break;
+    case 'h':
+    case '?':
+      show_usage();
+      exit(0);
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+}
+
+static uint32_t soft_fop(uint32_t op, uint32_t a, uint32_t b, uint32_t c, uint32_t* fflags) {
+  switch (op) {
+  case RV_FOP_ADD:   return rv_fadd_s(a, b, 0, fflags);
+  case RV_FOP_SUB:   return rv_fsub_s(a, b, 0, fflags);
+  case RV_FOP_MUL:   return rv_fmul_s(a, b, 0, fflags);
+  case RV_FOP_DIV:   return rv_fdiv_s(a, b, 0, fflags);
+  case RV_FOP_MADD:  return rv_fmadd_s(a, b, c, 0, fflags);
+  case RV_FOP_MSUB:  return rv_fmsub_s(a, b, c, 0, fflags);
+  case RV_FOP_NMADD: return rv_fnmadd_s(a, b, c, 0, fflags);
+  default:           return rv_fnmsub_s(a, b, c, 0, fflags);
+  }
+}
+
+// random values biased towards the corner cases of the host path
+static uint32_t gen_value(std::mt19937& rng) {
+  uint32_t sign = (rng() & 0x1) << 31;
+  uint32_t mant = rng() & 0x7fffff;
+  switch (rng() % 8) {
+  case 0: return sign | (0xff << 23) | ((rng() & 0x1) ? mant : 0); // inf/NaN
+  case 1: return sign | ((rng() & 0x1) ? mant : 0);                // subnormal/zero
+  case 2: return sign | ((1 + rng() % 24) << 23) | mant;           // tiny
+  case 3: return sign | ((230 + rng() % 25) << 23) | mant;         // huge
+  case 4: return sign | (127 << 23) | (mant & 0x7);                // close to one
+  default: return sign | ((1 + rng() % 254) << 23) | mant;         // normal
+  }
+}
+
+int main(int argc, char **argv) {
+  parse_args(argc, argv);
+
+  std::mt19937 rng(seed);
+  uint32_t num_lanes = 32;
+  uint32_t errors = 0;
+  uint64_t native_lanes = 0, total_lanes = 0;
+
+  for (uint32_t n = 0; n < num_tests; ++n) {
+    uint32_t op = rng() % 8;
+    uint32_t mask = (n & 0x1) ? rng() : 0xffffffff;
+    uint32_t a[32], b[32], c[32], r[32];
+    for (uint32_t t = 0; t < num_lanes; ++t) {
+      a[t] = gen_value(rng);
+      b[t] = (rng() % 16 == 0) ? (a[t] ^ 0x80000000) : gen_value(rng);
+      c[t] = (rng() % 16 == 0) ? (a[t] ^ 0x80000000) : gen_value(rng);
+      if (rng() % 16 == 0) {
+        // (1+2^-12)^2 is a float midpoint, a tiny addend breaks the tie
+        a[t] = 0x3f800800 | (rng() & 0x80000000);
+        b[t] = 0x3f800800 | (rng() & 0x80000000);
+        c[t] = 0x17800000 | (rng() & 0x80000000);
+      }
+    }
+
+    uint32_t fflags = 0;
+    uint32_t soft_mask = rv_fop_s_lanes(op, a, b, c, r, num_lanes, mask, &fflags);
+
+    uint32_t ref_fflags = 0;
+    for (uint32_t t = 0; t < num_lanes; ++t) {
+      if (!((mask >> t) & 0x1))
+        continue;
+      uint32_t lane_fflags = 0;
+      uint32_t ref = soft_fop(op, a[t], b[t], c[t], &lane_fflags);
+      ref_fflags |= lane_fflags;
+      ++total_lanes;
+      if ((soft_mask >> t) & 0x1) {
+        fflags |= lane_fflags;
+        continue;
+      }
+      ++native_lanes;
+      if (r[t] != ref) {
+        if (errors < 10) {
+          printf("Error: op=%d, lane=%d, a=0x%08x, b=0x%08x, c=0x%08x: result=0x%08x, expected=0x%08x\n", 
+                 op, t, a[t], b[t], c[t], r[t], ref);
+        }
+        ++errors;
+      }
+    }
+    if (fflags != ref_fflags) {
+      if (errors < 10) {
+        printf("Error: op=%d, fflags=0x%x, expected=0x%x\n", op, fflags, ref_fflags);
+      }
+      ++errors;
+    }
+  }
+
+  printf("native lanes: %lu of %lu\n", native_lanes, total_lanes);
+  if (errors != 0) {
+    printf("FAILED! (%d errors)\n", errors);
+    return 1;
+  }
+  printf("PASSED!\n");
+  return 0;
+}
@@ -0,0 +1,233 @@
+#include <simobject.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+
+// Reference scheduler reproducing the original linear std::list scan
+// over shared_ptr-wrapped events.
+class ListEventQueue {
+public:
+  void push(SimEventBase* event, uint64_t /*cycles*/) {
+    events_.emplace_back(event);
+  }
+
+  void fire(uint64_t cycles) {
+    auto evt_it = events_.begin();
+    auto evt_it_end = events_.end();
+    while (evt_it != evt_it_end) {
+      auto& event = *evt_it;
+      if (cycles >= event->cycles()) {
+        event->fire();
+        evt_it = events_.erase(evt_it);
+      } else {
+        ++evt_it;
+      }
+    }
+  }
+
+  void advance(uint64_t /*cycles*/) {}
+
+private:
+  std::list<std::shared_ptr<SimEventBase>> events_;
+};
+
+static uint64_t num_cycles = 20000;
+static uint32_t fanout     = 32;
+static uint32_t max_delay  = 512;
+
+static void show_usage() {
+  printf("Usage: [-c cycles] [-f fanout] [-d max_delay] [-h: help]\n");
+}
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "c:f:d:h?")) != -1) {
+    switch (c) {
+    case 'c':
+      num_cycles = atoi(optarg);
+      break;
+    case 'f':
+      fanout = atoi(optarg);
+      break;
+    case 'd':
+      max_delay = atoi(optarg);
+      break;
+    case 'h':
+    case '?':
+      show_usage();
+      exit(0);
+      break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+}
+
+struct bench_result_t {
+  uint64_t events;
+  uint64_t checksum;
+  double   seconds;
+};
+
+template <typename Queue>
+static bench_result_t run_bench(Queue& queue) {
+  bench_result_t result{0, 0, 0};
+  uint64_t seed = 1;
+  auto callback = [&](const uint32_t& pkt) {
+    result.checksum = result.checksum * 31 + pkt;
+    ++result.events;
+  };
+  auto start = std::chrono::high_resolution_clock::now();
+  for (uint64_t cycle = 0; cycle < num_cycles; ++cycle) {
+    queue.fire(cycle);
+    for (uint32_t i = 0; i < fanout; ++i) {
+      seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+      uint64_t delay = 1 + ((seed >> 33) % max_delay);
+      auto evt = new SimCallEvent<uint32_t>(callback, uint32_t(seed >> 40), cycle + delay);
+      queue.push(evt, cycle);
+    }
+    queue.advance(cycle + 1);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  result.seconds = std::chrono::duration<double>(end - start).count();
+  return result;
+}
+
+// Sends packets through SimPort/SimPlatform to measure the end-to-end path.
+class PortBench : public SimObject<PortBench> {
+public:
+  std::vector<SimPort<uint32_t>> Ports;
+  uint64_t received;
+
+  PortBench(const SimContext& ctx, uint32_t num_ports)
+    : SimObject<PortBench>(ctx, "port-bench")
+    , Ports(num_ports, this)
+    , received(0)
+    , seed_(1)
+  {}
+
+  void reset() {
+    received = 0;
+    seed_ = 1;
+  }
+
+  void tick() {
+    for (auto& port : Ports) {
+      while (!port.empty()) {
+        port.pop();
+        ++received;
+      }
+    }
+    for (uint32_t i = 0, n = Ports.size(); i < n; ++i) {
+      seed_ = seed_ * 6364136223846793005ull + 1442695040888963407ull;
+      uint64_t delay = 1 + ((seed_ >> 33) % max_delay);
+      Ports.at(i).send(uint32_t(seed_ >> 40), delay);
+    }
+  }
+
+private:
+  uint64_t seed_;
+};
+
+// Counts its cycles while idling between sparse packets.
+class IdleBench : public SimObject<IdleBench> {
+public:
+  SimPort<uint32_t> Input;
+  uint64_t cycles;
+  uint64_t received;
+
+  IdleBench(const SimContext& ctx)
+    : SimObject<IdleBench>(ctx, "idle-bench")
+    , Input(this)
+    , cycles(0)
+    , received(0)
+  {}
+
+  void reset() {
+    cycles = 0;
+    received = 0;
+  }
+
+  void tick() {
+    ++cycles;
+    if (!Input.empty()) {
+      Input.pop();
+      ++received;
+    }
+  }
+
+  bool idle() const {
+    return Input.empty();
+  }
+
+  void skip(uint64_t cycles) {
+    this->cycles += cycles;
+  }
+};
+
+static void report(const char* name, const bench_result_t& result) {
+  printf("%-10s events=%lu, time=%.3fs, rate=%.2f Mevents/s\n",
+    name, result.events, result.seconds, (result.events / result.seconds) / 1e6);
+}
+
+int main(int argc, char **argv) {
+  parse_args(argc, argv);
+
+  printf("cycles=%lu, fanout=%d, max_delay=%d\n", num_cycles, fanout, max_delay);
+
+  ListEventQueue list_queue;
+  auto list_result = run_bench(list_queue);
+  report("list", list_result);
+
+  SimEventWheel wheel_queue;
+  auto wheel_result = run_bench(wheel_queue);
+  report("wheel", wheel_result);
+
+  if (list_result.events != wheel_result.events
+   || list_result.checksum != wheel_result.checksum) {
+    printf("Error: event order mismatch!\n");
+    return -1;
+  }
+
+  {
+    auto bench = PortBench::Create(fanout);
+    SimPlatform::instance().reset();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint64_t cycle = 0; cycle < num_cycles; ++cycle) {
+      SimPlatform::instance().tick();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    bench_result_t port_result{bench->received, 0, std::chrono::duration<double>(end - start).count()};
+    report("simport", port_result);
+    SimPlatform::instance().finalize();
+  }
+
+  {
+    auto bench = IdleBench::Create();
+    SimPlatform::instance().reset();
+    uint32_t num_packets = 0;
+    for (uint64_t delay = 1; delay < num_cycles; delay = delay * 2 + 3) {
+      bench->Input.send(uint32_t(delay), delay);
+      ++num_packets;
+    }
+    uint64_t ticks = 0;
+    while (bench->received != num_packets) {
+      SimPlatform::instance().tick();
+      ++ticks;
+    }
+    SimPlatform::instance().sync();
+    auto cycles = SimPlatform::instance().cycles();
+    printf("idle       packets=%d, ticks=%lu, cycles=%lu\n", num_packets, ticks, cycles);
+    if (bench->cycles != cycles || ticks >= cycles) {
+      printf("Error: idle cycles mismatch!\n");
+      return -1;
+    }
+    SimPlatform::instance().finalize();
+  }
+
+  printf("PASSED!\n");
+
+  return 0;
+}
@@ -0,0 +1,129 @@
+#include <shared_mem.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+using namespace vortex;
+
+static const uint32_t NUM_REQS  = 4;
+static const uint32_t WORD_SIZE = 4;
+
+struct Result {
+  uint64_t cycles;
+  SharedMem::PerfStats perf;
+};
+
+// issues one request per lane at cycle 0 and ticks until the memory drains
+static Result run(uint32_t num_banks,
+                  uint32_t num_ports,
+                  bool broadcast,
+                  const std::vector<MemReq>& reqs) {
+  auto smem = SharedMem::Create("smem", SharedMem::Config{
+    (1 << 14),
+    WORD_SIZE,
+    NUM_REQS,
+    num_banks,
+    num_ports,
+    broadcast,
+    false
+  });
+  SimPlatform::instance().reset();
+  for (uint32_t i = 0; i < reqs.size(); ++i) {
+    smem->Inputs.at(i).send(reqs.at(i), 1);
+  }
+  Result result;
+  result.cycles = 0;
+  while (SimPlatform::instance().tick()) {
+    ++result.cycles;
+  }
+  result.perf = smem->perf_stats();
+  SimPlatform::instance().finalize();
+  return result;
+}
+
+static std::vector<MemReq> strided_reads(uint32_t stride, uint32_t size = 0) {
+  std::vector<MemReq> reqs;
+  for (uint32_t i = 0; i < NUM_REQS; ++i) {
+    reqs.emplace_back(i * stride * WORD_SIZE, false, AddrType::Shared, i, 0, 0, size);
+  }
+  return reqs;
+}
+
+static int errors = 0;
+
+static void check(const char* name, bool cond) {
+  if (!cond) {
+    printf("Error: %s\n", name);
+    ++errors;
+  }
+}
+
+int main() {
+  {
+    // consecutive words fall in distinct banks
+    auto r = run(4, 1, false, strided_reads(1));
+    check("unit stride stalls", r.perf.bank_stalls == 0);
+    check("unit stride reads", r.perf.reads == NUM_REQS);
+  }
+  {
+    // byte offsets within a word do not select the bank
+    std::vector<MemReq> reqs;
+    for (uint32_t i = 0; i < NUM_REQS; ++i) {
+      reqs.emplace_back(i * WORD_SIZE + (i % WORD_SIZE), false, AddrType::Shared, i);
+    }
+    auto r = run(4, 1, false, reqs);
+    check("byte offset stalls", r.perf.bank_stalls == 0);
+  }
+  uint64_t serial_cycles;
+  {
+    // a stride of num_banks words hits a single bank: 3 + 2 + 1 stalls
+    auto r = run(4, 1, false, strided_reads(4));
+    check("bank stride stalls", r.perf.bank_stalls == 6);
+    check("bank stride conflicts", r.perf.bank_conflicts.at(0) == 6
+                                && r.perf.bank_conflicts.at(1) == 0);
+    serial_cycles = r.cycles;
+  }
+  {
+    // dual-ported banks serve two requests per cycle
+    auto r = run(4, 2, false, strided_reads(4));
+    check("dual port stalls", r.perf.bank_stalls == 2);
+    check("dual port cycles", r.cycles < serial_cycles);
+  }
+  {
+    // same-word reads serialize without broadcast
+    auto r = run(4, 1, false, strided_reads(0));
+    check("no broadcast stalls", r.perf.bank_stalls == 6);
+    check("no broadcast count", r.perf.broadcasts == 0);
+  }
+  {
+    // and share a single bank access with broadcast
+    auto r = run(4, 1, true, strided_reads(0));
+    check("broadcast stalls", r.perf.bank_stalls == 0);
+    check("broadcast count", r.perf.broadcasts == NUM_REQS - 1);
+  }
+  {
+    // writes are never broadcast
+    auto reqs = strided_reads(0);
+    for (auto& req : reqs) {
+      req.write = true;
+    }
+    auto r = run(4, 1, true, reqs);
+    check("write broadcast stalls", r.perf.bank_stalls == 6);
+    check("write count", r.perf.writes == NUM_REQS);
+  }
+  {
+    // two-word accesses at a two-word stride claim two banks each
+    auto r = run(4, 1, false, strided_reads(2, 2 * WORD_SIZE));
+    // lanes 0/1 use banks 0-1 and 2-3, lanes 2/3 wait one cycle
+    check("multi-word stalls", r.perf.bank_stalls == 2);
+    check("multi-word conflicts", r.perf.bank_conflicts.at(0) == 1
+                               && r.perf.bank_conflicts.at(2) == 1);
+  }
+
+  if (errors != 0) {
+    printf("FAILED! (%d errors)\n", errors);
+    return 1;
+  }
+  printf("PASSED!\n");
+  return 0;
+}